@@ -91,6 +91,11 @@ enum options_client
   OPT_REWRITE_DB,
   OPT_REPORT_PROGRESS,
   OPT_SKIP_ANNOTATE_ROWS_EVENTS,
+  OPT_BATCH_ROW_STATEMENTS, OPT_DECODE_THREADS,
+  OPT_CHUNK_DIR, OPT_CHUNK_ROWS,
+  OPT_BULK_LOAD, OPT_SPLIT_SIZE,
+  OPT_SLAP_MIX, OPT_SLAP_KEY_RANGE, OPT_SLAP_KEY_DISTRIBUTION,
+  OPT_SLAP_THINK_TIME, OPT_SLAP_RATE, OPT_SLAP_REPORT_INTERVAL,
   OPT_MAX_CLIENT_OPTION /* should be always the last */
 };
 
@@ -39,6 +39,7 @@
 #include "log_event.h"
 #include "sql_common.h"
 #include "my_dir.h"
+#include <base64.h>
 #include <welcome_copyright_notice.h> // ORACLE_WELCOME_COPYRIGHT_NOTICE
 
 
@@ -120,6 +121,8 @@ static short binlog_flags = 0;
 static MYSQL* mysql = NULL;
 static const char* dirname_for_local_load= 0;
 static bool opt_skip_annotate_row_events= 0;
+static uint opt_batch_row_statements= 1;
+static uint opt_decode_threads= 0;
 
 /**
   Pointer to the Format_description_log_event of the currently active binlog.
@@ -846,6 +849,26 @@ static bool print_base64(PRINT_EVENT_INFO *print_event_info, Log_event *ev)
 }
 
 
+/**
+  Ends the BINLOG statement of the row events cached so far, if any,
+  and writes the cached events to the result file.
+*/
+static bool flush_row_events(PRINT_EVENT_INFO *print_event_info)
+{
+  IO_CACHE *const body_cache= &print_event_info->body_cache;
+
+  // append END-MARKER(') with delimiter
+  if (my_b_tell(body_cache))
+    my_b_printf(body_cache, "'%s\n", print_event_info->delimiter);
+  print_event_info->batched_statements= 0;
+
+  // flush cache
+  return (copy_event_cache_to_file_and_reinit(&print_event_info->head_cache,
+                                              result_file) ||
+          copy_event_cache_to_file_and_reinit(body_cache, result_file));
+}
+
+
 static bool print_row_event(PRINT_EVENT_INFO *print_event_info, Log_event *ev,
                             ulong table_id, bool is_stmt_end)
 {
@@ -886,18 +909,8 @@ static bool print_row_event(PRINT_EVENT_INFO *print_event_info, Log_event *ev,
        result_file (as it would happen in ev->print(...) if
        event was not skipped).
     */
-    if (skip_event)
-    {
-      // append END-MARKER(') with delimiter
-      IO_CACHE *const body_cache= &print_event_info->body_cache;
-      if (my_b_tell(body_cache))
-        my_b_printf(body_cache, "'%s\n", print_event_info->delimiter);
-
-      // flush cache
-      if ((copy_event_cache_to_file_and_reinit(&print_event_info->head_cache, result_file) ||
-          copy_event_cache_to_file_and_reinit(&print_event_info->body_cache, result_file)))
-        return 1;
-    }
+    if (skip_event && flush_row_events(print_event_info))
+      return 1;
   }
 
   /* skip the event check */
@@ -975,6 +988,16 @@ Exit_status process_event(PRINT_EVENT_INFO *print_event_info, Log_event *ev,
       retval= OK_STOP;
       goto end;
     }
+    /*
+      The BINLOG statement of a batch of row events ends before the
+      first event which is not part of a row-based statement.
+    */
+    if (print_event_info->batched_statements &&
+        ev_type != ANNOTATE_ROWS_EVENT && ev_type != TABLE_MAP_EVENT &&
+        ev_type != WRITE_ROWS_EVENT && ev_type != UPDATE_ROWS_EVENT &&
+        ev_type != DELETE_ROWS_EVENT && flush_row_events(print_event_info))
+      goto err;
+
     if (!short_form)
       fprintf(result_file, "# at %s\n",llstr(pos,ll_buff));
 
@@ -1444,6 +1467,18 @@ Example: rewrite-db='from->to'.",
    (uchar**) &opt_skip_annotate_row_events,
    (uchar**) &opt_skip_annotate_row_events,
    0, GET_BOOL, NO_ARG, 0, 0, 0, 0, 0, 0},
+  {"batch-row-statements", OPT_BATCH_ROW_STATEMENTS,
+   "Print the row events of up to this many consecutive row-based "
+   "statements as one BINLOG statement, so that replaying the output "
+   "executes fewer statements.",
+   &opt_batch_row_statements, &opt_batch_row_statements, 0, GET_UINT,
+   REQUIRED_ARG, 1, 1, UINT_MAX, 0, 1, 0},
+  {"decode-threads", OPT_DECODE_THREADS,
+   "Number of threads which encode and decode row events of a local binlog "
+   "ahead of printing them. The output is the same as without threads. "
+   "0 means to do everything in the main thread.",
+   &opt_decode_threads, &opt_decode_threads, 0, GET_UINT,
+   REQUIRED_ARG, 0, 0, 64, 0, 1, 0},
   {0, 0, 0, 0, 0, 0, GET_NO_ARG, NO_ARG, 0, 0, 0, 0, 0, 0}
 };
 
@@ -1782,9 +1817,20 @@ static Exit_status dump_log_entries(const char* logname)
   
   print_event_info.verbose= short_form ? 0 : verbose;
 
+  /* --base64-output=decode-rows prints no BINLOG statements to batch */
+  if (opt_base64_output_mode != BASE64_OUTPUT_DECODE_ROWS)
+    print_event_info.batch_statements= opt_batch_row_statements;
+
   rc= (remote_opt ? dump_remote_log_entries(&print_event_info, logname) :
        dump_local_log_entries(&print_event_info, logname));
 
+  if (print_event_info.batched_statements &&
+      flush_row_events(&print_event_info))
+  {
+    error("Error writing event to file.");
+    rc= ERROR_STOP;
+  }
+
   /* Set delimiter back to semicolon */
   fprintf(result_file, "DELIMITER ;\n");
   strmov(print_event_info.delimiter, ";");
@@ -2261,6 +2307,491 @@ static Exit_status check_header(IO_CACHE* file,
 }
 
 
+/*
+  With --decode-threads, the events of a local binlog are read ahead
+  into a queue. Decode threads prepare the base64 text and the --verbose
+  rows of the row events in the queue, and the main thread prints the
+  events in binlog order with process_event(), using what was prepared.
+*/
+struct Decode_job
+{
+  Log_event *ev;
+  my_off_t pos;
+  /* Table map event of the rows, to print them with --verbose */
+  char *map_buf;
+  uint map_len;
+  /* Prepared output, see PRINT_EVENT_INFO::prepared_base64 */
+  char *base64;
+  IO_CACHE verbose;
+  bool has_verbose;
+  bool done;
+};
+
+/* Table map events read ahead for the row events of the current statement */
+struct Decode_table_map
+{
+  ulong table_id;
+  char *buf;
+  uint len;
+  bool decode;
+};
+
+#define DECODE_JOBS_PER_THREAD 16
+
+static Decode_job *decode_jobs;
+static uint decode_jobs_size;
+/* Sequence numbers: first queued, next to queue, next for a decode thread */
+static ulonglong decode_head, decode_tail, decode_next;
+static bool decode_stop;
+static uint decode_running;
+static DYNAMIC_ARRAY decode_table_maps;
+static pthread_mutex_t LOCK_decode;
+static pthread_cond_t COND_decode_job, COND_decode_done;
+
+
+static void clear_decode_table_maps()
+{
+  for (uint i= 0; i < decode_table_maps.elements; i++)
+    my_free(dynamic_element(&decode_table_maps, i, Decode_table_map*)->buf);
+  reset_dynamic(&decode_table_maps);
+}
+
+
+static Decode_table_map *find_decode_table_map(ulong table_id)
+{
+  for (uint i= 0; i < decode_table_maps.elements; i++)
+  {
+    Decode_table_map *map= dynamic_element(&decode_table_maps, i,
+                                           Decode_table_map*);
+    if (map->table_id == table_id)
+      return map;
+  }
+  return NULL;
+}
+
+
+/**
+  Decides what a decode thread should prepare for an event.
+
+  Only table map and row events are prepared. Their base64 text does
+  not depend on anything printed before them, and --verbose rows only
+  on the table map, which is copied into the job. Events of tables
+  filtered away by --database, or renamed by --rewrite-db, are left to
+  process_event().
+
+  @return TRUE if a decode thread should prepare the event.
+*/
+static bool prepare_decode_job(Decode_job *job)
+{
+  Log_event *ev= job->ev;
+  bool base64= opt_base64_output_mode != BASE64_OUTPUT_DECODE_ROWS;
+
+  job->map_buf= job->base64= NULL;
+  job->has_verbose= FALSE;
+  if (short_form)
+    return FALSE;
+
+  switch (ev->get_type_code()) {
+  case TABLE_MAP_EVENT:
+  {
+    Table_map_log_event *map= (Table_map_log_event*) ev;
+    Decode_table_map *entry;
+    size_t len_to= 0;
+    if (!(entry= find_decode_table_map(map->get_table_id())))
+    {
+      if (!(entry= (Decode_table_map*) alloc_dynamic(&decode_table_maps)))
+        return FALSE;
+      entry->table_id= map->get_table_id();
+    }
+    else
+      my_free(entry->buf);
+    binlog_filter->get_rewrite_db(map->get_db_name(), &len_to);
+    entry->decode= !len_to && !shall_skip_database(map->get_db_name());
+    entry->len= uint4korr(ev->temp_buf + EVENT_LEN_OFFSET);
+    if (ev->checksum_alg != BINLOG_CHECKSUM_ALG_UNDEF &&
+        ev->checksum_alg != BINLOG_CHECKSUM_ALG_OFF)
+      entry->len-= BINLOG_CHECKSUM_LEN;
+    if (!(entry->buf= (char*) my_memdup(ev->temp_buf, entry->len + 1,
+                                         MYF(MY_WME))))
+      entry->decode= FALSE;
+    return entry->decode && base64;
+  }
+  case WRITE_ROWS_EVENT:
+  case UPDATE_ROWS_EVENT:
+  case DELETE_ROWS_EVENT:
+  {
+    Rows_log_event *rows= (Rows_log_event*) ev;
+    Decode_table_map *entry= find_decode_table_map(rows->get_table_id());
+    bool decode= entry && entry->decode;
+    if (decode && verbose)
+    {
+      job->map_buf= (char*) my_memdup(entry->buf, entry->len + 1, MYF(0));
+      job->map_len= entry->len;
+    }
+    if (rows->get_flags(Rows_log_event::STMT_END_F))
+      clear_decode_table_maps();
+    return decode && (base64 || job->map_buf);
+  }
+  default:
+    return FALSE;
+  }
+}
+
+
+/**
+  Prepares the base64 text and the --verbose rows of an event, in a
+  decode thread.
+
+  @param job    Event to prepare.
+  @param info   PRINT_EVENT_INFO of the decode thread, to print the rows.
+*/
+static void decode_event(Decode_job *job, PRINT_EVENT_INFO *info)
+{
+  Log_event *ev= job->ev;
+  const uchar *ptr= (const uchar*) ev->temp_buf;
+  uint32 size= uint4korr(ptr + EVENT_LEN_OFFSET);
+
+  if (opt_base64_output_mode != BASE64_OUTPUT_DECODE_ROWS &&
+      (job->base64= (char*) my_malloc(base64_needed_encoded_length((int) size),
+                                      MYF(MY_WME))))
+    base64_encode(ptr, (size_t) size, job->base64);
+
+  if (job->map_buf)
+  {
+    Table_map_log_event *map= new Table_map_log_event(job->map_buf,
+                                                      job->map_len,
+                                                      glob_description_event);
+    if (map && map->is_valid() &&
+        !info->m_table_map.set_table(map->get_table_id(), map))
+    {
+      ev->print_base64(&job->verbose, info, FALSE);
+      job->has_verbose= job->verbose.error != -1;
+      info->m_table_map.clear_tables();
+    }
+    else
+      delete map;
+  }
+}
+
+
+pthread_handler_t decode_thread(void *arg __attribute__((unused)))
+{
+  PRINT_EVENT_INFO *info;
+
+  my_thread_init();
+  if ((info= new PRINT_EVENT_INFO) && info->init_ok())
+  {
+    /* Only the rows are printed, the main thread prints the rest */
+    info->base64_output_mode= BASE64_OUTPUT_DECODE_ROWS;
+    info->verbose= verbose;
+  }
+  else
+  {
+    delete info;
+    info= NULL;
+  }
+
+  pthread_mutex_lock(&LOCK_decode);
+  while (info && !decode_stop)
+  {
+    if (decode_next == decode_tail)
+    {
+      pthread_cond_wait(&COND_decode_job, &LOCK_decode);
+      continue;
+    }
+    Decode_job *job= &decode_jobs[decode_next++ % decode_jobs_size];
+    if (job->done)
+      continue;
+    pthread_mutex_unlock(&LOCK_decode);
+
+    decode_event(job, info);
+
+    pthread_mutex_lock(&LOCK_decode);
+    job->done= TRUE;
+    pthread_cond_broadcast(&COND_decode_done);
+  }
+  decode_running--;
+  pthread_cond_broadcast(&COND_decode_done);
+  pthread_mutex_unlock(&LOCK_decode);
+
+  delete info;
+  my_thread_end();
+  return 0;
+}
+
+
+/**
+  Starts the decode threads of --decode-threads.
+
+  @retval 0 OK, or the decode threads are not used
+  @retval 1 Out of memory
+*/
+static int start_decode_threads()
+{
+  pthread_t thread;
+  pthread_attr_t attr;
+
+  if (!opt_decode_threads || remote_opt)
+    return 0;
+
+  decode_jobs_size= opt_decode_threads * DECODE_JOBS_PER_THREAD;
+  if (!(decode_jobs= (Decode_job*) my_malloc(decode_jobs_size *
+                                             sizeof(Decode_job),
+                                             MYF(MY_WME | MY_ZEROFILL))))
+    return 1;
+  for (uint i= 0; i < decode_jobs_size; i++)
+  {
+    if (open_cached_file(&decode_jobs[i].verbose, NULL, NULL, 0,
+                         MYF(MY_WME | MY_NABP)))
+    {
+      decode_jobs_size= i;
+      return 1;
+    }
+  }
+  my_init_dynamic_array(&decode_table_maps, sizeof(Decode_table_map), 8, 8);
+  pthread_mutex_init(&LOCK_decode, NULL);
+  pthread_cond_init(&COND_decode_job, NULL);
+  pthread_cond_init(&COND_decode_done, NULL);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for (uint i= 0; i < opt_decode_threads; i++)
+  {
+    pthread_mutex_lock(&LOCK_decode);
+    if (pthread_create(&thread, &attr, decode_thread, NULL))
+    {
+      pthread_mutex_unlock(&LOCK_decode);
+      warning("Could not create decode thread, "
+              "continuing with %u threads.", i);
+      break;
+    }
+    decode_running++;
+    pthread_mutex_unlock(&LOCK_decode);
+  }
+  pthread_attr_destroy(&attr);
+  return 0;
+}
+
+
+static void end_decode_threads()
+{
+  if (!decode_jobs)
+    return;
+  pthread_mutex_lock(&LOCK_decode);
+  decode_stop= TRUE;
+  pthread_cond_broadcast(&COND_decode_job);
+  while (decode_running)
+    pthread_cond_wait(&COND_decode_done, &LOCK_decode);
+  pthread_mutex_unlock(&LOCK_decode);
+
+  for (uint i= 0; i < decode_jobs_size; i++)
+    close_cached_file(&decode_jobs[i].verbose);
+  my_free(decode_jobs);
+  decode_jobs= NULL;
+  clear_decode_table_maps();
+  delete_dynamic(&decode_table_maps);
+  pthread_mutex_destroy(&LOCK_decode);
+  pthread_cond_destroy(&COND_decode_job);
+  pthread_cond_destroy(&COND_decode_done);
+}
+
+
+/**
+  Takes the first event of the queue of --decode-threads, once it is
+  prepared, and prints it unless told to discard it.
+
+  @retval ERROR_STOP An error occurred - the program should terminate.
+  @retval OK_CONTINUE No error, the program should continue.
+  @retval OK_STOP No error, but the end of the specified range of
+  events to process has been reached and the program should terminate.
+*/
+static Exit_status process_decoded_event(PRINT_EVENT_INFO *print_event_info,
+                                         const char *logname, bool discard)
+{
+  Decode_job *job= &decode_jobs[decode_head % decode_jobs_size];
+  Exit_status retval= OK_CONTINUE;
+
+  pthread_mutex_lock(&LOCK_decode);
+  while (!job->done)
+  {
+    if (!decode_running)
+    {
+      /* No decode thread left, print the event unprepared */
+      job->done= TRUE;
+      break;
+    }
+    pthread_cond_wait(&COND_decode_done, &LOCK_decode);
+  }
+  /* Decode threads must not take the jobs reused for later events */
+  decode_head++;
+  if (decode_next < decode_head)
+    decode_next= decode_head;
+  pthread_mutex_unlock(&LOCK_decode);
+
+  if (discard)
+    delete job->ev;
+  else
+  {
+    print_event_info->prepared_base64= job->base64;
+    print_event_info->prepared_verbose= job->has_verbose ? &job->verbose : NULL;
+    retval= process_event(print_event_info, job->ev, job->pos, logname);
+    print_event_info->prepared_base64= NULL;
+    print_event_info->prepared_verbose= NULL;
+  }
+  my_free(job->base64);
+  my_free(job->map_buf);
+  reinit_io_cache(&job->verbose, WRITE_CACHE, 0, FALSE, TRUE);
+  return retval;
+}
+
+
+/**
+  Prints, or discards after an error, all events queued for
+  --decode-threads.
+*/
+static Exit_status flush_decoded_events(PRINT_EVENT_INFO *print_event_info,
+                                        const char *logname, bool discard)
+{
+  Exit_status retval= OK_CONTINUE;
+  while (decode_head < decode_tail)
+  {
+    if ((retval= process_decoded_event(print_event_info, logname,
+                                       discard)) != OK_CONTINUE)
+      discard= TRUE;
+  }
+  clear_decode_table_maps();
+  return retval;
+}
+
+
+/**
+  Adds an event to the queue of --decode-threads, printing the first
+  events of the queue when it is full.
+
+  The queue is emptied after a Format_description_log_event, which
+  must be processed before later events are read and decoded.
+
+  @retval ERROR_STOP An error occurred - the program should terminate.
+  @retval OK_CONTINUE No error, the program should continue.
+  @retval OK_STOP No error, but the end of the specified range of
+  events to process has been reached and the program should terminate.
+*/
+static Exit_status queue_decoded_event(PRINT_EVENT_INFO *print_event_info,
+                                       Log_event *ev, my_off_t pos,
+                                       const char *logname)
+{
+  Exit_status retval;
+  Decode_job *job;
+  bool decode;
+
+  if (decode_tail - decode_head == decode_jobs_size &&
+      (retval= process_decoded_event(print_event_info, logname, FALSE)) !=
+      OK_CONTINUE)
+  {
+    delete ev;
+    return retval;
+  }
+
+  job= &decode_jobs[decode_tail % decode_jobs_size];
+  job->ev= ev;
+  job->pos= pos;
+  decode= prepare_decode_job(job);
+  pthread_mutex_lock(&LOCK_decode);
+  job->done= !decode;
+  decode_tail++;
+  if (decode)
+    pthread_cond_signal(&COND_decode_job);
+  pthread_mutex_unlock(&LOCK_decode);
+
+  if (ev->get_type_code() == FORMAT_DESCRIPTION_EVENT)
+    return flush_decoded_events(print_event_info, logname, FALSE);
+  return OK_CONTINUE;
+}
+
+
+/**
+  Reads the next event of a local binlog.
+
+  As long as --offset or --start-datetime exclude the events read, they
+  are counted and skipped without being decoded or checked.
+
+  @param[in] file      Binlog to read.
+  @param[out] skipped  Set when an event was skipped.
+
+  @return The event, or NULL for a skipped event, at the end of the
+  file or on errors (file->error is set).
+*/
+static Log_event *read_local_event(IO_CACHE *file, bool *skipped)
+{
+  uchar head[LOG_EVENT_MINIMAL_HEADER_LEN];
+  uint header_size= min(glob_description_event->common_header_len,
+                        LOG_EVENT_MINIMAL_HEADER_LEN);
+  uint data_len;
+  char *buf;
+  const char *error_msg;
+  Log_event *ev;
+
+  *skipped= FALSE;
+  /* With --decode-threads, the queued events may end the exclusion */
+  if ((!start_datetime && rec_count >= offset) || decode_head < decode_tail)
+    return Log_event::read_log_event(file, glob_description_event,
+                                     opt_verify_binlog_checksum);
+
+  if (my_b_read(file, head, header_size))
+    return NULL;
+  if ((data_len= uint4korr(head + EVENT_LEN_OFFSET)) < header_size)
+  {
+    error_msg= "Event too small";
+    goto err;
+  }
+
+  if (head[EVENT_TYPE_OFFSET] != FORMAT_DESCRIPTION_EVENT &&
+      (rec_count < offset || (my_time_t) uint4korr(head) < start_datetime))
+  {
+    uchar buff[IO_SIZE];
+    for (uint length= data_len - header_size, tmp; length > 0; length-= tmp)
+    {
+      tmp= min(length, sizeof(buff));
+      if (my_b_read(file, buff, tmp))
+        return NULL;
+    }
+    rec_count++;
+    *skipped= TRUE;
+    return NULL;
+  }
+
+  // some events use the extra byte to null-terminate strings
+  if (!(buf= (char*) my_malloc(data_len + 1, MYF(MY_WME))))
+  {
+    error_msg= "Out of memory";
+    goto err;
+  }
+  buf[data_len]= 0;
+  memcpy(buf, head, header_size);
+  if (my_b_read(file, (uchar*) buf + header_size, data_len - header_size))
+  {
+    my_free(buf);
+    return NULL;
+  }
+  if (!(ev= Log_event::read_log_event(buf, data_len, &error_msg,
+                                      glob_description_event,
+                                      opt_verify_binlog_checksum)))
+  {
+    my_free(buf);
+    goto err;
+  }
+  ev->register_temp_buf(buf, TRUE);
+  return ev;
+
+err:
+  sql_print_error("Error in Log_event::read_log_event(): "
+                  "'%s', data_len: %u, event_type: %d",
+                  error_msg, data_len, head[EVENT_TYPE_OFFSET]);
+  file->error= -1;
+  return NULL;
+}
+
+
 /**
   Reads a local binlog and prints the events it sees.
 
@@ -2354,9 +2885,11 @@ static Exit_status dump_local_log_entries(PRINT_EVENT_INFO *print_event_info,
   {
     char llbuff[21];
     my_off_t old_off = my_b_tell(file);
+    bool skipped;
 
-    Log_event* ev = Log_event::read_log_event(file, glob_description_event,
-                                              opt_verify_binlog_checksum);
+    Log_event* ev= read_local_event(file, &skipped);
+    if (skipped)
+      continue;
     if (!ev)
     {
       /*
@@ -2375,8 +2908,11 @@ static Exit_status dump_local_log_entries(PRINT_EVENT_INFO *print_event_info,
       // file->error == 0 means EOF, that's OK, we break in this case
       goto end;
     }
-    if ((retval= process_event(print_event_info, ev, old_off, logname)) !=
-        OK_CONTINUE)
+    if (decode_jobs)
+      retval= queue_decoded_event(print_event_info, ev, old_off, logname);
+    else
+      retval= process_event(print_event_info, ev, old_off, logname);
+    if (retval != OK_CONTINUE)
       goto end;
   }
 
@@ -2386,6 +2922,13 @@ err:
   retval= ERROR_STOP;
 
 end:
+  if (decode_jobs)
+  {
+    Exit_status rc= flush_decoded_events(print_event_info, logname,
+                                         retval != OK_CONTINUE);
+    if (retval == OK_CONTINUE)
+      retval= rc;
+  }
   if (fd >= 0)
     my_close(fd, MYF(MY_WME));
   /*
@@ -2456,7 +2999,7 @@ int main(int argc, char** argv)
     dirname_for_local_load= my_strdup(my_tmpdir(&tmpdir), MY_WME);
   }
 
-  if (load_processor.init())
+  if (load_processor.init() || start_decode_threads())
     exit(1);
   if (dirname_for_local_load)
     load_processor.init_by_dir_name(dirname_for_local_load);
@@ -2517,6 +3060,7 @@ int main(int argc, char** argv)
 
   fprintf(result_file, "/*!50530 SET @@SESSION.PSEUDO_SLAVE_MODE=0*/;\n");
 
+  end_decode_threads();
   if (tmpdir.list)
     free_tmpdir(&tmpdir);
   if (result_file != stdout)
@@ -129,6 +129,7 @@ static char  *opt_password=0,*current_user=0,
              *current_host=0,*path=0,*fields_terminated=0,
              *lines_terminated=0, *enclosed=0, *opt_enclosed=0, *escaped=0,
              *where=0, *order_by=0,
+             *opt_chunk_dir= 0,
              *opt_compatible_mode_str= 0,
              *err_ptr= 0,
              *log_error_file= NULL;
@@ -143,6 +144,11 @@ static ulong opt_compatible_mode= 0;
 #define MYSQL_OPT_SLAVE_DATA_COMMENTED_SQL 2
 static uint opt_mysql_port= 0, opt_master_data;
 static uint opt_slave_data;
+static uint opt_use_threads= 1;
+static ulonglong opt_chunk_rows= 0;
+/* db.triggers.sql of --chunk-dir for the database being dumped */
+static FILE *chunk_triggers_file= 0;
+static char chunk_triggers_db[NAME_LEN + 1];
 static uint my_end_arg;
 static char * opt_mysql_unix_port=0;
 static int   first_error=0;
@@ -235,6 +241,19 @@ static struct my_option my_long_options[] =
   {"character-sets-dir", OPT_CHARSETS_DIR,
    "Directory for character set files.", (char**) &charsets_dir,
    (char**) &charsets_dir, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
+  {"chunk-dir", OPT_CHUNK_DIR,
+   "Write the data of the tables into files in this directory instead of "
+   "the dump, one or more files per table named db.table.N.sql. The files "
+   "are written by --use-threads connections which all read the same "
+   "snapshot of the data, and can be loaded in parallel after the dump "
+   "itself. Triggers go to db.triggers.sql, to be loaded after the data "
+   "so that they don't fire again. Implies --single-transaction.",
+   &opt_chunk_dir, &opt_chunk_dir, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
+  {"chunk-rows", OPT_CHUNK_ROWS,
+   "With --chunk-dir, split tables with an integer primary or unique key "
+   "into files of this many rows each. 0 writes one file per table.",
+   &opt_chunk_rows, &opt_chunk_rows, 0, GET_ULL, REQUIRED_ARG,
+   0, 0, ~(ulonglong) 0, 0, 1, 0},
   {"comments", 'i', "Write additional information.",
    &opt_comments, &opt_comments, 0, GET_BOOL, NO_ARG,
    1, 0, 0, 0, 0, 0},
@@ -505,6 +524,10 @@ static struct my_option my_long_options[] =
   {"tz-utc", OPT_TZ_UTC,
     "SET TIME_ZONE='+00:00' at top of dump to allow dumping of TIMESTAMP data when a server has data in different time zones or data is being moved between servers with different time zones.",
     &opt_tz_utc, &opt_tz_utc, 0, GET_BOOL, NO_ARG, 1, 0, 0, 0, 0, 0},
+  {"use-threads", OPT_USE_THREADS,
+   "Number of connections writing the files of --chunk-dir in parallel.",
+   &opt_use_threads, &opt_use_threads, 0, GET_UINT, REQUIRED_ARG,
+   1, 1, 256, 0, 1, 0},
 #ifndef DONT_ALLOW_USER_CHANGE
   {"user", 'u', "User for login if not current user.",
    &current_user, &current_user, 0, GET_STR, REQUIRED_ARG,
@@ -533,8 +556,11 @@ static const char *load_default_groups[]=
 
 static void maybe_exit(int error);
 static void die(int error, const char* reason, ...);
+static my_bool chunk_thread_error(int error, my_bool fatal);
+static void end_chunk_threads(my_bool abort);
 static void maybe_die(int error, const char* reason, ...);
 static void write_header(FILE *sql_file, char *db_name);
+static int start_transaction(MYSQL *mysql_con);
 static void print_value(FILE *file, MYSQL_RES  *result, MYSQL_ROW row,
                         const char *prefix,const char *name,
                         int string_value);
@@ -960,6 +986,18 @@ static int get_options(int *argc, char ***argv)
     return(EX_USAGE);
   }
 
+  if (opt_chunk_dir)
+  {
+    if (path || opt_xml)
+    {
+      fprintf(stderr, "%s: --chunk-dir can't be used with --tab or --xml.\n",
+              my_progname_short);
+      return(EX_USAGE);
+    }
+    /* All connections of the dump must read the same snapshot */
+    opt_single_transaction= 1;
+  }
+
   /* We don't delete master logs if slave data option */
   if (opt_slave_data)
   {
@@ -1048,6 +1086,8 @@ static void die(int error_num, const char* fmt_reason, ...)
   fprintf(stderr, "%s: %s\n", my_progname_short, buffer);
   fflush(stderr);
 
+  if (chunk_thread_error(error_num, 1))
+    return;
   ignore_errors= 0; /* force the exit */
   maybe_exit(error_num);
 }
@@ -1485,6 +1525,8 @@ static void free_resources()
 {
   if (md_result_file && md_result_file != stdout)
     my_fclose(md_result_file, MYF(0));
+  if (chunk_triggers_file)
+    my_fclose(chunk_triggers_file, MYF(0));
   my_free(opt_password);
   my_free(current_host);
   if (my_hash_inited(&ignore_table))
@@ -1502,10 +1544,13 @@ static void free_resources()
 
 static void maybe_exit(int error)
 {
+  if (chunk_thread_error(error, !ignore_errors))
+    return;
   if (!first_error)
     first_error= error;
   if (ignore_errors)
     return;
+  end_chunk_threads(1);
   if (mysql)
     mysql_close(mysql);
   free_resources();
@@ -1514,63 +1559,54 @@ static void maybe_exit(int error)
 
 
 /*
-  db_connect -- connects to the host and selects DB.
+  Open a connection with the options of the command line and the session
+  settings every connection of the dump uses.
 */
 
-static int connect_to_db(char *host, char *user,char *passwd)
+static int open_connection(MYSQL *mysql_con, char *host, char *user,
+                           char *passwd)
 {
   char buff[20+FN_REFLEN];
-  DBUG_ENTER("connect_to_db");
+  DBUG_ENTER("open_connection");
 
-  verbose_msg("-- Connecting to %s...\n", host ? host : "localhost");
-  mysql_init(&mysql_connection);
+  mysql_init(mysql_con);
   if (opt_compress)
-    mysql_options(&mysql_connection,MYSQL_OPT_COMPRESS,NullS);
+    mysql_options(mysql_con,MYSQL_OPT_COMPRESS,NullS);
 #ifdef HAVE_OPENSSL
   if (opt_use_ssl)
-    mysql_ssl_set(&mysql_connection, opt_ssl_key, opt_ssl_cert, opt_ssl_ca,
+    mysql_ssl_set(mysql_con, opt_ssl_key, opt_ssl_cert, opt_ssl_ca,
                   opt_ssl_capath, opt_ssl_cipher);
-  mysql_options(&mysql_connection,MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
+  mysql_options(mysql_con,MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
                 (char*)&opt_ssl_verify_server_cert);
 #endif
   if (opt_protocol)
-    mysql_options(&mysql_connection,MYSQL_OPT_PROTOCOL,(char*)&opt_protocol);
+    mysql_options(mysql_con,MYSQL_OPT_PROTOCOL,(char*)&opt_protocol);
 #ifdef HAVE_SMEM
   if (shared_memory_base_name)
-    mysql_options(&mysql_connection,MYSQL_SHARED_MEMORY_BASE_NAME,shared_memory_base_name);
+    mysql_options(mysql_con,MYSQL_SHARED_MEMORY_BASE_NAME,shared_memory_base_name);
 #endif
-  mysql_options(&mysql_connection, MYSQL_SET_CHARSET_NAME, default_charset);
+  mysql_options(mysql_con, MYSQL_SET_CHARSET_NAME, default_charset);
 
   if (opt_plugin_dir && *opt_plugin_dir)
-    mysql_options(&mysql_connection, MYSQL_PLUGIN_DIR, opt_plugin_dir);
+    mysql_options(mysql_con, MYSQL_PLUGIN_DIR, opt_plugin_dir);
 
   if (opt_default_auth && *opt_default_auth)
-    mysql_options(&mysql_connection, MYSQL_DEFAULT_AUTH, opt_default_auth);
+    mysql_options(mysql_con, MYSQL_DEFAULT_AUTH, opt_default_auth);
 
-  mysql= &mysql_connection;          /* So we can mysql_close() it properly */
-  if (!mysql_real_connect(&mysql_connection,host,user,passwd,
+  if (!mysql_real_connect(mysql_con,host,user,passwd,
                           NULL,opt_mysql_port,opt_mysql_unix_port, 0))
   {
-    DB_error(&mysql_connection, "when trying to connect");
+    DB_error(mysql_con, "when trying to connect");
     DBUG_RETURN(1);
   }
-  if ((mysql_get_server_version(&mysql_connection) < 40100) ||
-      (opt_compatible_mode & 3))
-  {
-    /* Don't dump SET NAMES with a pre-4.1 server (bug#7997).  */
-    opt_set_charset= 0;
-
-    /* Don't switch charsets for 4.1 and earlier.  (bug#34192). */
-    server_supports_switching_charsets= FALSE;
-  } 
   /*
     As we're going to set SQL_MODE, it would be lost on reconnect, so we
     cannot reconnect.
   */
-  mysql->reconnect= 0;
+  mysql_con->reconnect= 0;
   my_snprintf(buff, sizeof(buff), "/*!40100 SET @@SQL_MODE='%s' */",
               compatible_mode_normal_str);
-  if (mysql_query_with_error_report(mysql, 0, buff))
+  if (mysql_query_with_error_report(mysql_con, 0, buff))
     DBUG_RETURN(1);
   /*
     set time_zone to UTC to allow dumping date types between servers with
@@ -1579,10 +1615,35 @@ static int connect_to_db(char *host, char *user,char *passwd)
   if (opt_tz_utc)
   {
     my_snprintf(buff, sizeof(buff), "/*!40103 SET TIME_ZONE='+00:00' */");
-    if (mysql_query_with_error_report(mysql, 0, buff))
+    if (mysql_query_with_error_report(mysql_con, 0, buff))
       DBUG_RETURN(1);
   }
   DBUG_RETURN(0);
+} /* open_connection */
+
+
+/*
+  db_connect -- connects to the host and selects DB.
+*/
+
+static int connect_to_db(char *host, char *user,char *passwd)
+{
+  DBUG_ENTER("connect_to_db");
+
+  verbose_msg("-- Connecting to %s...\n", host ? host : "localhost");
+  mysql= &mysql_connection;          /* So we can mysql_close() it properly */
+  if (open_connection(&mysql_connection, host, user, passwd))
+    DBUG_RETURN(1);
+  if ((mysql_get_server_version(&mysql_connection) < 40100) ||
+      (opt_compatible_mode & 3))
+  {
+    /* Don't dump SET NAMES with a pre-4.1 server (bug#7997).  */
+    opt_set_charset= 0;
+
+    /* Don't switch charsets for 4.1 and earlier.  (bug#34192). */
+    server_supports_switching_charsets= FALSE;
+  } 
+  DBUG_RETURN(0);
 } /* connect_to_db */
 
 
@@ -1596,14 +1657,14 @@ static void dbDisconnect(char *host)
 } /* dbDisconnect */
 
 
-static void unescape(FILE *file,char *pos,uint length)
+static void unescape(MYSQL *mysql_con, FILE *file, char *pos, uint length)
 {
   char *tmp;
   DBUG_ENTER("unescape");
   if (!(tmp=(char*) my_malloc(length*2+1, MYF(MY_WME))))
     die(EX_MYSQLERR, "Couldn't allocate memory");
 
-  mysql_real_escape_string(&mysql_connection, tmp, pos, length);
+  mysql_real_escape_string(mysql_con, tmp, pos, length);
   fputc('\'', file);
   fputs(tmp, file);
   fputc('\'', file);
@@ -2887,7 +2948,7 @@ static uint get_table_structure(char *table, char *db, char *table_type,
         if (row[SHOW_DEFAULT])
         {
           fputs(" DEFAULT ", sql_file);
-          unescape(sql_file, row[SHOW_DEFAULT], lengths[SHOW_DEFAULT]);
+          unescape(mysql, sql_file, row[SHOW_DEFAULT], lengths[SHOW_DEFAULT]);
         }
         if (!row[SHOW_NULL][0])
           fputs(" NOT NULL", sql_file);
@@ -3174,6 +3235,49 @@ static int dump_trigger(FILE *sql_file, MYSQL_RES *show_create_trigger_rs,
   DBUG_RETURN(FALSE);
 }
 
+/*
+  Get the file of --chunk-dir for the triggers of a database.
+
+  The triggers can't be in the dump itself, as the data is loaded after
+  it and the triggers would fire for every row. The file of the previous
+  database is closed.
+*/
+
+static FILE *open_chunk_triggers_file(const char *db_name)
+{
+  char name[FN_REFLEN], file_name[FN_REFLEN];
+  char db_buff[NAME_LEN * 2 + 3];
+
+  if (chunk_triggers_file && !strcmp(chunk_triggers_db, db_name))
+    return chunk_triggers_file;
+  if (chunk_triggers_file)
+  {
+    my_fclose(chunk_triggers_file, MYF(0));
+    chunk_triggers_file= 0;
+  }
+
+  convert_dirname(file_name, opt_chunk_dir, NullS);
+  my_load_path(file_name, file_name, NULL);
+  my_snprintf(name, sizeof(name), "%s.triggers", db_name);
+  fn_format(file_name, name, file_name, ".sql",
+            MYF(MY_UNPACK_FILENAME | MY_APPEND_EXT));
+  if (!(chunk_triggers_file= my_fopen(file_name, O_WRONLY, MYF(MY_WME))))
+    return 0;
+  strmake(chunk_triggers_db, db_name, NAME_LEN);
+
+  print_comment(chunk_triggers_file, 0,
+                "--\n-- Triggers of database %s, load after the data\n--\n\n",
+                db_name);
+  if (opt_set_charset)
+    fprintf(chunk_triggers_file, "/*!40101 SET NAMES %s */;\n",
+            default_charset);
+  fprintf(chunk_triggers_file, "USE %s;\n\n",
+          quote_name(db_name, db_buff, 1));
+  check_io(chunk_triggers_file);
+  return chunk_triggers_file;
+}
+
+
 /**
   Dump the triggers for a given table.
 
@@ -3232,6 +3336,12 @@ static int dump_triggers_for_table(char *table_name, char *db_name)
   if (! mysql_num_rows(show_triggers_rs))
     goto skip;
 
+  if (opt_chunk_dir && !(sql_file= open_chunk_triggers_file(db_name)))
+  {
+    mysql_free_result(show_triggers_rs);
+    goto done;
+  }
+
   if (opt_xml)
     print_xml_tag(sql_file, "\t", "\n", "triggers", "name=",
                   table_name, NullS);
@@ -3369,6 +3479,772 @@ static char *alloc_query_str(ulong size)
 }
 
 
+/*
+  Write the rows of a SELECT on a table as INSERT statements or XML.
+
+  SYNOPSIS
+    dump_rows()
+    mysql_con     connection the rows are read from
+    res           result of the SELECT
+    file          file to write to
+    insert        INSERT statement up to the values, see insert_pat
+    row_buf       buffer for the values of a row of an extended INSERT
+    table         name of the table
+    result_table  quoted name of the table
+
+  RETURN
+    0             ok
+    EX_CONSCHECK  reading the rows failed
+*/
+
+static int dump_rows(MYSQL *mysql_con, MYSQL_RES *res, FILE *file,
+                     const char *insert, DYNAMIC_STRING *row_buf,
+                     const char *table, const char *result_table)
+{
+  char buf[200];
+  ulong rownr, row_break, total_length, init_length;
+  MYSQL_FIELD *field;
+  MYSQL_ROW row;
+  DBUG_ENTER("dump_rows");
+
+  total_length= opt_net_buffer_length;                /* Force row break */
+  row_break=0;
+  rownr=0;
+  init_length= (ulong) strlen(insert) + 4;
+  if (opt_xml)
+    print_xml_tag(file, "\t", "\n", "table_data", "name=", table,
+            NullS);
+  if (opt_autocommit)
+  {
+    fprintf(file, "set autocommit=0;\n");
+    check_io(file);
+  }
+
+  while ((row= mysql_fetch_row(res)))
+  {
+    uint i;
+    ulong *lengths= mysql_fetch_lengths(res);
+    rownr++;
+    if (!extended_insert && !opt_xml)
+    {
+      fputs(insert,file);
+      check_io(file);
+    }
+    mysql_field_seek(res,0);
+
+    if (opt_xml)
+    {
+      fputs("\t<row>\n", file);
+      check_io(file);
+    }
+
+    for (i= 0; i < mysql_num_fields(res); i++)
+    {
+      int is_blob;
+      ulong length= lengths[i];
+
+      if (!(field= mysql_fetch_field(res)))
+      {
+        die(EX_CONSCHECK,
+                    "Not enough fields from table %s! Aborting.\n",
+                    result_table);
+        DBUG_RETURN(EX_CONSCHECK);
+      }
+
+      /*
+         63 is my_charset_bin. If charsetnr is not 63,
+         we have not a BLOB but a TEXT column.
+         we'll dump in hex only BLOB columns.
+      */
+      is_blob= (opt_hex_blob && field->charsetnr == 63 &&
+                (field->type == MYSQL_TYPE_BIT ||
+                 field->type == MYSQL_TYPE_STRING ||
+                 field->type == MYSQL_TYPE_VAR_STRING ||
+                 field->type == MYSQL_TYPE_VARCHAR ||
+                 field->type == MYSQL_TYPE_BLOB ||
+                 field->type == MYSQL_TYPE_LONG_BLOB ||
+                 field->type == MYSQL_TYPE_MEDIUM_BLOB ||
+                 field->type == MYSQL_TYPE_TINY_BLOB)) ? 1 : 0;
+      if (extended_insert && !opt_xml)
+      {
+        if (i == 0)
+          dynstr_set_checked(row_buf,"(");
+        else
+          dynstr_append_checked(row_buf,",");
+
+        if (row[i])
+        {
+          if (length)
+          {
+            if (!(field->flags & NUM_FLAG))
+            {
+              /*
+                "length * 2 + 2" is OK for both HEX and non-HEX modes:
+                - In HEX mode we need exactly 2 bytes per character
+                plus 2 bytes for '0x' prefix.
+                - In non-HEX mode we need up to 2 bytes per character,
+                plus 2 bytes for leading and trailing '\'' characters.
+                Also we need to reserve 1 byte for terminating '\0'.
+              */
+              dynstr_realloc_checked(row_buf,length * 2 + 2 + 1);
+              if (opt_hex_blob && is_blob)
+              {
+                dynstr_append_checked(row_buf, "0x");
+                row_buf->length+= mysql_hex_string(row_buf->str +
+                                                       row_buf->length,
+                                                       row[i], length);
+                DBUG_ASSERT(row_buf->length+1 <= row_buf->max_length);
+                /* mysql_hex_string() already terminated string by '\0' */
+                DBUG_ASSERT(row_buf->str[row_buf->length] == '\0');
+              }
+              else
+              {
+                dynstr_append_checked(row_buf,"'");
+                row_buf->length +=
+                mysql_real_escape_string(mysql_con,
+                                         &row_buf->str[row_buf->length],
+                                         row[i],length);
+                row_buf->str[row_buf->length]='\0';
+                dynstr_append_checked(row_buf,"'");
+              }
+            }
+            else
+            {
+              /* change any strings ("inf", "-inf", "nan") into NULL */
+              char *ptr= row[i];
+              if (my_isalpha(charset_info, *ptr) || (*ptr == '-' &&
+                  my_isalpha(charset_info, ptr[1])))
+                dynstr_append_checked(row_buf, "NULL");
+              else
+              {
+                if (field->type == MYSQL_TYPE_DECIMAL)
+                {
+                  /* add " signs around */
+                  dynstr_append_checked(row_buf, "'");
+                  dynstr_append_checked(row_buf, ptr);
+                  dynstr_append_checked(row_buf, "'");
+                }
+                else
+                  dynstr_append_checked(row_buf, ptr);
+              }
+            }
+          }
+          else
+            dynstr_append_checked(row_buf,"''");
+        }
+        else
+          dynstr_append_checked(row_buf,"NULL");
+      }
+      else
+      {
+        if (i && !opt_xml)
+        {
+          fputc(',', file);
+          check_io(file);
+        }
+        if (row[i])
+        {
+          if (!(field->flags & NUM_FLAG))
+          {
+            if (opt_xml)
+            {
+              if (opt_hex_blob && is_blob && length)
+              {
+                /* Define xsi:type="xs:hexBinary" for hex encoded data */
+                print_xml_tag(file, "\t\t", "", "field", "name=",
+                              field->name, "xsi:type=", "xs:hexBinary", NullS);
+                print_blob_as_hex(file, row[i], length);
+              }
+              else
+              {
+                print_xml_tag(file, "\t\t", "", "field", "name=", 
+                              field->name, NullS);
+                print_quoted_xml(file, row[i], length, 0);
+              }
+              fputs("</field>\n", file);
+            }
+            else if (opt_hex_blob && is_blob && length)
+            {
+              fputs("0x", file);
+              print_blob_as_hex(file, row[i], length);
+            }
+            else
+              unescape(mysql_con, file, row[i], length);
+          }
+          else
+          {
+            /* change any strings ("inf", "-inf", "nan") into NULL */
+            char *ptr= row[i];
+            if (opt_xml)
+            {
+              print_xml_tag(file, "\t\t", "", "field", "name=",
+                      field->name, NullS);
+              fputs(!my_isalpha(charset_info, *ptr) ? ptr: "NULL",
+                    file);
+              fputs("</field>\n", file);
+            }
+            else if (my_isalpha(charset_info, *ptr) ||
+                     (*ptr == '-' && my_isalpha(charset_info, ptr[1])))
+              fputs("NULL", file);
+            else if (field->type == MYSQL_TYPE_DECIMAL)
+            {
+              /* add " signs around */
+              fputc('\'', file);
+              fputs(ptr, file);
+              fputc('\'', file);
+            }
+            else
+              fputs(ptr, file);
+          }
+        }
+        else
+        {
+          /* The field value is NULL */
+          if (!opt_xml)
+            fputs("NULL", file);
+          else
+            print_xml_null_tag(file, "\t\t", "field name=",
+                               field->name, "\n");
+        }
+        check_io(file);
+      }
+    }
+
+    if (opt_xml)
+    {
+      fputs("\t</row>\n", file);
+      check_io(file);
+    }
+
+    if (extended_insert)
+    {
+      ulong row_length;
+      dynstr_append_checked(row_buf,")");
+      row_length= 2 + row_buf->length;
+      if (total_length + row_length < opt_net_buffer_length)
+      {
+        total_length+= row_length;
+        fputc(',',file);            /* Always row break */
+        fputs(row_buf->str,file);
+      }
+      else
+      {
+        if (row_break)
+          fputs(";\n", file);
+        row_break=1;                          /* This is first row */
+
+        fputs(insert,file);
+        fputs(row_buf->str,file);
+        total_length= row_length+init_length;
+      }
+      check_io(file);
+    }
+    else if (!opt_xml)
+    {
+      fputs(");\n", file);
+      check_io(file);
+    }
+  }
+
+  /* XML - close table tag and supress regular output */
+  if (opt_xml)
+      fputs("\t</table_data>\n", file);
+  else if (extended_insert && row_break)
+    fputs(";\n", file);             /* If not empty table */
+  fflush(file);
+  check_io(file);
+  if (mysql_errno(mysql_con))
+  {
+    my_snprintf(buf, sizeof(buf),
+                "%s: Error %d: %s when dumping table %s at row: %ld\n",
+                my_progname_short,
+                mysql_errno(mysql_con),
+                mysql_error(mysql_con),
+                result_table,
+                rownr);
+    fputs(buf,stderr);
+    DBUG_RETURN(EX_CONSCHECK);
+  }
+
+  DBUG_RETURN(0);
+} /* dump_rows */
+
+
+/*
+  Parts of the tables written by the threads of --chunk-dir, see
+  dump_table_chunks(). A chunk and its strings are one allocation.
+*/
+
+typedef struct st_dump_chunk
+{
+  struct st_dump_chunk *next;
+  char *file_name;                      /* file the rows are written to */
+  char *db;                             /* quoted name of the database */
+  char *table, *result_table;           /* name and quoted name of table */
+  char *query;                          /* SELECT of the rows */
+  char *insert;                         /* copy of insert_pat */
+} DUMP_CHUNK;
+
+static DUMP_CHUNK *chunk_queue= 0, **chunk_queue_end= &chunk_queue;
+static my_bool chunk_queue_closed= 0;
+static MYSQL *chunk_connections= 0;
+static uint chunk_connection_count= 0, chunk_threads= 0;
+static pthread_mutex_t chunk_lock;
+static pthread_cond_t chunk_cond;
+static pthread_t chunk_main_thread;
+/* Errors of the threads, for the main thread; protected by chunk_lock */
+static my_bool chunk_failed= 0;
+static int chunk_first_error= 0;
+
+
+/*
+  Record an error of a thread of --chunk-dir.
+
+  The threads must not exit or free anything, as the main thread is
+  still using its connection and the global resources. It exits in
+  end_chunk_threads() instead, or with the next chunk it queues.
+
+  RETURN VALUES
+    0   not called by a thread of --chunk-dir
+    1   error recorded
+*/
+
+static my_bool chunk_thread_error(int error, my_bool fatal)
+{
+  if (!chunk_connections || pthread_equal(pthread_self(), chunk_main_thread))
+    return 0;
+  pthread_mutex_lock(&chunk_lock);
+  if (!chunk_first_error)
+    chunk_first_error= error;
+  if (fatal)
+    chunk_failed= 1;
+  pthread_mutex_unlock(&chunk_lock);
+  return 1;
+}
+
+
+/*
+  Write the rows of a chunk into its file.
+
+  The file sets up its session like the header of the dump does, so
+  the files of a dump can be loaded in any order and in parallel once
+  the tables are created.
+*/
+
+static void dump_chunk(MYSQL *mysql_con, DUMP_CHUNK *chunk,
+                       DYNAMIC_STRING *row_buf)
+{
+  FILE *file;
+  MYSQL_RES *res;
+  int error;
+  DBUG_ENTER("dump_chunk");
+
+  verbose_msg("-- Writing %s...\n", chunk->file_name);
+  if (!(file= my_fopen(chunk->file_name, O_WRONLY, MYF(MY_WME))))
+  {
+    maybe_exit(EX_EOF);
+    DBUG_VOID_RETURN;
+  }
+
+  /* print_comment() isn't used here, it has a static buffer */
+  if (opt_comments)
+    fprintf(file, "--\n-- Dumping data for table %s.%s\n--\n\n",
+            chunk->db, chunk->result_table);
+  if (opt_set_charset)
+    fprintf(file, "/*!40101 SET NAMES %s */;\n", default_charset);
+  if (opt_tz_utc)
+    fputs("/*!40103 SET TIME_ZONE='+00:00' */;\n", file);
+  fprintf(file,
+          "/*!40014 SET UNIQUE_CHECKS=0, FOREIGN_KEY_CHECKS=0 */;\n"
+          "/*!40101 SET SQL_MODE='NO_AUTO_VALUE_ON_ZERO%s%s' */;\n"
+          "/*!40111 SET SQL_NOTES=0 */;\n"
+          "USE %s;\n\n",
+          compatible_mode_normal_str[0] == 0 ? "" : ",",
+          compatible_mode_normal_str, chunk->db);
+  check_io(file);
+
+  if (mysql_query_with_error_report(mysql_con, 0, chunk->query))
+    goto end;
+  if (quick)
+    res= mysql_use_result(mysql_con);
+  else
+    res= mysql_store_result(mysql_con);
+  if (!res)
+  {
+    DB_error(mysql_con, "when retrieving data from server");
+    goto end;
+  }
+  error= dump_rows(mysql_con, res, file, chunk->insert, row_buf,
+                   chunk->table, chunk->result_table);
+  mysql_free_result(res);
+  if (error)
+  {
+    maybe_exit(error);
+    goto end;
+  }
+  if (opt_autocommit)
+  {
+    fputs("commit;\n", file);
+    check_io(file);
+  }
+
+end:
+  my_fclose(file, MYF(0));
+  DBUG_VOID_RETURN;
+}
+
+
+pthread_handler_t dump_chunk_thread(void *arg)
+{
+  MYSQL *mysql_con= (MYSQL*) arg;
+  DYNAMIC_STRING row_buf;
+  DUMP_CHUNK *chunk;
+  my_bool failed;
+
+  mysql_thread_init();
+  init_dynamic_string_checked(&row_buf, "", 1024, 1024);
+  for (;;)
+  {
+    pthread_mutex_lock(&chunk_lock);
+    while (!chunk_queue && !chunk_queue_closed)
+      pthread_cond_wait(&chunk_cond, &chunk_lock);
+    if ((chunk= chunk_queue) && !(chunk_queue= chunk->next))
+      chunk_queue_end= &chunk_queue;
+    failed= chunk_failed;
+    pthread_mutex_unlock(&chunk_lock);
+    if (!chunk)
+      break;
+    /* After a fatal error the remaining chunks are only dropped */
+    if (!failed)
+      dump_chunk(mysql_con, chunk, &row_buf);
+    my_free(chunk);
+  }
+  dynstr_free(&row_buf);
+
+  pthread_mutex_lock(&chunk_lock);
+  chunk_threads--;
+  pthread_cond_broadcast(&chunk_cond);
+  pthread_mutex_unlock(&chunk_lock);
+  mysql_thread_end();
+  return 0;
+}
+
+
+/*
+  Open the connections of --chunk-dir and start their threads.
+
+  NOTES
+    Called with the global read lock taken, so that the transactions of
+    all connections see the snapshot of the connection of the dump.
+*/
+
+static int start_chunk_threads()
+{
+  pthread_t thread;
+  pthread_attr_t attr;
+  MYSQL *mysql_con;
+  int error= 0;
+  DBUG_ENTER("start_chunk_threads");
+
+  if (!(chunk_connections= (MYSQL*) my_malloc(opt_use_threads * sizeof(MYSQL),
+                                               MYF(MY_WME))))
+    DBUG_RETURN(1);
+  pthread_mutex_init(&chunk_lock, NULL);
+  pthread_cond_init(&chunk_cond, NULL);
+  chunk_main_thread= pthread_self();
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  verbose_msg("-- Starting %u threads for --chunk-dir...\n", opt_use_threads);
+  while (chunk_connection_count < opt_use_threads)
+  {
+    mysql_con= chunk_connections + chunk_connection_count++;
+    if (open_connection(mysql_con, current_host, current_user,
+                        opt_password) ||
+        start_transaction(mysql_con))
+    {
+      error= 1;
+      break;
+    }
+    pthread_mutex_lock(&chunk_lock);
+    if (pthread_create(&thread, &attr, dump_chunk_thread, mysql_con))
+    {
+      pthread_mutex_unlock(&chunk_lock);
+      fprintf(stderr, "%s: Could not create thread\n", my_progname_short);
+      error= 1;
+      break;
+    }
+    chunk_threads++;
+    pthread_mutex_unlock(&chunk_lock);
+  }
+  pthread_attr_destroy(&attr);
+  DBUG_RETURN(error);
+}
+
+
+/*
+  Wait until the threads of --chunk-dir have written all queued chunks
+  and close their connections.
+
+  SYNOPSIS
+    end_chunk_threads()
+    abort       the dump is failing, drop the chunks not started yet
+
+  DESCRIPTION
+    Exits with the error of a thread that failed, unless abort is set.
+*/
+
+static void end_chunk_threads(my_bool abort)
+{
+  uint i;
+  my_bool failed;
+  int error;
+
+  if (!chunk_connections)
+    return;
+  pthread_mutex_lock(&chunk_lock);
+  chunk_queue_closed= 1;
+  if (abort)
+    chunk_failed= 1;
+  pthread_cond_broadcast(&chunk_cond);
+  while (chunk_threads)
+    pthread_cond_wait(&chunk_cond, &chunk_lock);
+  failed= chunk_failed;
+  error= chunk_first_error;
+  pthread_mutex_unlock(&chunk_lock);
+
+  for (i= 0; i < chunk_connection_count; i++)
+    mysql_close(chunk_connections + i);
+  my_free(chunk_connections);
+  chunk_connections= 0;
+  pthread_cond_destroy(&chunk_cond);
+  pthread_mutex_destroy(&chunk_lock);
+
+  if (error && !first_error)
+    first_error= error;
+  if (failed && !abort)
+  {
+    ignore_errors= 0; /* force the exit */
+    maybe_exit(error);
+  }
+}
+
+
+static void queue_chunk(const char *file_name, const char *db,
+                        const char *table, const char *result_table,
+                        const char *query)
+{
+  DUMP_CHUNK *chunk;
+  size_t length= strlen(file_name) + strlen(db) + strlen(table) +
+                 strlen(result_table) + strlen(query) + insert_pat.length + 6;
+
+  if (!(chunk= (DUMP_CHUNK*) my_malloc(sizeof(DUMP_CHUNK) + length,
+                                       MYF(MY_WME))))
+    die(EX_MYSQLERR, "Couldn't allocate memory");
+  chunk->next= 0;
+  chunk->file_name= (char*) (chunk + 1);
+  chunk->db= strmov(chunk->file_name, file_name) + 1;
+  chunk->table= strmov(chunk->db, db) + 1;
+  chunk->result_table= strmov(chunk->table, table) + 1;
+  chunk->query= strmov(chunk->result_table, result_table) + 1;
+  chunk->insert= strmov(chunk->query, query) + 1;
+  strmov(chunk->insert, insert_pat.str);
+
+  pthread_mutex_lock(&chunk_lock);
+  if (chunk_failed)
+  {
+    pthread_mutex_unlock(&chunk_lock);
+    my_free(chunk);
+    end_chunk_threads(0);                       /* exits */
+    return;
+  }
+  *chunk_queue_end= chunk;
+  chunk_queue_end= &chunk->next;
+  pthread_cond_signal(&chunk_cond);
+  pthread_mutex_unlock(&chunk_lock);
+}
+
+
+/*
+  Get the value of an integer key in the row at an offset of a table.
+
+  SYNOPSIS
+    get_chunk_key()
+    result_table        quoted name of the table
+    key                 quoted name of the key column
+    from                count from this key value, or from the smallest
+                        one if 0
+    offset              number of rows to skip
+    value               out: the key value, as a string
+
+  DESCRIPTION
+    Only the rows selected by --where are counted, and not the rows where
+    the key is NULL.
+
+  RETURN VALUES
+    0   no such row, or the key is not an integer column
+    1   found
+*/
+
+static my_bool get_chunk_key(const char *result_table, const char *key,
+                             const char *from, ulonglong offset,
+                             char *value)
+{
+  char buff[NAME_LEN * 4 + 80];
+  DYNAMIC_STRING query;
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  MYSQL_FIELD *field;
+  my_bool found= 0;
+
+  init_dynamic_string_checked(&query, "", 1024, 1024);
+  my_snprintf(buff, sizeof(buff), "SELECT %s FROM %s WHERE %s ",
+              key, result_table, key);
+  dynstr_append_checked(&query, buff);
+  if (from)
+  {
+    dynstr_append_checked(&query, ">= ");
+    dynstr_append_checked(&query, from);
+  }
+  else
+    dynstr_append_checked(&query, "IS NOT NULL");
+  if (where)
+  {
+    dynstr_append_checked(&query, " AND (");
+    dynstr_append_checked(&query, where);
+    dynstr_append_checked(&query, ")");
+  }
+  my_snprintf(buff, sizeof(buff), " ORDER BY %s LIMIT %llu,1", key, offset);
+  dynstr_append_checked(&query, buff);
+
+  if (mysql_query_with_error_report(mysql, &res, query.str))
+  {
+    dynstr_free(&query);
+    return 0;
+  }
+  dynstr_free(&query);
+  field= mysql_fetch_field_direct(res, 0);
+  if ((row= mysql_fetch_row(res)) && row[0] &&
+      (field->type == MYSQL_TYPE_TINY || field->type == MYSQL_TYPE_SHORT ||
+       field->type == MYSQL_TYPE_INT24 || field->type == MYSQL_TYPE_LONG ||
+       field->type == MYSQL_TYPE_LONGLONG))
+  {
+    strmake(value, row[0], 21);
+    found= 1;
+  }
+  mysql_free_result(res);
+  return found;
+}
+
+
+/*
+  Queue the rows of a table for the threads of --chunk-dir.
+
+  With --chunk-rows a table with a single column integer primary or
+  unique key is split into files of that many rows. The boundaries are
+  found by walking the key from one boundary to the row --chunk-rows
+  further, so gaps in the key values don't make empty files. The first
+  file also has the rows where the key is NULL.
+*/
+
+static void dump_table_chunks(char *table, char *db, char *result_table)
+{
+  char db_buff[NAME_LEN * 2 + 3], *quoted_db;
+  char dir[FN_REFLEN], name[FN_REFLEN], file_name[FN_REFLEN];
+  char value[22], *from, *to;
+  char *key= 0;
+  ulonglong i, chunks;
+  DYNAMIC_ARRAY bounds;
+  DYNAMIC_STRING query;
+  DBUG_ENTER("dump_table_chunks");
+
+  quoted_db= quote_name(db, db_buff, 1);
+  convert_dirname(dir, opt_chunk_dir, NullS);
+  my_load_path(dir, dir, NULL);
+
+  /* Upper bound of each file but the last one */
+  if (my_init_dynamic_array(&bounds, sizeof(value), 16, 16))
+    die(EX_MYSQLERR, "Couldn't allocate memory");
+  /* A key of several columns has a ',' unless a quoted name has one */
+  if (opt_chunk_rows && (key= primary_key_fields(result_table)) &&
+      !strchr(key, ','))
+  {
+    from= 0;
+    while (get_chunk_key(result_table, key, from, opt_chunk_rows, value))
+    {
+      if (insert_dynamic(&bounds, (uchar*) value))
+        die(EX_MYSQLERR, "Couldn't allocate memory");
+      from= (char*) dynamic_array_ptr(&bounds, bounds.elements - 1);
+    }
+  }
+  chunks= bounds.elements + 1;
+
+  print_comment(md_result_file, 0,
+                "\n--\n-- Dumping data for table %s into %lu files of "
+                "--chunk-dir\n--\n", result_table, (ulong) chunks);
+
+  init_dynamic_string_checked(&query, "", 1024, 1024);
+  for (i= 0; i < chunks; i++)
+  {
+    from= i > 0 ? (char*) dynamic_array_ptr(&bounds, (uint) i - 1) : 0;
+    to= i < chunks - 1 ? (char*) dynamic_array_ptr(&bounds, (uint) i) : 0;
+    dynstr_set_checked(&query, "SELECT /*!40001 SQL_NO_CACHE */ * FROM ");
+    dynstr_append_checked(&query, quoted_db);
+    dynstr_append_checked(&query, ".");
+    dynstr_append_checked(&query, result_table);
+    if (where || chunks > 1)
+      dynstr_append_checked(&query, " WHERE ");
+    if (where)
+    {
+      dynstr_append_checked(&query, "(");
+      dynstr_append_checked(&query, where);
+      dynstr_append_checked(&query, ")");
+      if (chunks > 1)
+        dynstr_append_checked(&query, " AND ");
+    }
+    if (chunks > 1)
+    {
+      dynstr_append_checked(&query, "(");
+      if (from)
+      {
+        dynstr_append_checked(&query, key);
+        dynstr_append_checked(&query, " >= ");
+        dynstr_append_checked(&query, from);
+      }
+      if (from && to)
+        dynstr_append_checked(&query, " AND ");
+      if (to)
+      {
+        dynstr_append_checked(&query, key);
+        dynstr_append_checked(&query, " < ");
+        dynstr_append_checked(&query, to);
+      }
+      if (i == 0)
+      {
+        dynstr_append_checked(&query, " OR ");
+        dynstr_append_checked(&query, key);
+        dynstr_append_checked(&query, " IS NULL");
+      }
+      dynstr_append_checked(&query, ")");
+    }
+    if (order_by)
+    {
+      dynstr_append_checked(&query, " ORDER BY ");
+      dynstr_append_checked(&query, order_by);
+    }
+
+    my_snprintf(name, sizeof(name), "%s.%s.%lu", db, table, (ulong) (i + 1));
+    fn_format(file_name, name, dir, ".sql",
+              MYF(MY_UNPACK_FILENAME | MY_APPEND_EXT));
+    queue_chunk(file_name, quoted_db, table, result_table, query.str);
+  }
+  dynstr_free(&query);
+  delete_dynamic(&bounds);
+  my_free(key);
+  DBUG_VOID_RETURN;
+}
+
+
 /*
 
  SYNOPSIS
@@ -3388,16 +4264,13 @@ static char *alloc_query_str(ulong size)
 static void dump_table(char *table, char *db)
 {
   char ignore_flag;
-  char buf[200], table_buff[NAME_LEN+3];
+  char table_buff[NAME_LEN+3];
   DYNAMIC_STRING query_string;
   char table_type[NAME_LEN];
   char *result_table, table_buff2[NAME_LEN*2+3], *opt_quoted_table;
   int error= 0;
-  ulong         rownr, row_break, total_length, init_length;
   uint num_fields;
   MYSQL_RES     *res;
-  MYSQL_FIELD   *field;
-  MYSQL_ROW     row;
   DBUG_ENTER("dump_table");
 
   /*
@@ -3456,6 +4329,12 @@ static void dump_table(char *table, char *db)
   result_table= quote_name(table,table_buff, 1);
   opt_quoted_table= quote_name(table, table_buff2, 0);
 
+  if (opt_chunk_dir)
+  {
+    dump_table_chunks(table, db, result_table);
+    DBUG_VOID_RETURN;
+  }
+
   verbose_msg("-- Sending SELECT query...\n");
 
   init_dynamic_string_checked(&query_string, "", 1024, 1024);
@@ -3587,262 +4466,9 @@ static void dump_table(char *table, char *db)
       check_io(md_result_file);
     }
 
-    total_length= opt_net_buffer_length;                /* Force row break */
-    row_break=0;
-    rownr=0;
-    init_length=(uint) insert_pat.length+4;
-    if (opt_xml)
-      print_xml_tag(md_result_file, "\t", "\n", "table_data", "name=", table,
-              NullS);
-    if (opt_autocommit)
-    {
-      fprintf(md_result_file, "set autocommit=0;\n");
-      check_io(md_result_file);
-    }
-
-    while ((row= mysql_fetch_row(res)))
-    {
-      uint i;
-      ulong *lengths= mysql_fetch_lengths(res);
-      rownr++;
-      if (!extended_insert && !opt_xml)
-      {
-        fputs(insert_pat.str,md_result_file);
-        check_io(md_result_file);
-      }
-      mysql_field_seek(res,0);
-
-      if (opt_xml)
-      {
-        fputs("\t<row>\n", md_result_file);
-        check_io(md_result_file);
-      }
-
-      for (i= 0; i < mysql_num_fields(res); i++)
-      {
-        int is_blob;
-        ulong length= lengths[i];
-
-        if (!(field= mysql_fetch_field(res)))
-          die(EX_CONSCHECK,
-                      "Not enough fields from table %s! Aborting.\n",
-                      result_table);
-
-        /*
-           63 is my_charset_bin. If charsetnr is not 63,
-           we have not a BLOB but a TEXT column.
-           we'll dump in hex only BLOB columns.
-        */
-        is_blob= (opt_hex_blob && field->charsetnr == 63 &&
-                  (field->type == MYSQL_TYPE_BIT ||
-                   field->type == MYSQL_TYPE_STRING ||
-                   field->type == MYSQL_TYPE_VAR_STRING ||
-                   field->type == MYSQL_TYPE_VARCHAR ||
-                   field->type == MYSQL_TYPE_BLOB ||
-                   field->type == MYSQL_TYPE_LONG_BLOB ||
-                   field->type == MYSQL_TYPE_MEDIUM_BLOB ||
-                   field->type == MYSQL_TYPE_TINY_BLOB)) ? 1 : 0;
-        if (extended_insert && !opt_xml)
-        {
-          if (i == 0)
-            dynstr_set_checked(&extended_row,"(");
-          else
-            dynstr_append_checked(&extended_row,",");
-
-          if (row[i])
-          {
-            if (length)
-            {
-              if (!(field->flags & NUM_FLAG))
-              {
-                /*
-                  "length * 2 + 2" is OK for both HEX and non-HEX modes:
-                  - In HEX mode we need exactly 2 bytes per character
-                  plus 2 bytes for '0x' prefix.
-                  - In non-HEX mode we need up to 2 bytes per character,
-                  plus 2 bytes for leading and trailing '\'' characters.
-                  Also we need to reserve 1 byte for terminating '\0'.
-                */
-                dynstr_realloc_checked(&extended_row,length * 2 + 2 + 1);
-                if (opt_hex_blob && is_blob)
-                {
-                  dynstr_append_checked(&extended_row, "0x");
-                  extended_row.length+= mysql_hex_string(extended_row.str +
-                                                         extended_row.length,
-                                                         row[i], length);
-                  DBUG_ASSERT(extended_row.length+1 <= extended_row.max_length);
-                  /* mysql_hex_string() already terminated string by '\0' */
-                  DBUG_ASSERT(extended_row.str[extended_row.length] == '\0');
-                }
-                else
-                {
-                  dynstr_append_checked(&extended_row,"'");
-                  extended_row.length +=
-                  mysql_real_escape_string(&mysql_connection,
-                                           &extended_row.str[extended_row.length],
-                                           row[i],length);
-                  extended_row.str[extended_row.length]='\0';
-                  dynstr_append_checked(&extended_row,"'");
-                }
-              }
-              else
-              {
-                /* change any strings ("inf", "-inf", "nan") into NULL */
-                char *ptr= row[i];
-                if (my_isalpha(charset_info, *ptr) || (*ptr == '-' &&
-                    my_isalpha(charset_info, ptr[1])))
-                  dynstr_append_checked(&extended_row, "NULL");
-                else
-                {
-                  if (field->type == MYSQL_TYPE_DECIMAL)
-                  {
-                    /* add " signs around */
-                    dynstr_append_checked(&extended_row, "'");
-                    dynstr_append_checked(&extended_row, ptr);
-                    dynstr_append_checked(&extended_row, "'");
-                  }
-                  else
-                    dynstr_append_checked(&extended_row, ptr);
-                }
-              }
-            }
-            else
-              dynstr_append_checked(&extended_row,"''");
-          }
-          else
-            dynstr_append_checked(&extended_row,"NULL");
-        }
-        else
-        {
-          if (i && !opt_xml)
-          {
-            fputc(',', md_result_file);
-            check_io(md_result_file);
-          }
-          if (row[i])
-          {
-            if (!(field->flags & NUM_FLAG))
-            {
-              if (opt_xml)
-              {
-                if (opt_hex_blob && is_blob && length)
-                {
-                  /* Define xsi:type="xs:hexBinary" for hex encoded data */
-                  print_xml_tag(md_result_file, "\t\t", "", "field", "name=",
-                                field->name, "xsi:type=", "xs:hexBinary", NullS);
-                  print_blob_as_hex(md_result_file, row[i], length);
-                }
-                else
-                {
-                  print_xml_tag(md_result_file, "\t\t", "", "field", "name=", 
-                                field->name, NullS);
-                  print_quoted_xml(md_result_file, row[i], length, 0);
-                }
-                fputs("</field>\n", md_result_file);
-              }
-              else if (opt_hex_blob && is_blob && length)
-              {
-                fputs("0x", md_result_file);
-                print_blob_as_hex(md_result_file, row[i], length);
-              }
-              else
-                unescape(md_result_file, row[i], length);
-            }
-            else
-            {
-              /* change any strings ("inf", "-inf", "nan") into NULL */
-              char *ptr= row[i];
-              if (opt_xml)
-              {
-                print_xml_tag(md_result_file, "\t\t", "", "field", "name=",
-                        field->name, NullS);
-                fputs(!my_isalpha(charset_info, *ptr) ? ptr: "NULL",
-                      md_result_file);
-                fputs("</field>\n", md_result_file);
-              }
-              else if (my_isalpha(charset_info, *ptr) ||
-                       (*ptr == '-' && my_isalpha(charset_info, ptr[1])))
-                fputs("NULL", md_result_file);
-              else if (field->type == MYSQL_TYPE_DECIMAL)
-              {
-                /* add " signs around */
-                fputc('\'', md_result_file);
-                fputs(ptr, md_result_file);
-                fputc('\'', md_result_file);
-              }
-              else
-                fputs(ptr, md_result_file);
-            }
-          }
-          else
-          {
-            /* The field value is NULL */
-            if (!opt_xml)
-              fputs("NULL", md_result_file);
-            else
-              print_xml_null_tag(md_result_file, "\t\t", "field name=",
-                                 field->name, "\n");
-          }
-          check_io(md_result_file);
-        }
-      }
-
-      if (opt_xml)
-      {
-        fputs("\t</row>\n", md_result_file);
-        check_io(md_result_file);
-      }
-
-      if (extended_insert)
-      {
-        ulong row_length;
-        dynstr_append_checked(&extended_row,")");
-        row_length= 2 + extended_row.length;
-        if (total_length + row_length < opt_net_buffer_length)
-        {
-          total_length+= row_length;
-          fputc(',',md_result_file);            /* Always row break */
-          fputs(extended_row.str,md_result_file);
-        }
-        else
-        {
-          if (row_break)
-            fputs(";\n", md_result_file);
-          row_break=1;                          /* This is first row */
-
-          fputs(insert_pat.str,md_result_file);
-          fputs(extended_row.str,md_result_file);
-          total_length= row_length+init_length;
-        }
-        check_io(md_result_file);
-      }
-      else if (!opt_xml)
-      {
-        fputs(");\n", md_result_file);
-        check_io(md_result_file);
-      }
-    }
-
-    /* XML - close table tag and supress regular output */
-    if (opt_xml)
-        fputs("\t</table_data>\n", md_result_file);
-    else if (extended_insert && row_break)
-      fputs(";\n", md_result_file);             /* If not empty table */
-    fflush(md_result_file);
-    check_io(md_result_file);
-    if (mysql_errno(mysql))
-    {
-      my_snprintf(buf, sizeof(buf),
-                  "%s: Error %d: %s when dumping table %s at row: %ld\n",
-                  my_progname_short,
-                  mysql_errno(mysql),
-                  mysql_error(mysql),
-                  result_table,
-                  rownr);
-      fputs(buf,stderr);
-      error= EX_CONSCHECK;
+    if ((error= dump_rows(mysql, res, md_result_file, insert_pat.str,
+                          &extended_row, table, result_table)))
       goto err;
-    }
 
     /* Moved enable keys to before unlock per bug 15977 */
     if (opt_disable_keys)
@@ -5024,7 +5650,7 @@ static void print_value(FILE *file, MYSQL_RES  *result, MYSQL_ROW row,
         fputc(' ',file);
         fputs(prefix, file);
         if (string_value)
-          unescape(file,row[0],(uint) strlen(row[0]));
+          unescape(mysql, file, row[0], (uint) strlen(row[0]));
         else
           fputs(row[0], file);
         check_io(file);
@@ -5552,7 +6178,7 @@ int main(int argc, char **argv)
   }
 
   if ((opt_lock_all_tables || (opt_master_data && !consistent_binlog_pos) ||
-       (opt_single_transaction && flush_logs)) &&
+       (opt_single_transaction && flush_logs) || opt_chunk_dir) &&
       do_flush_tables_read_lock(mysql))
     goto err;
 
@@ -5583,6 +6209,8 @@ int main(int argc, char **argv)
 
   if (opt_single_transaction && start_transaction(mysql))
     goto err;
+  if (opt_chunk_dir && start_chunk_threads())
+    goto err;
 
   /* Add 'STOP SLAVE to beginning of dump */
   if (opt_slave_apply && add_stop_slave())
@@ -5629,8 +6257,12 @@ int main(int argc, char **argv)
   if (opt_slave_apply && add_slave_statements())
     goto err;
 
+  /* wait for the files of --chunk-dir */
+  end_chunk_threads(0);
+
   /* ensure dumped data flushed */
-  if (md_result_file && fflush(md_result_file))
+  if ((md_result_file && fflush(md_result_file)) ||
+      (chunk_triggers_file && fflush(chunk_triggers_file)))
   {
     if (!first_error)
       first_error= EX_MYSQLERR;
@@ -5650,6 +6282,7 @@ int main(int argc, char **argv)
     server.
   */
 err:
+  end_chunk_threads(1);
   dbDisconnect(current_host);
   if (!path)
     write_footer(md_result_file);
@@ -30,29 +30,28 @@
 
 #include "client_priv.h"
 #include "mysql_version.h"
-#ifdef HAVE_LIBPTHREAD
+#include <my_dir.h>
+#include <mysys_err.h>
 #include <my_pthread.h>
-#endif
 
 #include <welcome_copyright_notice.h>   /* ORACLE_WELCOME_COPYRIGHT_NOTICE */
 
 
 /* Global Thread counter */
 uint counter;
-#ifdef HAVE_LIBPTHREAD
 pthread_mutex_t counter_mutex;
 pthread_cond_t count_threshhold;
-#endif
 
 static void db_error_with_table(MYSQL *mysql, char *table);
 static void db_error(MYSQL *mysql);
 static char *field_escape(char *to,const char *from,uint length);
+static uint unescape_option(char *to, const char *from);
 static char *add_load_option(char *ptr,const char *object,
 			     const char *statement);
 
 static my_bool	verbose=0,lock_tables=0,ignore_errors=0,opt_delete=0,
 		replace=0,silent=0,ignore=0,opt_compress=0,
-                opt_low_priority= 0, tty_password= 0;
+                opt_low_priority= 0, tty_password= 0, opt_bulk_load= 0;
 static my_bool debug_info_flag= 0, debug_check_flag= 0;
 static uint opt_use_threads=0, opt_local_file=0, my_end_arg= 0;
 static char	*opt_password=0, *current_user=0,
@@ -64,10 +63,36 @@ static uint     opt_mysql_port= 0, opt_protocol= 0;
 static char * opt_mysql_unix_port=0;
 static char *opt_plugin_dir= 0, *opt_default_auth= 0;
 static longlong opt_ignore_lines= -1;
+static ulonglong opt_split_size= 0;
 #include <sslopt-vars.h>
 
 static char **argv_to_free;
 
+/*
+  A part of a file loaded by its own LOAD DATA LOCAL, see --split-size.
+  A file which isn't split is one part with end == 0.
+*/
+
+typedef struct st_file_part
+{
+  char *file_name;
+  my_off_t start, end;                  /* bytes of the file to load */
+  uint number, parts;                   /* part number of parts, from 1 */
+} FILE_PART;
+
+typedef struct st_part_infile
+{
+  File file;
+  my_off_t left;
+  int error_num;
+  char error_msg[LOCAL_INFILE_ERROR_LEN];
+} PART_INFILE;
+
+/* End of lines and escape character of the files, for --split-size */
+static char line_term[256];
+static uint line_term_length;
+static int escape_char;
+
 #ifdef HAVE_SMEM
 static char *shared_memory_base_name=0;
 #endif
@@ -80,6 +105,11 @@ static struct my_option my_long_options[] =
   {"default-character-set", OPT_DEFAULT_CHARSET,
    "Set the default character set.", &default_charset,
    &default_charset, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
+  {"bulk-load", OPT_BULK_LOAD,
+   "Turn off unique and foreign key checks in the sessions loading the "
+   "files, as a dump does. Only for files without duplicate keys; unique "
+   "checks stay on with --replace or --ignore.",
+   &opt_bulk_load, &opt_bulk_load, 0, GET_BOOL, NO_ARG, 0, 0, 0, 0, 0, 0},
   {"columns", 'c',
    "Use only these columns to import the data to. Give the column names in a comma separated list. This is same as giving columns to LOAD DATA INFILE.",
    &opt_columns, &opt_columns, 0, GET_STR, REQUIRED_ARG, 0, 0, 0,
@@ -174,6 +204,13 @@ static struct my_option my_long_options[] =
   {"socket", 'S', "The socket file to use for connection.",
    &opt_mysql_unix_port, &opt_mysql_unix_port, 0, GET_STR,
    REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
+  {"split-size", OPT_SPLIT_SIZE,
+   "With --local and --use-threads, split files larger than this many "
+   "bytes at the ends of lines into parts which are loaded into the table "
+   "by several threads. Files with enclosed fields aren't split, as lines "
+   "may be inside of fields. 0 loads every file with one thread.",
+   &opt_split_size, &opt_split_size, 0, GET_ULL, REQUIRED_ARG,
+   0, 0, ~(ulonglong) 0, 0, 1, 0},
 #include <sslopt-longopts.h>
   {"use-threads", OPT_USE_THREADS,
    "Load files in parallel. The argument is the number "
@@ -290,6 +327,22 @@ static int get_options(int *argc, char ***argv)
     fprintf(stderr, "You can't use --ignore (-i) and --replace (-r) at the same time.\n");
     return(1);
   }
+  if (opt_split_size)
+  {
+    char buff[256];
+    if (!opt_local_file)
+    {
+      fprintf(stderr, "You can't use --split-size without --local.\n");
+      return(1);
+    }
+    line_term_length= lines_terminated ?
+      unescape_option(line_term, lines_terminated) : 0;
+    if (!line_term_length)
+      line_term[line_term_length++]= '\n';
+    escape_char= '\\';
+    if (escaped)
+      escape_char= unescape_option(buff, escaped) ? (uchar) buff[0] : -1;
+  }
   if (*argc < 2)
   {
     usage();
@@ -304,11 +357,111 @@ static int get_options(int *argc, char ***argv)
 
 
 
-static int write_to_table(char *filename, MYSQL *mysql)
+static int delete_from_table(char *filename, MYSQL *mysql)
+{
+  char tablename[FN_REFLEN], sql_statement[FN_REFLEN*16+256];
+  DBUG_ENTER("delete_from_table");
+
+  fn_format(tablename, filename, "", "", 1 | 2); /* removes path & ext. */
+  if (verbose)
+    fprintf(stdout, "Deleting the old data from table %s\n", tablename);
+#ifdef HAVE_SNPRINTF
+  snprintf(sql_statement, FN_REFLEN*16+256, "DELETE FROM %s", tablename);
+#else
+  sprintf(sql_statement, "DELETE FROM %s", tablename);
+#endif
+  if (mysql_query(mysql, sql_statement))
+  {
+    db_error_with_table(mysql, tablename);
+    DBUG_RETURN(1);
+  }
+  DBUG_RETURN(0);
+}
+
+
+/*
+  LOAD DATA LOCAL of a part of a file: the client library reads the data
+  through these functions instead of the default ones, see
+  mysql_set_local_infile_handler().
+*/
+
+static int part_infile_init(void **ptr,
+                            const char *filename __attribute__((unused)),
+                            void *userdata)
+{
+  FILE_PART *part= (FILE_PART*) userdata;
+  PART_INFILE *data;
+
+  if (!(*ptr= data= (PART_INFILE*) my_malloc(sizeof(PART_INFILE), MYF(0))))
+    return 1;
+  data->error_num= 0;
+  data->left= part->end - part->start;
+  if ((data->file= my_open(part->file_name, O_RDONLY | O_SHARE,
+                           MYF(0))) < 0 ||
+      my_seek(data->file, part->start, MY_SEEK_SET,
+              MYF(0)) == MY_FILEPOS_ERROR)
+  {
+    data->error_num= my_errno;
+    my_snprintf(data->error_msg, sizeof(data->error_msg) - 1,
+                EE(EE_FILENOTFOUND), part->file_name, data->error_num);
+    return 1;
+  }
+  return 0;
+}
+
+
+static int part_infile_read(void *ptr, char *buf, uint buf_len)
+{
+  PART_INFILE *data= (PART_INFILE*) ptr;
+  size_t count;
+
+  if (!data->left)
+    return 0;
+  count= (size_t) min(data->left, buf_len);
+  if (my_read(data->file, (uchar*) buf, count, MYF(MY_NABP)))
+  {
+    data->error_num= EE_READ;
+    my_snprintf(data->error_msg, sizeof(data->error_msg) - 1,
+                EE(EE_READ), "", my_errno);
+    return -1;
+  }
+  data->left-= count;
+  return (int) count;
+}
+
+
+static void part_infile_end(void *ptr)
+{
+  PART_INFILE *data= (PART_INFILE*) ptr;
+  if (data)
+  {
+    if (data->file >= 0)
+      my_close(data->file, MYF(0));
+    my_free(data);
+  }
+}
+
+
+static int part_infile_error(void *ptr, char *error_msg, uint error_msg_len)
+{
+  PART_INFILE *data= (PART_INFILE*) ptr;
+  if (data)
+  {
+    strmake(error_msg, data->error_msg, error_msg_len);
+    return data->error_num;
+  }
+  strmake(error_msg, ER(CR_OUT_OF_MEMORY), error_msg_len);
+  return CR_OUT_OF_MEMORY;
+}
+
+
+static int write_to_table(FILE_PART *part, MYSQL *mysql)
 {
   char tablename[FN_REFLEN], hard_path[FN_REFLEN],
        escaped_name[FN_REFLEN * 2 + 1],
        sql_statement[FN_REFLEN*16+256], *end, *pos;
+  char *filename= part->file_name;
+  ulonglong start_time;
   DBUG_ENTER("write_to_table");
   DBUG_PRINT("enter",("filename: %s",filename));
 
@@ -318,25 +471,16 @@ static int write_to_table(char *filename, MYSQL *mysql)
   else
     my_load_path(hard_path, filename, NULL); /* filename includes the path */
 
-  if (opt_delete)
-  {
-    if (verbose)
-      fprintf(stdout, "Deleting the old data from table %s\n", tablename);
-#ifdef HAVE_SNPRINTF
-    snprintf(sql_statement, FN_REFLEN*16+256, "DELETE FROM %s", tablename);
-#else
-    sprintf(sql_statement, "DELETE FROM %s", tablename);
-#endif
-    if (mysql_query(mysql, sql_statement))
-    {
-      db_error_with_table(mysql, tablename);
-      DBUG_RETURN(1);
-    }
-  }
+  /* The rows of a split file are deleted before its parts are loaded */
+  if (opt_delete && part->parts == 1 && delete_from_table(filename, mysql))
+    DBUG_RETURN(1);
   to_unix_path(hard_path);
   if (verbose)
   {
-    if (opt_local_file)
+    if (part->parts > 1)
+      fprintf(stdout, "Loading part %u of %u of LOCAL file: %s into %s\n",
+              part->number, part->parts, hard_path, tablename);
+    else if (opt_local_file)
       fprintf(stdout, "Loading data from LOCAL file: %s into %s\n",
 	      hard_path, tablename);
     else
@@ -371,13 +515,17 @@ static int write_to_table(char *filename, MYSQL *mysql)
 		       " OPTIONALLY ENCLOSED BY");
   end= add_load_option(end, escaped, " ESCAPED BY");
   end= add_load_option(end, lines_terminated, " LINES TERMINATED BY");
-  if (opt_ignore_lines >= 0)
+  if (opt_ignore_lines >= 0 && part->number == 1)
     end= strmov(longlong10_to_str(opt_ignore_lines, 
 				  strmov(end, " IGNORE "),10), " LINES");
   if (opt_columns)
     end= strmov(strmov(strmov(end, " ("), opt_columns), ")");
   *end= '\0';
 
+  if (part->parts > 1)
+    mysql_set_local_infile_handler(mysql, part_infile_init, part_infile_read,
+                                   part_infile_end, part_infile_error, part);
+  start_time= microsecond_interval_timer();
   if (mysql_query(mysql, sql_statement))
   {
     db_error_with_table(mysql, tablename);
@@ -385,7 +533,17 @@ static int write_to_table(char *filename, MYSQL *mysql)
   }
   if (!silent)
   {
-    if (mysql_info(mysql)) /* If NULL-pointer, print nothing */
+    if (part->parts > 1)
+    {
+      /* Throughput of the thread loading the part */
+      double secs= (microsecond_interval_timer() - start_time) / 1000000.0;
+      double bytes= (double) (part->end - part->start);
+      fprintf(stdout, "%s.%s: part %u of %u: %s  Bytes: %.0f  "
+              "Seconds: %.3f  MB/s: %.2f\n", current_db, tablename,
+              part->number, part->parts, mysql_info(mysql), bytes, secs,
+              secs > 0 ? bytes / secs / (1024 * 1024) : 0.0);
+    }
+    else if (mysql_info(mysql)) /* If NULL-pointer, print nothing */
     {
       fprintf(stdout, "%s.%s: %s\n", current_db, tablename,
 	      mysql_info(mysql));
@@ -488,6 +646,16 @@ static void safe_exit(int error, MYSQL *mysql)
   if (mysql)
     mysql_close(mysql);
 
+  if (counter)
+  {
+    /*
+      An error in a thread while others still load: my_end() would wait
+      for the threads, so exit without freeing anything.
+    */
+    fflush(stdout);
+    _exit(error);
+  }
+
 #ifdef HAVE_SMEM
   my_free(shared_memory_base_name);
 #endif
@@ -565,13 +733,152 @@ static char *field_escape(char *to,const char *from,uint length)
   return to;
 }
 
+
+static int hex_value(char c)
+{
+  return c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+}
+
+
+/*
+  Get the bytes of a --fields-... or --lines-... option the way the
+  server reads the string add_load_option() makes of it.
+*/
+
+static uint unescape_option(char *to, const char *from)
+{
+  char *start= to, *to_end= to + 255;
+
+  if (from[0] == '0' && (from[1] == 'x' || from[1] == 'X'))
+  {
+    for (from+= 2; from[0] && from[1] && to < to_end; from+= 2)
+      *to++= (char) ((hex_value(from[0]) << 4) + hex_value(from[1]));
+    return (uint) (to - start);
+  }
+  for (; *from && to < to_end; from++)
+  {
+    if (*from != '\\' || !from[1])
+    {
+      *to++= *from;
+      continue;
+    }
+    switch (*++from) {
+    case 'n': *to++= '\n'; break;
+    case 't': *to++= '\t'; break;
+    case 'r': *to++= '\r'; break;
+    case 'b': *to++= '\b'; break;
+    case '0': *to++= 0; break;
+    case 'Z': *to++= '\032'; break;
+    default:  *to++= *from; break;
+    }
+  }
+  return (uint) (to - start);
+}
+
+
+/* Is the byte at pos preceded by an odd number of escape characters? */
+
+static my_bool is_escaped(File file, my_off_t pos)
+{
+  uint count= 0;
+  uchar c;
+
+  if (escape_char < 0)
+    return 0;
+  while (pos > 0 && !my_pread(file, &c, 1, --pos, MYF(MY_NABP)) &&
+         c == (uchar) escape_char)
+    count++;
+  return count & 1;
+}
+
+
+/*
+  Find the end of the first line which ends at or after a position of a
+  file. Returns the size of the file if no line ends there.
+*/
+
+static my_off_t find_line_end(File file, my_off_t pos, my_off_t size)
+{
+  uchar buff[IO_SIZE * 4];
+  size_t length, i;
+
+  while (pos + line_term_length <= size)
+  {
+    length= (size_t) min(sizeof(buff), size - pos);
+    if (my_pread(file, buff, length, pos, MYF(MY_NABP)))
+      break;
+    for (i= 0; i + line_term_length <= length; i++)
+    {
+      if (!memcmp(buff + i, line_term, line_term_length) &&
+          !is_escaped(file, pos + i))
+        return pos + i + line_term_length;
+    }
+    /* A line end may start at the end of the buffer */
+    pos+= i;
+  }
+  return size;
+}
+
+
+/*
+  Split a file for --split-size.
+
+  Stores the offsets where the parts of the file start, followed by
+  the size of the file, in bounds. A file which isn't split is one part
+  from 0 to 0.
+*/
+
+static void split_file(char *file_name, DYNAMIC_ARRAY *bounds)
+{
+  MY_STAT stat_info;
+  File file;
+  my_off_t pos= 0, size;
+
+  if (!opt_split_size || enclosed || opt_enclosed ||
+      !my_stat(file_name, &stat_info, MYF(0)) ||
+      (size= (my_off_t) stat_info.st_size) <= opt_split_size ||
+      (file= my_open(file_name, O_RDONLY | O_SHARE, MYF(MY_WME))) < 0)
+  {
+    insert_dynamic(bounds, (uchar*) &pos);
+    insert_dynamic(bounds, (uchar*) &pos);
+    return;
+  }
+  do
+  {
+    insert_dynamic(bounds, (uchar*) &pos);
+  } while (size - pos > opt_split_size &&
+           (pos= find_line_end(file, pos + opt_split_size, size)) < size);
+  insert_dynamic(bounds, (uchar*) &size);
+  my_close(file, MYF(0));
+}
+
+
 int exitcode= 0;
 
-#ifdef HAVE_LIBPTHREAD
+/*
+  Set up a session loading files.
+
+  With --bulk-load, duplicate keys are only checked for --replace and
+  --ignore, which depend on them.
+*/
+
+static int init_load_session(MYSQL *mysql)
+{
+  if (mysql_query(mysql, "/*!40101 set @@character_set_database=binary */;"))
+    return 1;
+  if (opt_bulk_load &&
+      mysql_query(mysql, replace || ignore ?
+                  "/*!40014 SET FOREIGN_KEY_CHECKS=0 */" :
+                  "/*!40014 SET UNIQUE_CHECKS=0, FOREIGN_KEY_CHECKS=0 */"))
+    return 1;
+  return 0;
+}
+
+
 pthread_handler_t worker_thread(void *arg)
 {
   int error;
-  char *raw_table_name= (char *)arg;
+  FILE_PART *part= (FILE_PART*) arg;
   MYSQL *mysql= 0;
 
   if (mysql_thread_init())
@@ -582,7 +889,7 @@ pthread_handler_t worker_thread(void *arg)
     goto error;
   }
 
-  if (mysql_query(mysql, "/*!40101 set @@character_set_database=binary */;"))
+  if (init_load_session(mysql))
   {
     db_error(mysql); /* We shall countinue here, if --force was given */
     goto error;
@@ -591,13 +898,14 @@ pthread_handler_t worker_thread(void *arg)
   /*
     We are not currently catching the error here.
   */
-  if((error= write_to_table(raw_table_name, mysql)))
+  if((error= write_to_table(part, mysql)))
     if (exitcode == 0)
       exitcode= error;
 
 error:
   if (mysql)
     db_disconnect(current_host, mysql);
+  my_free(part);
 
   pthread_mutex_lock(&counter_mutex);
   counter--;
@@ -607,7 +915,6 @@ error:
 
   return 0;
 }
-#endif
 
 
 int main(int argc, char **argv)
@@ -627,7 +934,6 @@ int main(int argc, char **argv)
   }
   sf_leaking_memory=0; /* from now on we cleanup properly */
 
-#ifdef HAVE_LIBPTHREAD
   if (opt_use_threads && !lock_tables)
   {
     pthread_t mainthread;            /* Thread descriptor */
@@ -639,30 +945,66 @@ int main(int argc, char **argv)
     pthread_mutex_init(&counter_mutex, NULL);
     pthread_cond_init(&count_threshhold, NULL);
 
+    DYNAMIC_ARRAY bounds;
+    my_init_dynamic_array(&bounds, sizeof(my_off_t), 16, 16);
+
     for (counter= 0; *argv != NULL; argv++) /* Loop through tables */
     {
-      pthread_mutex_lock(&counter_mutex);
-      while (counter == opt_use_threads)
+      uint i, parts;
+      my_off_t *offsets;
+
+      reset_dynamic(&bounds);
+      split_file(*argv, &bounds);
+      offsets= (my_off_t*) bounds.buffer;
+      parts= bounds.elements - 1;
+      if (parts > 1 && opt_delete)
       {
-        struct timespec abstime;
-
-        set_timespec(abstime, 3);
-        pthread_cond_timedwait(&count_threshhold, &counter_mutex, &abstime);
+        MYSQL *mysql;
+        if ((mysql= db_connect(current_host, current_db, current_user,
+                               opt_password)))
+        {
+          if (delete_from_table(*argv, mysql) && exitcode == 0)
+            exitcode= 1;
+          db_disconnect(current_host, mysql);
+        }
       }
-      /* Before exiting the lock we set ourselves up for the next thread */
-      counter++;
-      pthread_mutex_unlock(&counter_mutex);
-      /* now create the thread */
-      if (pthread_create(&mainthread, &attr, worker_thread, 
-                         (void *)*argv) != 0)
+
+      for (i= 0; i < parts; i++)
       {
+        FILE_PART *part;
+        if (!(part= (FILE_PART*) my_malloc(sizeof(FILE_PART), MYF(MY_WME))))
+          break;
+        part->file_name= *argv;
+        part->start= offsets[i];
+        part->end= offsets[i + 1];
+        part->number= i + 1;
+        part->parts= parts;
+
         pthread_mutex_lock(&counter_mutex);
-        counter--;
+        while (counter == opt_use_threads)
+        {
+          struct timespec abstime;
+
+          set_timespec(abstime, 3);
+          pthread_cond_timedwait(&count_threshhold, &counter_mutex, &abstime);
+        }
+        /* Before exiting the lock we set ourselves up for the next thread */
+        counter++;
         pthread_mutex_unlock(&counter_mutex);
-        fprintf(stderr,"%s: Could not create thread\n",
-                my_progname);
+        /* now create the thread */
+        if (pthread_create(&mainthread, &attr, worker_thread, 
+                           (void *)part) != 0)
+        {
+          pthread_mutex_lock(&counter_mutex);
+          counter--;
+          pthread_mutex_unlock(&counter_mutex);
+          my_free(part);
+          fprintf(stderr,"%s: Could not create thread\n",
+                  my_progname);
+        }
       }
     }
+    delete_dynamic(&bounds);
 
     /*
       We loop until we know that all children have cleaned up.
@@ -681,7 +1023,6 @@ int main(int argc, char **argv)
     pthread_attr_destroy(&attr);
   }
   else
-#endif
   {
     MYSQL *mysql= 0;
     if (!(mysql= db_connect(current_host,current_db,current_user,opt_password)))
@@ -690,7 +1031,7 @@ int main(int argc, char **argv)
       return(1); /* purecov: deadcode */
     }
 
-    if (mysql_query(mysql, "/*!40101 set @@character_set_database=binary */;"))
+    if (init_load_session(mysql))
     {
       db_error(mysql); /* We shall countinue here, if --force was given */
       return(1);
@@ -699,9 +1040,12 @@ int main(int argc, char **argv)
     if (lock_tables)
       lock_table(mysql, argc, argv);
     for (; *argv != NULL; argv++)
-      if ((error= write_to_table(*argv, mysql)))
+    {
+      FILE_PART part= { *argv, 0, 0, 1, 1 };
+      if ((error= write_to_table(&part, mysql)))
         if (exitcode == 0)
           exitcode= error;
+    }
     db_disconnect(current_host, mysql);
   }
   safe_exit(0, 0);
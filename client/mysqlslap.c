@@ -56,6 +56,17 @@
               --iterations=5 --query=query.sql --create=create.sql \
               --delimiter=";"
 
+  Run a mix of 80% point reads and 20% read-modify-write transactions on
+  skewed keys, starting 2000 of them per second over 32 clients, and print
+  the throughput and latency percentiles every 10 seconds:
+
+    mysqlslap --concurrency=32 --number-of-queries=600000 --rate=2000 \
+              --key-range=100000 --key-distribution=zipfian \
+              --report-interval=10 --delimiter="|" \
+              --mix="8:SELECT c FROM t1 WHERE id={key}|2:BEGIN; \
+SELECT c FROM t1 WHERE id={key} FOR UPDATE; \
+UPDATE t1 SET c=c+1 WHERE id={key}; COMMIT"
+
 TODO:
   Add language for better tests
   String length for files and those put on the command line are not
@@ -79,6 +90,21 @@ TODO:
 #define CREATE_TABLE_TYPE 4
 #define SELECT_TYPE_REQUIRES_PREFIX 5
 #define DELETE_TYPE_REQUIRES_PREFIX 6
+#define KEY_TYPE_REQUIRES_PLACEHOLDER 7
+
+/* Replaced by a key from --key-distribution in queries */
+#define KEY_PLACEHOLDER "{key}"
+#define KEY_PLACEHOLDER_LENGTH (sizeof(KEY_PLACEHOLDER)-1)
+
+/*
+  Query latencies are counted in microseconds, exactly below 64 and in
+  32 buckets per power of two above that (about 3% precision).
+*/
+#define LATENCY_EXACT_BUCKETS 64
+#define LATENCY_SUB_BUCKETS 32
+#define LATENCY_MAX_BIT 41
+#define LATENCY_BUCKETS (LATENCY_EXACT_BUCKETS + \
+                         (LATENCY_MAX_BIT - 5) * LATENCY_SUB_BUCKETS)
 
 #include "client_priv.h"
 #include <mysqld_error.h>
@@ -91,6 +117,7 @@ TODO:
 #include <sys/wait.h>
 #endif
 #include <ctype.h>
+#include <math.h>
 #include <welcome_copyright_notice.h>   /* ORACLE_WELCOME_COPYRIGHT_NOTICE */
 
 #ifdef __WIN__
@@ -118,6 +145,7 @@ unsigned long long primary_keys_number_of;
 
 static char *host= NULL, *opt_password= NULL, *user= NULL,
             *user_supplied_query= NULL,
+            *user_supplied_mix= NULL,
             *user_supplied_pre_statements= NULL,
             *user_supplied_post_statements= NULL,
             *default_engine= NULL,
@@ -147,6 +175,7 @@ static unsigned long connect_flags= CLIENT_MULTI_RESULTS |
 static int verbose, delimiter_length;
 static uint commit_rate;
 static uint detach_rate;
+static uint think_time, opt_rate, report_interval;
 const char *num_int_cols_opt;
 const char *num_char_cols_opt;
 
@@ -169,6 +198,25 @@ const char *concurrency_str= NULL;
 static char *create_string;
 uint *concurrency;
 
+/* --mix: statements of query_statements are picked by weight */
+static ulonglong mix_total_weight= 0;
+
+enum key_distribution_type { KEY_UNIFORM= 1, KEY_ZIPFIAN, KEY_HOTSPOT };
+static const char *key_distribution_names[]=
+{ "uniform", "zipfian", "hotspot", NullS };
+static TYPELIB key_distribution_typelib=
+{ array_elements(key_distribution_names) - 1, "",
+  key_distribution_names, NULL };
+
+static const char *key_distribution_str= NULL;
+static uint key_distribution= KEY_UNIFORM;
+static ulonglong key_range;
+/* zipfian[:theta], as in "Quickly Generating Billion-Record Synthetic
+   Databases" by Gray et al. */
+static double zipf_theta= 0.99, zipf_alpha, zipf_eta, zipf_zetan, zipf_half;
+/* hotspot[:percent of queries:percent of keys] */
+static double hotspot_queries= 0.8, hotspot_keys= 0.2;
+
 const char *default_dbug_option="d:t:o,/tmp/mysqlslap.trace";
 const char *opt_csv_str;
 File csv_file;
@@ -187,6 +235,7 @@ struct statement {
   char *string;
   size_t length;
   unsigned char type;
+  ulong weight;
   char *option;
   size_t option_length;
   statement *next;
@@ -210,11 +259,24 @@ struct stats {
   unsigned long long rows;
 };
 
+typedef struct latency_histogram latency_histogram;
+
+struct latency_histogram {
+  ulonglong count[LATENCY_BUCKETS];
+  ulonglong total;
+  ulonglong max;                        /* Microseconds */
+};
+
 typedef struct thread_context thread_context;
 
 struct thread_context {
   statement *stmt;
   ulonglong limit;
+  uint number;                          /* Of the client, from 0 */
+  ulonglong rate_interval;              /* Microseconds, for --rate */
+  struct my_rnd_struct rand;
+  pthread_mutex_t latency_lock;         /* Read by --report-interval */
+  latency_histogram latency;
 };
 
 typedef struct conclusions conclusions;
@@ -226,6 +288,7 @@ struct conclusions {
   long int min_timing;
   uint users;
   unsigned long long avg_rows;
+  latency_histogram *latency;           /* Of all iterations */
   /* The following are not used yet */
   unsigned long long max_rows;
   unsigned long long min_rows;
@@ -255,7 +318,10 @@ static int drop_primary_key_list(void);
 static int create_schema(MYSQL *mysql, const char *db, statement *stmt, 
               option_string *engine_stmt);
 static int run_scheduler(stats *sptr, statement *stmts, uint concur, 
-                         ulonglong limit);
+                         ulonglong limit, latency_histogram *latency);
+static void init_key_distribution(void);
+static ulonglong get_random_key(struct my_rnd_struct *rand);
+static int parse_mix_weights(statement *stmt);
 pthread_handler_t run_task(void *p);
 void statement_cleanup(statement *stmt);
 void option_cleanup(option_string *stmt);
@@ -446,6 +512,8 @@ void concurrency_loop(MYSQL *mysql, uint current, option_string *eptr)
                                 MYF(MY_ZEROFILL|MY_FAE|MY_WME));
 
   bzero(&conclusion, sizeof(conclusions));
+  conclusion.latency= (latency_histogram *)
+    my_malloc(sizeof(latency_histogram), MYF(MY_ZEROFILL|MY_FAE|MY_WME));
 
   if (auto_actual_queries)
     client_limit= auto_actual_queries;
@@ -454,6 +522,10 @@ void concurrency_loop(MYSQL *mysql, uint current, option_string *eptr)
   else
     client_limit= actual_queries;
 
+  /* A mix is never run "once", each client picks at least one statement */
+  if (mix_total_weight && !client_limit)
+    client_limit= 1;
+
   for (x= 0, sptr= head_sptr; x < iterations; x++, sptr++)
   {
     /*
@@ -501,7 +573,8 @@ void concurrency_loop(MYSQL *mysql, uint current, option_string *eptr)
     if (pre_statements)
       run_statements(mysql, pre_statements);
 
-    run_scheduler(sptr, query_statements, current, client_limit); 
+    run_scheduler(sptr, query_statements, current, client_limit,
+                  conclusion.latency);
     
     if (post_statements)
       run_statements(mysql, post_statements);
@@ -525,6 +598,7 @@ void concurrency_loop(MYSQL *mysql, uint current, option_string *eptr)
   if (opt_csv_str)
     print_conclusions_csv(&conclusion);
 
+  my_free(conclusion.latency);
   my_free(head_sptr);
 
 }
@@ -631,6 +705,25 @@ static struct my_option my_long_options[] =
     REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
   {"iterations", 'i', "Number of times to run the tests.", &iterations,
     &iterations, 0, GET_UINT, REQUIRED_ARG, 1, 0, 0, 0, 0, 0},
+  {"key-distribution", OPT_SLAP_KEY_DISTRIBUTION,
+   "Distribution of the keys replacing " KEY_PLACEHOLDER " in queries: "
+   "uniform, zipfian[:theta] (default theta 0.99) or "
+   "hotspot[:percent of queries:percent of keys] (default 80:20, the "
+   "hot keys are the lowest ones). All placeholders of a statement get the "
+   "same key.",
+   &key_distribution_str, &key_distribution_str, 0, GET_STR, REQUIRED_ARG,
+    0, 0, 0, 0, 0, 0},
+  {"key-range", OPT_SLAP_KEY_RANGE,
+   "Keys replacing " KEY_PLACEHOLDER " in queries are between 1 and this "
+   "number.", &key_range, &key_range, 0, GET_ULL, REQUIRED_ARG,
+    1000, 1, ~(ulonglong) 0, 0, 0, 0},
+  {"mix", OPT_SLAP_MIX,
+   "File or string of statements, separated by --delimiter, that clients "
+   "pick at random instead of running them in order like --query does. "
+   "A statement may start with `weight:' (default 1) to be picked that "
+   "much more often, and may hold several queries separated by `;'.",
+   &user_supplied_mix, &user_supplied_mix, 0, GET_STR, REQUIRED_ARG,
+    0, 0, 0, 0, 0, 0},
   {"no-drop", OPT_SLAP_NO_DROP, "Do not drop the schema after the test.",
    &opt_no_drop, &opt_no_drop, 0, GET_BOOL, NO_ARG, 0, 0, 0, 0, 0, 0},
   {"number-char-cols", 'x', 
@@ -685,6 +778,17 @@ static struct my_option my_long_options[] =
   {"query", 'q', "Query to run or file containing query to run.",
     &user_supplied_query, &user_supplied_query,
     0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
+  {"rate", OPT_SLAP_RATE,
+   "Start this many queries per second over all clients, whether or not "
+   "earlier ones have completed. Latency then includes the time a query "
+   "waited for its client. 0 means each client starts its next query when "
+   "the previous one is done.",
+   &opt_rate, &opt_rate, 0, GET_UINT, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
+  {"report-interval", OPT_SLAP_REPORT_INTERVAL,
+   "Print the throughput and latency of the queries completed in every "
+   "interval of this many seconds while the test runs.",
+   &report_interval, &report_interval, 0, GET_UINT, REQUIRED_ARG,
+    0, 0, 0, 0, 0, 0},
 #ifdef HAVE_SMEM
   {"shared-memory-base-name", OPT_SHARED_MEMORY_BASE_NAME,
     "Base name of shared memory.", &shared_memory_base_name,
@@ -698,6 +802,10 @@ static struct my_option my_long_options[] =
     &opt_mysql_unix_port, &opt_mysql_unix_port, 0, GET_STR,
     REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
 #include <sslopt-longopts.h>
+  {"think-time", OPT_SLAP_THINK_TIME,
+   "Average number of milliseconds a client waits between queries. The "
+   "actual waits are exponentially distributed.",
+   &think_time, &think_time, 0, GET_UINT, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
 #ifndef DONT_ALLOW_USER_CHANGE
   {"user", 'u', "User for login if not current user.", &user,
     &user, 0, GET_STR, REQUIRED_ARG, 0, 0, 0, 0, 0, 0},
@@ -1184,6 +1292,64 @@ get_options(int *argc,char ***argv)
   if (!opt_no_drop && (create_string || auto_generate_sql))
     opt_preserve= FALSE;
 
+  if (user_supplied_mix)
+  {
+    if (user_supplied_query || auto_generate_sql)
+    {
+      fprintf(stderr,
+              "%s: Either --mix, --query or --auto-generate-sql can be used!\n",
+              my_progname);
+      exit(1);
+    }
+    /* Read and split like --query, the weights are parsed below */
+    user_supplied_query= user_supplied_mix;
+  }
+
+  if (opt_rate && think_time)
+  {
+      fprintf(stderr,
+              "%s: Either --rate or --think-time can be used!\n",
+              my_progname);
+      exit(1);
+  }
+
+  if (key_distribution_str)
+  {
+    option_string *str;
+    char *end;
+    parse_option(key_distribution_str, &str, ',');
+    key_distribution= find_type_or_exit(str->string, &key_distribution_typelib,
+                                        "key-distribution");
+    if (str->option)
+    {
+      if (key_distribution == KEY_ZIPFIAN)
+      {
+        zipf_theta= strtod(str->option, &end);
+        if (*end || zipf_theta <= 0.0 || zipf_theta >= 1.0)
+          key_distribution= 0;
+      }
+      else if (key_distribution == KEY_HOTSPOT)
+      {
+        hotspot_queries= strtod(str->option, &end) / 100;
+        if (*end == ':')
+          hotspot_keys= strtod(end + 1, &end) / 100;
+        if (*end || hotspot_queries < 0.0 || hotspot_queries > 1.0 ||
+            hotspot_keys <= 0.0 || hotspot_keys > 1.0)
+          key_distribution= 0;
+      }
+      else
+        key_distribution= 0;
+    }
+    option_cleanup(str);
+    if (!key_distribution)
+    {
+      fprintf(stderr, "%s: Invalid --key-distribution: %s\n",
+              my_progname, key_distribution_str);
+      exit(1);
+    }
+  }
+  init_key_distribution();
+
   if (auto_generate_sql && (create_string || user_supplied_query))
   {
       fprintf(stderr,
@@ -1376,6 +1542,8 @@ get_options(int *argc,char ***argv)
   }
   else
   {
+    statement *ptr_statement;
+
     if (create_string && my_stat(create_string, &sbuf, MYF(0)))
     {
       File data_file;
@@ -1432,6 +1600,22 @@ get_options(int *argc,char ***argv)
         actual_queries= parse_delimiter(user_supplied_query, &query_statements,
                                         delimiter[0]);
     }
+
+    if (user_supplied_mix && query_statements &&
+        parse_mix_weights(query_statements))
+    {
+      fprintf(stderr, "%s: --mix has no statement with a weight above 0\n",
+              my_progname);
+      exit(1);
+    }
+
+    for (ptr_statement= query_statements; ptr_statement;
+         ptr_statement= ptr_statement->next)
+    {
+      if (ptr_statement->length &&
+          strstr(ptr_statement->string, KEY_PLACEHOLDER))
+        ptr_statement->type= KEY_TYPE_REQUIRES_PLACEHOLDER;
+    }
   }
 
   if (user_supplied_pre_statements && my_stat(user_supplied_pre_statements, &sbuf, MYF(0)))
@@ -1741,18 +1925,301 @@ run_statements(MYSQL *mysql, statement *stmt)
   DBUG_RETURN(0);
 }
 
+/*
+  init_key_distribution()
+
+  Precomputes the constants of the zipfian distribution, which takes a
+  pass over the whole key range.
+*/
+static void
+init_key_distribution(void)
+{
+  ulonglong x;
+
+  if (key_distribution != KEY_ZIPFIAN || key_range < 2)
+    return;
+
+  zipf_zetan= 0.0;
+  for (x= 1; x <= key_range; x++)
+    zipf_zetan+= 1.0 / pow((double) x, zipf_theta);
+  zipf_alpha= 1.0 / (1.0 - zipf_theta);
+  zipf_half= pow(0.5, zipf_theta);
+  if (key_range > 2)
+    zipf_eta= (1.0 - pow(2.0 / key_range, 1.0 - zipf_theta)) /
+              (1.0 - (1.0 + zipf_half) / zipf_zetan);
+}
+
+
+/* A key between 1 and key_range; 1 is the most frequent one if skewed */
+static ulonglong
+get_random_key(struct my_rnd_struct *rand)
+{
+  double r= my_rnd(rand);
+  ulonglong key;
+
+  switch (key_distribution) {
+  case KEY_ZIPFIAN:
+  {
+    double rz= r * zipf_zetan;
+    if (key_range < 2 || rz < 1.0)
+      return 1;
+    if (rz < 1.0 + zipf_half)
+      return 2;
+    key= 1 + (ulonglong) (key_range *
+                          pow(zipf_eta * r - zipf_eta + 1.0, zipf_alpha));
+    break;
+  }
+  case KEY_HOTSPOT:
+  {
+    ulonglong hot_keys= (ulonglong) (key_range * hotspot_keys);
+    set_if_bigger(hot_keys, 1);
+    if (r < hotspot_queries || hot_keys >= key_range)
+      key= 1 + (ulonglong) (my_rnd(rand) * hot_keys);
+    else
+      key= hot_keys + 1 + (ulonglong) (my_rnd(rand) * (key_range - hot_keys));
+    break;
+  }
+  default:
+    key= 1 + (ulonglong) (r * key_range);
+  }
+  set_if_smaller(key, key_range);
+  return key;
+}
+
+
+/*
+  build_key_query()
+
+  Copies a statement to buffer with every KEY_PLACEHOLDER replaced by key.
+  Returns the length of the query, or -1 if it does not fit.
+*/
+static int
+build_key_query(char *buffer, statement *stmt, ulonglong key)
+{
+  char key_buff[22];
+  size_t key_length, length;
+  char *to= buffer, *end= buffer + HUGE_STRING_LENGTH;
+  const char *from= stmt->string, *pos;
+
+  key_length= (size_t) (longlong10_to_str((longlong) key, key_buff, 10) -
+                        key_buff);
+  while ((pos= strstr(from, KEY_PLACEHOLDER)))
+  {
+    length= (size_t) (pos - from);
+    if (to + length + key_length >= end)
+      return -1;
+    memcpy(to, from, length);
+    memcpy(to + length, key_buff, key_length);
+    to+= length + key_length;
+    from= pos + KEY_PLACEHOLDER_LENGTH;
+  }
+  length= strlen(from);
+  if (to + length >= end)
+    return -1;
+  memcpy(to, from, length);
+  return (int) (to + length - buffer);
+}
+
+
+/*
+  parse_mix_weights()
+
+  Strips the `weight:' prefixes of --mix statements. Returns 1 if no
+  statement can ever be picked.
+*/
 static int
-run_scheduler(stats *sptr, statement *stmts, uint concur, ulonglong limit)
+parse_mix_weights(statement *stmt)
+{
+  statement *ptr;
+
+  for (ptr= stmt; ptr; ptr= ptr->next)
+  {
+    char *end;
+
+    if (!ptr->length)
+      continue;
+    ptr->weight= 1;
+    if (isdigit(ptr->string[0]))
+    {
+      ulong weight= strtoul(ptr->string, &end, 10);
+      if (*end == ':')
+      {
+        ptr->weight= weight;
+        end++;
+        ptr->length-= (size_t) (end - ptr->string);
+        memmove(ptr->string, end, ptr->length + 1);
+      }
+    }
+    mix_total_weight+= ptr->weight;
+  }
+  return mix_total_weight == 0;
+}
+
+
+/* A statement of --mix, picked by weight */
+static statement *
+pick_statement(thread_context *con)
+{
+  statement *ptr;
+  ulonglong pick= (ulonglong) (my_rnd(&con->rand) * mix_total_weight);
+
+  for (ptr= con->stmt; ptr->next && pick >= ptr->weight; ptr= ptr->next)
+    pick-= ptr->weight;
+  return ptr;
+}
+
+
+static uint
+latency_bucket(ulonglong latency)
+{
+  uint bit;
+
+  if (latency < LATENCY_EXACT_BUCKETS)
+    return (uint) latency;
+  for (bit= 6; bit < LATENCY_MAX_BIT && (latency >> (bit + 1)); bit++)
+  {}
+  if (latency >> (bit + 1))
+    return LATENCY_BUCKETS - 1;
+  return LATENCY_EXACT_BUCKETS + (bit - 6) * LATENCY_SUB_BUCKETS +
+         (uint) ((latency >> (bit - 5)) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+
+/* The highest latency counted in a bucket */
+static ulonglong
+latency_bucket_limit(uint bucket)
+{
+  uint bit, sub;
+
+  if (bucket < LATENCY_EXACT_BUCKETS)
+    return bucket;
+  bit= (bucket - LATENCY_EXACT_BUCKETS) / LATENCY_SUB_BUCKETS + 6;
+  sub= (bucket - LATENCY_EXACT_BUCKETS) % LATENCY_SUB_BUCKETS;
+  return ((ulonglong) (LATENCY_SUB_BUCKETS + sub + 1) << (bit - 5)) - 1;
+}
+
+
+static void
+add_latency(latency_histogram *to, latency_histogram *from)
+{
+  uint x;
+
+  for (x= 0; x < LATENCY_BUCKETS; x++)
+    to->count[x]+= from->count[x];
+  to->total+= from->total;
+  set_if_bigger(to->max, from->max);
+}
+
+
+/*
+  latency_percentile()
+
+  Returns the latency that percent of the queries did not exceed, rounded
+  up to the limit of its bucket.
+*/
+static ulonglong
+latency_percentile(latency_histogram *latency, double percent)
+{
+  ulonglong seen= 0, rank;
+  uint x;
+
+  if (!latency->total)
+    return 0;
+  rank= (ulonglong) ceil(latency->total * percent / 100.0);
+  set_if_bigger(rank, 1);
+  for (x= 0; x < LATENCY_BUCKETS; x++)
+  {
+    if ((seen+= latency->count[x]) >= rank)
+    {
+      ulonglong limit= latency_bucket_limit(x);
+      if (latency->max && limit > latency->max)
+        return latency->max;
+      return limit;
+    }
+  }
+  return latency->max;
+}
+
+
+/*
+  report_latency()
+
+  Prints the queries completed since the previous report, as the
+  difference of the client histograms with last.
+*/
+static void
+report_latency(thread_context *con, uint concur, latency_histogram *last,
+               latency_histogram *now, ulonglong seconds)
+{
+  ulonglong total, rate, p50, p95, p99, p999;
+  uint x;
+
+  bzero(now, sizeof(latency_histogram));
+  for (x= 0; x < concur; x++)
+  {
+    pthread_mutex_lock(&con[x].latency_lock);
+    add_latency(now, &con[x].latency);
+    pthread_mutex_unlock(&con[x].latency_lock);
+  }
+  for (x= 0; x < LATENCY_BUCKETS; x++)
+  {
+    ulonglong count= now->count[x];
+    now->count[x]-= last->count[x];
+    last->count[x]= count;
+  }
+  total= now->total;
+  now->total-= last->total;
+  last->total= total;
+  now->max= 0;
+
+  rate= now->total * 100 / report_interval;
+  p50= latency_percentile(now, 50);
+  p95= latency_percentile(now, 95);
+  p99= latency_percentile(now, 99);
+  p999= latency_percentile(now, 99.9);
+  printf("[%4llus] queries: %llu, queries per second: %llu.%02llu, "
+         "latency (ms) p50: %llu.%03llu, p95: %llu.%03llu, "
+         "p99: %llu.%03llu, p999: %llu.%03llu\n",
+         seconds, now->total, rate / 100, rate % 100,
+         p50 / 1000, p50 % 1000, p95 / 1000, p95 % 1000,
+         p99 / 1000, p99 % 1000, p999 / 1000, p999 % 1000);
+  fflush(stdout);
+}
+
+
+static int
+run_scheduler(stats *sptr, statement *stmts, uint concur, ulonglong limit,
+              latency_histogram *latency)
 {
   uint x;
   struct timeval start_time, end_time;
-  thread_context con;
+  thread_context *con;
+  latency_histogram *last_report= NULL, *report= NULL;
+  ulonglong start, next_report;
   pthread_t mainthread;            /* Thread descriptor */
   pthread_attr_t attr;          /* Thread attributes */
   DBUG_ENTER("run_scheduler");
 
-  con.stmt= stmts;
-  con.limit= limit;
+  con= (thread_context *)my_malloc(sizeof(thread_context) * concur,
+                                   MYF(MY_ZEROFILL|MY_FAE|MY_WME));
+  for (x= 0; x < concur; x++)
+  {
+    con[x].stmt= stmts;
+    con[x].limit= limit;
+    con[x].number= x;
+    if (opt_rate)
+      con[x].rate_interval= 1000000ULL * concur / opt_rate;
+    my_rnd_init(&con[x].rand, (ulong) time(NULL) + x * 7919UL,
+                (ulong) (x + 1) * 104729UL);
+    pthread_mutex_init(&con[x].latency_lock, NULL);
+  }
+  if (report_interval)
+  {
+    last_report= (latency_histogram *)
+      my_malloc(sizeof(latency_histogram), MYF(MY_ZEROFILL|MY_FAE|MY_WME));
+    report= (latency_histogram *)
+      my_malloc(sizeof(latency_histogram), MYF(MY_ZEROFILL|MY_FAE|MY_WME));
+  }
 
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr,
@@ -1768,7 +2235,7 @@ run_scheduler(stats *sptr, statement *stmts, uint concur, ulonglong limit)
   {
     /* now you create the thread */
     if (pthread_create(&mainthread, &attr, run_task, 
-                       (void *)&con) != 0)
+                       (void *)(con + x)) != 0)
     {
       fprintf(stderr,"%s: Could not create thread\n",
               my_progname);
@@ -1785,6 +2252,8 @@ run_scheduler(stats *sptr, statement *stmts, uint concur, ulonglong limit)
   pthread_cond_broadcast(&sleep_threshhold);
 
   gettimeofday(&start_time, NULL);
+  start= microsecond_interval_timer();
+  next_report= start + report_interval * 1000000ULL;
 
   /*
     We loop until we know that all children have cleaned up.
@@ -1794,13 +2263,36 @@ run_scheduler(stats *sptr, statement *stmts, uint concur, ulonglong limit)
   {
     struct timespec abstime;
 
-    set_timespec(abstime, 3);
+    if (report_interval)
+    {
+      ulonglong now= microsecond_interval_timer();
+      if (now >= next_report)
+      {
+        if (!opt_silent)
+          report_latency(con, concur, last_report, report,
+                         (next_report - start) / 1000000);
+        next_report+= report_interval * 1000000ULL;
+        continue;
+      }
+      set_timespec_nsec(abstime, (next_report - now) * 1000);
+    }
+    else
+      set_timespec(abstime, 3);
     pthread_cond_timedwait(&count_threshhold, &counter_mutex, &abstime);
   }
   pthread_mutex_unlock(&counter_mutex);
 
   gettimeofday(&end_time, NULL);
 
+  for (x= 0; x < concur; x++)
+  {
+    add_latency(latency, &con[x].latency);
+    pthread_mutex_destroy(&con[x].latency_lock);
+  }
+  my_free(con);
+  my_free(last_report);
+  my_free(report);
+
 
   sptr->timing= timedif(end_time, start_time);
   sptr->users= concur;
@@ -1814,6 +2306,7 @@ pthread_handler_t run_task(void *p)
 {
   ulonglong counter= 0, queries;
   ulonglong detach_counter;
+  ulonglong query_start= 0, next_start= 0;
   unsigned int commit_counter;
   MYSQL *mysql;
   MYSQL_RES *result;
@@ -1863,11 +2356,31 @@ pthread_handler_t run_task(void *p)
   if (commit_rate)
     run_query(mysql, "SET AUTOCOMMIT=0", strlen("SET AUTOCOMMIT=0"));
 
+  /* Clients start their queries evenly spread over the first interval */
+  if (con->rate_interval)
+    next_start= microsecond_interval_timer() +
+                con->number * 1000000ULL / opt_rate;
+
 limit_not_met:
-    for (ptr= con->stmt, detach_counter= 0; 
+    for (ptr= mix_total_weight ? pick_statement(con) : con->stmt,
+         detach_counter= 0; 
          ptr && ptr->length; 
-         ptr= ptr->next, detach_counter++)
+         ptr= mix_total_weight ? pick_statement(con) : ptr->next,
+         detach_counter++)
     {
+      /*
+        At --rate a query is due at its time slot whether or not the
+        previous one took longer, and its latency is counted from there.
+      */
+      if (con->rate_interval)
+      {
+        ulonglong now= microsecond_interval_timer();
+        if (next_start > now)
+          my_sleep((ulong) (next_start - now));
+        query_start= next_start;
+        next_start+= con->rate_interval;
+      }
+
       if (!opt_only_print && detach_rate && !(detach_counter % detach_rate))
       {
         mysql_close(mysql);
@@ -1882,6 +2395,9 @@ limit_not_met:
           goto end;
       }
 
+      if (!con->rate_interval)
+        query_start= microsecond_interval_timer();
+
       /* 
         We have to execute differently based on query type. This should become a function.
       */
@@ -1919,6 +2435,25 @@ limit_not_met:
           }
         }
       }
+      else if (ptr->type == KEY_TYPE_REQUIRES_PLACEHOLDER)
+      {
+        int length;
+        char buffer[HUGE_STRING_LENGTH];
+
+        if ((length= build_key_query(buffer, ptr,
+                                     get_random_key(&con->rand))) < 0)
+        {
+          fprintf(stderr,"%s: Query is too long with keys: %.*s\n",
+                  my_progname, (uint)ptr->length, ptr->string);
+          exit(0);
+        }
+        if (run_query(mysql, buffer, length))
+        {
+          fprintf(stderr,"%s: Cannot run query %.*s ERROR : %s\n",
+                  my_progname, (uint)length, buffer, mysql_error(mysql));
+          exit(0);
+        }
+      }
       else
       {
         if (run_query(mysql, ptr->string, ptr->length))
@@ -1946,6 +2481,16 @@ limit_not_met:
       } while(mysql_next_result(mysql) == 0);
       queries++;
 
+      {
+        ulonglong latency= microsecond_interval_timer() - query_start;
+        uint bucket= latency_bucket(latency);
+        pthread_mutex_lock(&con->latency_lock);
+        con->latency.count[bucket]++;
+        con->latency.total++;
+        set_if_bigger(con->latency.max, latency);
+        pthread_mutex_unlock(&con->latency_lock);
+      }
+
       if (commit_rate && (++commit_counter == commit_rate))
       {
         commit_counter= 0;
@@ -1954,6 +2499,9 @@ limit_not_met:
 
       if (con->limit && queries == con->limit)
         goto end;
+
+      if (think_time)
+        my_sleep((ulong) (-log(1.0 - my_rnd(&con->rand)) * think_time * 1000));
     }
 
     if (con->limit && queries < con->limit)
@@ -2145,6 +2693,18 @@ print_conclusions(conclusions *con)
                     con->max_timing / 1000, con->max_timing % 1000);
   printf("\tNumber of clients running queries: %d\n", con->users);
   printf("\tAverage number of queries per client: %llu\n", con->avg_rows); 
+  if (con->latency->total)
+  {
+    ulonglong p50= latency_percentile(con->latency, 50);
+    ulonglong p95= latency_percentile(con->latency, 95);
+    ulonglong p99= latency_percentile(con->latency, 99);
+    ulonglong p999= latency_percentile(con->latency, 99.9);
+    printf("\tQuery latency in milliseconds: p50 %llu.%03llu, p95 %llu.%03llu, "
+           "p99 %llu.%03llu, p999 %llu.%03llu, max %llu.%03llu\n",
+           p50 / 1000, p50 % 1000, p95 / 1000, p95 % 1000,
+           p99 / 1000, p99 % 1000, p999 / 1000, p999 % 1000,
+           con->latency->max / 1000, con->latency->max % 1000);
+  }
   printf("\n");
 }
 
@@ -2153,16 +2713,25 @@ print_conclusions_csv(conclusions *con)
 {
   char buffer[HUGE_STRING_LENGTH];
   const char *ptr= auto_generate_sql_type ? auto_generate_sql_type : "query";
+  ulonglong p50= latency_percentile(con->latency, 50);
+  ulonglong p95= latency_percentile(con->latency, 95);
+  ulonglong p99= latency_percentile(con->latency, 99);
+  ulonglong p999= latency_percentile(con->latency, 99.9);
 
   snprintf(buffer, HUGE_STRING_LENGTH, 
-           "%s,%s,%ld.%03ld,%ld.%03ld,%ld.%03ld,%d,%llu\n",
+           "%s,%s,%ld.%03ld,%ld.%03ld,%ld.%03ld,%d,%llu,"
+           "%llu.%03llu,%llu.%03llu,%llu.%03llu,%llu.%03llu\n",
            con->engine ? con->engine : "", /* Storage engine we ran against */
            ptr, /* Load type */
            con->avg_timing / 1000, con->avg_timing % 1000, /* Time to load */
            con->min_timing / 1000, con->min_timing % 1000, /* Min time */
            con->max_timing / 1000, con->max_timing % 1000, /* Max time */
            con->users, /* Children used */
-           con->avg_rows  /* Queries run */
+           con->avg_rows,  /* Queries run */
+           p50 / 1000, p50 % 1000, /* Latency percentiles in ms */
+           p95 / 1000, p95 % 1000,
+           p99 / 1000, p99 % 1000,
+           p999 / 1000, p999 % 1000
           );
   my_write(csv_file, (uchar*) buffer, (uint)strlen(buffer), MYF(0));
 }
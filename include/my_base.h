@@ -195,7 +195,12 @@ enum ha_extra_function {
   HA_EXTRA_DETACH_CHILDREN,
   HA_EXTRA_DETACH_CHILD,
   /* Inform handler we will force a close as part of flush */
-  HA_EXTRA_PREPARE_FOR_FORCED_CLOSE
+  HA_EXTRA_PREPARE_FOR_FORCED_CLOSE,
+  /*
+    Start reading the table for ALTER ONLINE TABLE: use non-locking reads
+    of committed rows and make the transaction end at the next commit.
+  */
+  HA_EXTRA_ONLINE_ALTER_READ
 };
 
 /* Compatible option, to be deleted in 6.0 */
@@ -45,6 +45,7 @@ char rpl_semi_sync_master_wait_no_slave = 1;
 
 
 static int getWaitTime(const struct timespec& start_ts);
+pthread_handler_t ack_receiver_thread(void *arg);
 
 static unsigned long long timespec_to_usec(const struct timespec *ts)
 {
@@ -1043,10 +1044,6 @@ int ReplSemiSyncMaster::readSlaveReply(NET *net, uint32 server_id,
                                        const char *event_buf)
 {
   const char *kWho = "ReplSemiSyncMaster::readSlaveReply";
-  const unsigned char *packet;
-  char     log_file_name[FN_REFLEN];
-  my_off_t log_file_pos;
-  ulong    log_file_len = 0;
   ulong    packet_len;
   int      result = -1;
   struct timespec start_ts;
@@ -1115,7 +1112,57 @@ int ReplSemiSyncMaster::readSlaveReply(NET *net, uint32 server_id,
     goto l_end;
   }
 
-  packet = net->read_pos;
+  result = reportReplyPacket(server_id, net->read_pos, packet_len);
+
+ l_end:
+  return function_exit(kWho, result);
+}
+
+int ReplSemiSyncMaster::flushSyncEvent(NET *net, const char *event_buf)
+{
+  const char *kWho = "ReplSemiSyncMaster::flushSyncEvent";
+  int result = 0;
+
+  function_enter(kWho);
+
+  assert((unsigned char)event_buf[1] == kPacketMagicNum);
+  if ((unsigned char)event_buf[2] != kPacketFlagSync)
+  {
+    /* current event does not require reply */
+    goto l_end;
+  }
+
+  /* A failure is not logged here: the connection has gone and the dump
+   * thread finds out when it sends the next event.
+   */
+  if (net_flush(net))
+  {
+    result = -1;
+    goto l_end;
+  }
+
+  /* The slave starts a new packet sequence when it replies, and the next
+   * event has to follow its reply: continue as readSlaveReply() does after
+   * reading the reply.
+   */
+  net->pkt_nr = net->compress_pkt_nr = 1;
+
+ l_end:
+  return function_exit(kWho, result);
+}
+
+int ReplSemiSyncMaster::reportReplyPacket(uint32 server_id,
+                                          const unsigned char *packet,
+                                          ulong packet_len)
+{
+  const char *kWho = "ReplSemiSyncMaster::reportReplyPacket";
+  char     log_file_name[FN_REFLEN];
+  my_off_t log_file_pos;
+  ulong    log_file_len = 0;
+  int      result = -1;
+
+  function_enter(kWho);
+
   if (packet[REPLY_MAGIC_NUM_OFFSET] != ReplSemiSyncMaster::kPacketMagicNum)
   {
     sql_print_error("Read semi-sync reply magic number error");
@@ -1132,7 +1179,7 @@ int ReplSemiSyncMaster::readSlaveReply(NET *net, uint32 server_id,
   strncpy(log_file_name, (const char*)packet + REPLY_BINLOG_NAME_OFFSET, log_file_len);
   log_file_name[log_file_len] = 0;
 
-  if (trc_level & kTraceDetail)
+  if (trace_level_ & kTraceDetail)
     sql_print_information("%s: Got reply (%s, %lu)",
                           kWho, log_file_name, (ulong)log_file_pos);
 
@@ -1217,3 +1264,136 @@ static int getWaitTime(const struct timespec& start_ts)
 
   return (int)(end_usecs - start_usecs);
 }
+
+/*******************************************************************************
+ *
+ * <AckReceiver> class : read the replies of a semi-sync slave
+ *
+ ******************************************************************************/
+
+AckReceiver::AckReceiver(ReplSemiSyncMaster *master, uint32 server_id,
+                         unsigned long trace_level)
+  : Trace(trace_level), master_(master), server_id_(server_id),
+    stop_(false), next_(NULL)
+{
+  vio_.sd = INVALID_SOCKET;
+}
+
+int AckReceiver::start(NET *net)
+{
+  const char *kWho = "AckReceiver::start";
+
+  function_enter(kWho);
+
+#ifndef __WIN__
+  my_socket sd;
+
+  /* Compressed or buffered reads can not be shared with the dump thread. */
+  if (net->compress || net->vio->read_buffer ||
+      (vio_type(net->vio) != VIO_TYPE_TCPIP &&
+       vio_type(net->vio) != VIO_TYPE_SOCKET))
+    return function_exit(kWho, 1);
+
+  /* A descriptor of our own stays valid when the connection is killed. */
+  if ((sd = dup(vio_fd(net->vio))) < 0)
+    return function_exit(kWho, 1);
+  vio_ = *net->vio;
+  vio_.sd = sd;
+
+  if (mysql_thread_create(key_ss_thread_ack_receiver, &thread_, NULL,
+                          ack_receiver_thread, (void *) this))
+  {
+    closesocket(sd);
+    vio_.sd = INVALID_SOCKET;
+    return function_exit(kWho, 1);
+  }
+  return function_exit(kWho, 0);
+#else
+  /* Sockets can not be duplicated with dup() on Windows. */
+  return function_exit(kWho, 1);
+#endif
+}
+
+void AckReceiver::stop()
+{
+  const char *kWho = "AckReceiver::stop";
+
+  function_enter(kWho);
+  stop_ = true;
+  pthread_join(thread_, NULL);
+  closesocket(vio_.sd);
+  vio_.sd = INVALID_SOCKET;
+  function_exit(kWho, 0);
+}
+
+bool AckReceiver::read_fully(unsigned char *buf, size_t length)
+{
+  while (length)
+  {
+    size_t count = vio_read(&vio_, buf, length);
+
+    if (count == 0)
+      return true;                              /* connection closed */
+    if (count == (size_t) -1)
+    {
+      if (stop_ || !vio_should_retry(&vio_))
+        return true;
+      /* The socket is non-blocking and the rest has not arrived yet. */
+      vio_poll_read(&vio_, 1);
+      continue;
+    }
+    buf += count;
+    length -= count;
+  }
+  return false;
+}
+
+void AckReceiver::run()
+{
+  const char *kWho = "AckReceiver::run";
+  const unsigned char *packet = packet_ + NET_HEADER_SIZE;
+  ulong packet_len;
+
+  function_enter(kWho);
+
+  while (!stop_)
+  {
+    /* Look at stop_ every second when the slave has nothing to say. */
+    if (vio_poll_read(&vio_, 1))
+      continue;
+
+    if (read_fully(packet_, NET_HEADER_SIZE))
+      break;
+
+    /* Anything shorter than a reply, like the COM_QUIT of a slave which
+     * disconnects, ends the reading: the dump thread finds out about the
+     * end of the connection on its own.
+     */
+    packet_len = uint3korr(packet_);
+    if (packet_len < REPLY_BINLOG_NAME_OFFSET)
+      break;
+    if (packet_len > sizeof(packet_) - NET_HEADER_SIZE)
+    {
+      sql_print_error("Read semi-sync reply length error");
+      break;
+    }
+    if (read_fully(packet_ + NET_HEADER_SIZE, packet_len))
+      break;
+
+    if (trace_level_ & kTraceDetail)
+      sql_print_information("%s: Got reply from slave (server_id: %d)",
+                            kWho, server_id_);
+    (void) master_->reportReplyPacket(server_id_, packet, packet_len);
+  }
+
+  function_exit(kWho, 0);
+}
+
+pthread_handler_t ack_receiver_thread(void *arg)
+{
+  my_thread_init();
+  ((AckReceiver *) arg)->run();
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
@@ -20,10 +20,12 @@
 #define SEMISYNC_MASTER_H
 
 #include "semisync.h"
+#include <violite.h>
 
 #ifdef HAVE_PSI_INTERFACE
 extern PSI_mutex_key key_ss_mutex_LOCK_binlog_;
 extern PSI_cond_key key_ss_cond_COND_binlog_send_;
+extern PSI_thread_key key_ss_thread_ack_receiver;
 #endif
 
 struct TranxNode {
@@ -581,6 +583,32 @@ class ReplSemiSyncMaster
    */
   int readSlaveReply(NET *net, uint32 server_id, const char *event_buf);
 
+  /* Flush the event packet to the slave if the slave is asked to reply to
+   * it, without waiting for the reply: the reply is read by the AckReceiver
+   * of the slave.
+   *
+   * Input:
+   *  net          - (IN)  the connection to the slave
+   *  event_buf    - (IN)  pointer to the event packet
+   *
+   * Return:
+   *  0: success;  non-zero: error
+   */
+  int flushSyncEvent(NET *net, const char *event_buf);
+
+  /* Check a reply packet of the slave and report the binlog position in it.
+   *
+   * Input:
+   *  server_id    - (IN)  master server id number
+   *  packet       - (IN)  the reply packet, without the network header
+   *  packet_len   - (IN)  length of the packet
+   *
+   * Return:
+   *  0: success;  non-zero: error
+   */
+  int reportReplyPacket(uint32 server_id, const unsigned char *packet,
+                        ulong packet_len);
+
   /* Export internal statistics for semi-sync replication. */
   void setExportStats();
 
@@ -590,6 +618,55 @@ class ReplSemiSyncMaster
   int resetMaster();
 };
 
+/**
+   Reads the replies of one semi-sync slave in a thread of its own.
+
+   The binlog dump thread only flushes the events the slave must reply to
+   and goes on sending the next ones, instead of waiting for the reply of
+   each transaction in between.  The receiver reads on a duplicate of the
+   slave's socket, so it is only used for plain uncompressed TCP/IP and
+   socket connections; for the others the dump thread reads the replies
+   itself (ReplSemiSyncMaster::readSlaveReply()).
+*/
+class AckReceiver
+  :public Trace {
+ private:
+  ReplSemiSyncMaster *master_;
+  uint32          server_id_;
+
+  /* A copy of the Vio of the dump thread on a duplicate socket descriptor. */
+  Vio             vio_;
+  pthread_t       thread_;
+  volatile bool   stop_;
+
+  /* Buffer for one reply: network header, magic number, position, name. */
+  unsigned char   packet_[NET_HEADER_SIZE + REPLY_BINLOG_NAME_OFFSET +
+                          REPLY_BINLOG_NAME_LEN];
+
+  bool read_fully(unsigned char *buf, size_t length);
+
+ public:
+  /* Receivers of all running dump threads, for stopping them on unload. */
+  AckReceiver    *next_;
+
+  AckReceiver(ReplSemiSyncMaster *master, uint32 server_id,
+              unsigned long trace_level);
+
+  /* Start reading the replies sent on the connection of the dump thread.
+   *
+   * Return:
+   *  0: success;  non-zero: the connection can not be shared, the dump
+   *                         thread has to read the replies itself
+   */
+  int start(NET *net);
+
+  /* Stop reading and wait for the thread to finish. */
+  void stop();
+
+  /* Body of the receiver thread: report the replies until told to stop. */
+  void run();
+};
+
 /* System and status variables for the master component */
 extern char rpl_semi_sync_master_enabled;
 extern char rpl_semi_sync_master_status;
@@ -21,6 +21,46 @@
 
 ReplSemiSyncMaster repl_semisync;
 
+/* The AckReceiver of the dump thread, NULL if it reads replies itself. */
+static pthread_key_t THR_ack_receiver;
+
+/* All running AckReceivers, protected by LOCK_ack_receivers. */
+static AckReceiver *ack_receivers= NULL;
+static mysql_mutex_t LOCK_ack_receivers;
+
+static void start_ack_receiver(uint32 server_id)
+{
+  AckReceiver *receiver= new AckReceiver(&repl_semisync, server_id,
+                                         rpl_semi_sync_master_trace_level);
+
+  if (receiver->start(&current_thd->net))
+  {
+    /* The dump thread reads the replies after sending the events. */
+    delete receiver;
+    return;
+  }
+
+  mysql_mutex_lock(&LOCK_ack_receivers);
+  receiver->next_= ack_receivers;
+  ack_receivers= receiver;
+  mysql_mutex_unlock(&LOCK_ack_receivers);
+  pthread_setspecific(THR_ack_receiver, receiver);
+}
+
+static void stop_ack_receiver(AckReceiver *receiver)
+{
+  AckReceiver **prev;
+
+  mysql_mutex_lock(&LOCK_ack_receivers);
+  for (prev= &ack_receivers; *prev != receiver; prev= &(*prev)->next_)
+    ;
+  *prev= receiver->next_;
+  mysql_mutex_unlock(&LOCK_ack_receivers);
+
+  receiver->stop();
+  delete receiver;
+}
+
 C_MODE_START
 
 int repl_semi_report_binlog_update(Binlog_storage_param *param,
@@ -82,6 +122,9 @@ int repl_semi_binlog_dump_start(Binlog_transmit_param *param,
       binlog events before the filename and position it requests.
     */
     repl_semisync.reportReplyBinlog(param->server_id, log_file, log_pos);
+
+    /* Read the replies of the slave while sending it events. */
+    start_ack_receiver(param->server_id);
   }
   sql_print_information("Start %s binlog_dump to slave (server_id: %d), pos(%s, %lu)",
 			semi_sync_slave ? "semi-sync" : "asynchronous",
@@ -93,7 +136,14 @@ int repl_semi_binlog_dump_start(Binlog_transmit_param *param,
 int repl_semi_binlog_dump_end(Binlog_transmit_param *param)
 {
   bool semi_sync_slave= repl_semisync.is_semi_sync_slave();
-  
+  AckReceiver *receiver=
+    (AckReceiver *) pthread_getspecific(THR_ack_receiver);
+
+  if (receiver)
+  {
+    pthread_setspecific(THR_ack_receiver, NULL);
+    stop_ack_receiver(receiver);
+  }
   sql_print_information("Stop %s binlog_dump to slave (server_id: %d)",
                         semi_sync_slave ? "semi-sync" : "asynchronous",
                         param->server_id);
@@ -126,7 +176,20 @@ int repl_semi_before_send_event(Binlog_transmit_param *param,
 int repl_semi_after_send_event(Binlog_transmit_param *param,
                                const char *event_buf, unsigned long len)
 {
-  if (repl_semisync.is_semi_sync_slave())
+  AckReceiver *receiver=
+    (AckReceiver *) pthread_getspecific(THR_ack_receiver);
+
+  if (receiver)
+  {
+    THD *thd= current_thd;
+    /*
+      Only send the event on its way: its reply is read by the
+      AckReceiver while the next events are sent.
+    */
+    (void) repl_semisync.flushSyncEvent(&thd->net, event_buf);
+    thd->clear_error();
+  }
+  else if (repl_semisync.is_semi_sync_slave())
   {
     THD *thd= current_thd;
     /*
@@ -342,10 +405,12 @@ static SHOW_VAR semi_sync_master_status_vars[]= {
 
 #ifdef HAVE_PSI_INTERFACE
 PSI_mutex_key key_ss_mutex_LOCK_binlog_;
+static PSI_mutex_key key_ss_mutex_LOCK_ack_receivers;
 
 static PSI_mutex_info all_semisync_mutexes[]=
 {
-  { &key_ss_mutex_LOCK_binlog_, "LOCK_binlog_", 0}
+  { &key_ss_mutex_LOCK_binlog_, "LOCK_binlog_", 0},
+  { &key_ss_mutex_LOCK_ack_receivers, "LOCK_ack_receivers", PSI_FLAG_GLOBAL}
 };
 
 PSI_cond_key key_ss_cond_COND_binlog_send_;
@@ -355,6 +420,13 @@ static PSI_cond_info all_semisync_conds[]=
   { &key_ss_cond_COND_binlog_send_, "COND_binlog_send_", 0}
 };
 
+PSI_thread_key key_ss_thread_ack_receiver;
+
+static PSI_thread_info all_semisync_threads[]=
+{
+  { &key_ss_thread_ack_receiver, "ack_receiver", 0}
+};
+
 static void init_semisync_psi_keys(void)
 {
   const char* category= "semisync";
@@ -368,6 +440,9 @@ static void init_semisync_psi_keys(void)
 
   count= array_elements(all_semisync_conds);
   PSI_server->register_cond(category, all_semisync_conds, count);
+
+  count= array_elements(all_semisync_threads);
+  PSI_server->register_thread(category, all_semisync_threads, count);
 }
 #endif /* HAVE_PSI_INTERFACE */
 
@@ -379,6 +454,10 @@ static int semi_sync_master_plugin_init(void *p)
 
   if (repl_semisync.initObject())
     return 1;
+  if (pthread_key_create(&THR_ack_receiver, NULL))
+    return 1;
+  mysql_mutex_init(key_ss_mutex_LOCK_ack_receivers,
+                   &LOCK_ack_receivers, MY_MUTEX_INIT_FAST);
   if (register_trans_observer(&trans_observer, p))
     return 1;
   if (register_binlog_storage_observer(&storage_observer, p))
@@ -406,6 +485,12 @@ static int semi_sync_master_plugin_deinit(void *p)
     return 1;
   }
   sql_print_information("unregister_replicator OK");
+
+  /* Dump threads do not call the observers any more, stop their readers. */
+  while (ack_receivers)
+    stop_ack_receiver(ack_receivers);
+  mysql_mutex_destroy(&LOCK_ack_receivers);
+  pthread_key_delete(THR_ack_receiver);
   return 0;
 }
 
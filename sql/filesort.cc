@@ -57,11 +57,19 @@ static bool save_index(SORTPARAM *param,uchar **sort_keys, uint count,
                        FILESORT_INFO *table_sort);
 static uint suffix_length(ulong string_length);
 static uint sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
-		       bool *multi_byte_charset);
+		       bool *multi_byte_charset, bool *packed_sort_keys);
 static SORT_ADDON_FIELD *get_addon_fields(THD *thd, Field **ptabfield,
                                           uint sortlength, uint *plength);
 static void unpack_addon_fields(struct st_sort_addon_field *addon_field,
                                 uchar *buff, uchar *buff_end);
+static void unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                                       uchar *buff, uchar *buff_end);
+static int packed_sort_key_cmp(void *arg, uchar **a, uchar **b);
+static uint packed_record_length(SORTPARAM *param, uchar *record);
+static bool write_packed_record(SORTPARAM *param, IO_CACHE *to_file,
+                                uchar *record, bool result_only);
+static uint read_packed_to_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                  BUFFPEK *buffpek);
 /**
   Sort a table.
   Creates a set of pointers that can be used to read the rows
@@ -144,7 +152,10 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
   buffpek=0;
   error= 1;
   bzero((char*) &param,sizeof(param));
-  param.sort_length= sortlength(thd, sortorder, s_length, &multi_byte_charset);
+  param.sort_length= sortlength(thd, sortorder, s_length, &multi_byte_charset,
+                                &param.using_packed_records);
+  if (param.using_packed_records)
+    param.sort_length+= PACKED_LENGTH_BYTES;
   param.ref_length= table->file->ref_length;
   if (!(table->file->ha_table_flags() & HA_FAST_KEY_READ) &&
       !table->fulltext_searched && !sort_positions)
@@ -158,10 +169,33 @@ ha_rows filesort(THD *thd, TABLE *table, SORT_FIELD *sortorder, uint s_length,
                                         &param.addon_length);
   }
 
+  if (param.addon_field)
+  {
+    /*
+      VARCHAR values are appended with their actual length, so use
+      variable length records if there are any.
+    */
+    for (SORT_ADDON_FIELD *addonf= param.addon_field;
+         addonf->field && !param.using_packed_records;
+         addonf++)
+    {
+      if (addonf->field->real_type() == MYSQL_TYPE_VARCHAR)
+      {
+        param.using_packed_records= TRUE;
+        param.sort_length+= PACKED_LENGTH_BYTES;
+      }
+    }
+    if (param.using_packed_records)
+      param.addon_length+= PACKED_LENGTH_BYTES;
+  }
+
   table_sort.addon_buf= 0;
   table_sort.addon_length= param.addon_length;
   table_sort.addon_field= param.addon_field;
-  table_sort.unpack= unpack_addon_fields;
+  table_sort.using_packed_addons= param.using_packed_records &&
+                                  param.addon_field;
+  table_sort.unpack= (table_sort.using_packed_addons ?
+                      unpack_packed_addon_fields : unpack_addon_fields);
   if (param.addon_field)
   {
     param.res_length= param.addon_length;
@@ -382,6 +416,7 @@ void filesort_free_buffers(TABLE *table, bool full)
   my_free(table->sort.addon_field);
   table->sort.addon_buf= NULL;
   table->sort.addon_field= NULL;
+  table->sort.using_packed_addons= FALSE;
   DBUG_VOID_RETURN;
 }
 
@@ -512,6 +547,7 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
   handler *file;
   MY_BITMAP *save_read_set, *save_write_set, *save_vcol_set;
   uchar *next_sort_key= sort_keys_buf;
+  ha_rows written_rows= 0;
   DBUG_ENTER("find_all_keys");
   DBUG_PRINT("info",("using: %s",
                      (select ? select->quick ? "ranges" : "where":
@@ -525,6 +561,15 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
   ref_pos= ref_buff;
   quick_select=select && select->quick;
   record=0;
+  if (param->using_packed_records)
+  {
+    /*
+      Records of variable length are stored from the end of the buffer
+      downwards, so that the buffer is full only when the pointers and
+      the records meet.
+    */
+    next_sort_key= sort_keys_buf + param->keys * param->rec_length;
+  }
   flag= ((file->ha_table_flags() & HA_REC_NOT_IN_SEQ) || quick_select);
   if (flag)
     ref_pos= &file->ref[0];
@@ -639,18 +684,36 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
 
     if (write_record)
     {
-      if (idx == param->keys)
+      if (param->using_packed_records ?
+          (uchar*) (sort_keys + idx + 1) > next_sort_key - param->rec_length :
+          idx == param->keys)
       {
 	if (write_keys(param, sort_keys,
                        idx, buffpek_pointers, tempfile))
 	  DBUG_RETURN(HA_POS_ERROR);
+        written_rows+= min((ha_rows) idx, param->max_rows);
 	idx= 0;
         next_sort_key= sort_keys_buf;
+        if (param->using_packed_records)
+          next_sort_key+= param->keys * param->rec_length;
 	indexpos++;
       }
-      sort_keys[idx++]= next_sort_key;
-      make_sortkey(param, next_sort_key, ref_pos);
-      next_sort_key+= param->rec_length;
+      if (param->using_packed_records)
+      {
+        /* Make the key in place for the longest record, then move it up */
+        uchar *key= next_sort_key - param->rec_length;
+        make_sortkey(param, key, ref_pos);
+        uint length= packed_record_length(param, key);
+        next_sort_key-= length;
+        memmove(next_sort_key, key, length);
+        sort_keys[idx++]= next_sort_key;
+      }
+      else
+      {
+        sort_keys[idx++]= next_sort_key;
+        make_sortkey(param, next_sort_key, ref_pos);
+        next_sort_key+= param->rec_length;
+      }
     }
     else
       file->unlock_row();
@@ -678,13 +741,14 @@ static ha_rows find_all_keys(SORTPARAM *param, SQL_SELECT *select,
     file->print_error(error,MYF(ME_ERROR | ME_WAITTANG)); // purecov: inspected
     DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
   }
-  if (indexpos && idx &&
-      write_keys(param, sort_keys,
-                 idx, buffpek_pointers, tempfile))
-    DBUG_RETURN(HA_POS_ERROR);			/* purecov: inspected */
-  const ha_rows retval=
-    my_b_inited(tempfile) ?
-    (ha_rows) (my_b_tell(tempfile)/param->rec_length) : idx;
+  if (indexpos && idx)
+  {
+    if (write_keys(param, sort_keys,
+                   idx, buffpek_pointers, tempfile))
+      DBUG_RETURN(HA_POS_ERROR);		/* purecov: inspected */
+    written_rows+= min((ha_rows) idx, param->max_rows);
+  }
+  const ha_rows retval= my_b_inited(tempfile) ? written_rows : idx;
   DBUG_RETURN(retval);
 } /* find_all_keys */
 
@@ -722,6 +786,10 @@ write_keys(SORTPARAM *param, register uchar **sort_keys, uint count,
 
   sort_length= param->sort_length;
   rec_length= param->rec_length;
+  if (param->using_packed_records)
+    my_qsort2((uchar*) sort_keys, count, sizeof(uchar*),
+              (qsort2_cmp) packed_sort_key_cmp, (void*) param);
+  else
 #ifdef MC68000
   quicksort(sort_keys,count,sort_length);
 #else
@@ -739,8 +807,12 @@ write_keys(SORTPARAM *param, register uchar **sort_keys, uint count,
     count=(uint) param->max_rows;               /* purecov: inspected */
   buffpek.count=(ha_rows) count;
   for (end=sort_keys+count ; sort_keys != end ; sort_keys++)
-    if (my_b_write(tempfile, (uchar*) *sort_keys, (uint) rec_length))
+  {
+    if (param->using_packed_records ?
+        write_packed_record(param, tempfile, *sort_keys, FALSE) :
+        my_b_write(tempfile, (uchar*) *sort_keys, (uint) rec_length))
       goto err;
+  }
   if (my_b_write(buffpek_pointers, (uchar*) &buffpek, sizeof(buffpek)))
     goto err;
   DBUG_RETURN(0);
@@ -773,6 +845,50 @@ static inline void store_length(uchar *to, uint length, uint pack_length)
 }
 
 
+/**
+  Store a VARCHAR column value in a packed sort key.
+
+  The value is stored as a NULL marker (if the column is nullable), a
+  2 byte length and the bytes of the value, truncated to
+  max_sort_length bytes. The NULL marker is the same as in fixed length
+  sort keys.
+
+  @return Pointer to the end of the stored value
+*/
+
+static uchar *make_packed_sort_field(SORT_FIELD *sort_field, uchar *to)
+{
+  Field_varstring *field= (Field_varstring*) sort_field->field;
+  uint max_length= sort_field->length - 2;
+  uint length;
+  const uchar *from;
+
+  if (field->maybe_null())
+  {
+    if (field->is_null())
+    {
+      *to++= (uchar) sort_field->reverse;
+      int2store(to, 0);
+      return to + 2;
+    }
+    *to++= (uchar) !sort_field->reverse;
+  }
+  length= field->length_bytes == 1 ? (uint) *field->ptr : uint2korr(field->ptr);
+  from= field->ptr + field->length_bytes;
+  if (length > max_length)
+  {
+    CHARSET_INFO *cs= field->sort_charset();
+    int well_formed_error;
+    length= (uint) cs->cset->well_formed_len(cs, (const char*) from,
+                                             (const char*) from + max_length,
+                                             max_length, &well_formed_error);
+  }
+  int2store(to, length);
+  memcpy(to + 2, from, length);
+  return to + 2 + length;
+}
+
+
 /** Make a sort-key from record. */
 
 static void make_sortkey(register SORTPARAM *param,
@@ -781,12 +897,21 @@ static void make_sortkey(register SORTPARAM *param,
   reg3 Field *field;
   reg1 SORT_FIELD *sort_field;
   reg5 uint length;
+  uchar *start= to;
+
+  if (param->using_packed_records)
+    to+= PACKED_LENGTH_BYTES;                   // Place for key length
 
   for (sort_field=param->local_sortorder ;
        sort_field != param->end ;
        sort_field++)
   {
     bool maybe_null=0;
+    if (sort_field->packed)
+    {
+      to= make_packed_sort_field(sort_field, to);
+      continue;
+    }
     if ((field=sort_field->field))
     {						// Field
       field->make_sort_key(to, sort_field->length);
@@ -962,7 +1087,30 @@ static void make_sortkey(register SORTPARAM *param,
       to+= sort_field->length;
   }
 
-  if (param->addon_field)
+  if (param->using_packed_records)
+    int4store(start, (uint32) (to - start));
+
+  if (param->addon_field && param->using_packed_records)
+  {
+    /*
+      Save the addon part as its length, the null bits and the packed
+      values of the fields that are not NULL.
+    */
+    SORT_ADDON_FIELD *addonf= param->addon_field;
+    uchar *addon_start= to;
+    uchar *nulls= to + PACKED_LENGTH_BYTES;
+    bzero((char *) nulls, addonf->offset);
+    to= nulls + addonf->offset;
+    for ( ; (field= addonf->field) ; addonf++)
+    {
+      if (addonf->null_bit && field->is_null())
+        nulls[addonf->null_offset]|= addonf->null_bit;
+      else
+        to= field->pack(to, field->ptr);
+    }
+    int4store(addon_start, (uint32) (to - addon_start));
+  }
+  else if (param->addon_field)
   {
     /* 
       Save field values appended to sorted fields.
@@ -1064,7 +1212,11 @@ static bool save_index(SORTPARAM *param, uchar **sort_keys, uint count,
   uchar *to;
   DBUG_ENTER("save_index");
 
-  my_string_ptr_sort((uchar*) sort_keys, (uint) count, param->sort_length);
+  if (param->using_packed_records)
+    my_qsort2((uchar*) sort_keys, count, sizeof(uchar*),
+              (qsort2_cmp) packed_sort_key_cmp, (void*) param);
+  else
+    my_string_ptr_sort((uchar*) sort_keys, (uint) count, param->sort_length);
   res_length= param->res_length;
   offset= param->rec_length-res_length;
   if ((ha_rows) count > param->max_rows)
@@ -1074,7 +1226,14 @@ static bool save_index(SORTPARAM *param, uchar **sort_keys, uint count,
     DBUG_RETURN(1);                 /* purecov: inspected */
   for (uchar **end= sort_keys+count ; sort_keys != end ; sort_keys++)
   {
-    memcpy(to, *sort_keys+offset, res_length);
+    if (param->using_packed_records)
+    {
+      /* Keep a fixed distance, so that the result can be read as usual */
+      uchar *res= *sort_keys + uint4korr(*sort_keys);
+      memcpy(to, res, param->addon_field ? uint4korr(res) : res_length);
+    }
+    else
+      memcpy(to, *sort_keys+offset, res_length);
     to+= res_length;
   }
   DBUG_RETURN(0);
@@ -1269,6 +1428,11 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
     cmp= param->compare;
     first_cmp_arg= (void *) &param->cmp_context;
   }
+  else if (param->using_packed_records)
+  {
+    cmp= (qsort2_cmp) packed_sort_key_cmp;
+    first_cmp_arg= (void*) param;
+  }
   else
   {
     cmp= get_ptr_compare(sort_length);
@@ -1281,12 +1445,26 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
   {
     buffpek->base= strpos;
     buffpek->max_keys= maxcount;
-    strpos+=
-      (uint) (error= (int) read_to_buffer(from_file, buffpek, rec_length));
+    if (param->using_packed_records)
+    {
+      /*
+        Records have variable length, so the number of records in the
+        area is not known in advance. Keep the whole area.
+      */
+      error= (int) read_packed_to_buffer(param, from_file, buffpek);
+      strpos+= maxcount * rec_length;
+      if (error == -1)
+        goto err;                               /* purecov: inspected */
+    }
+    else
+    {
+      strpos+=
+        (uint) (error= (int) read_to_buffer(from_file, buffpek, rec_length));
 
-    if (error == -1)
-      goto err;					/* purecov: inspected */
-    buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+      if (error == -1)
+        goto err;				/* purecov: inspected */
+      buffpek->max_keys= buffpek->mem_count;	// If less data in buffers than expected
+    }
     queue_insert(&queue, (uchar*) buffpek);
   }
 
@@ -1360,7 +1538,9 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       */          
       if (!check_dupl_count || dupl_count >= min_dupl_count)
       {
-        if (my_b_write(to_file, src+wr_offset, wr_len))
+        if (param->using_packed_records ?
+            write_packed_record(param, to_file, src, flag) :
+            my_b_write(to_file, src+wr_offset, wr_len))
         {
           error=1; goto err;                        /* purecov: inspected */
         }
@@ -1379,11 +1559,16 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       }
 
     skip_duplicate:
-      buffpek->key+= rec_length;
+      buffpek->key+= (param->using_packed_records ?
+                      packed_record_length(param, buffpek->key) :
+                      rec_length);
       if (! --buffpek->mem_count)
       {
-        if (!(error= (int) read_to_buffer(from_file, buffpek,
-                                          rec_length)))
+        if (!(error= (int) (param->using_packed_records ?
+                            read_packed_to_buffer(param, from_file,
+                                                  buffpek) :
+                            read_to_buffer(from_file, buffpek,
+                                           rec_length))))
         {
           (void) queue_remove_top(&queue);
           reuse_freed_buff(&queue, buffpek, rec_length);
@@ -1444,7 +1629,19 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       buffpek->count= 0;                        /* Don't read more */
     }
     max_rows-= buffpek->mem_count;
-    if (flag == 0)
+    if (param->using_packed_records)
+    {
+      uchar *key= buffpek->key;
+      for (uint i= 0; i < buffpek->mem_count; i++)
+      {
+        if (write_packed_record(param, to_file, key, flag))
+        {
+          error= 1; goto err;                      /* purecov: inspected */
+        }
+        key+= packed_record_length(param, key);
+      }
+    }
+    else if (flag == 0)
     {
       if (my_b_write(to_file, (uchar*) buffpek->key,
                      (rec_length*buffpek->mem_count)))
@@ -1473,7 +1670,9 @@ int merge_buffers(SORTPARAM *param, IO_CACHE *from_file,
       }
     }
   }
-  while ((error=(int) read_to_buffer(from_file, buffpek, rec_length))
+  while ((error=(int) (param->using_packed_records ?
+                       read_packed_to_buffer(param, from_file, buffpek) :
+                       read_to_buffer(from_file, buffpek, rec_length)))
          != -1 && error != 0);
 
 end:
@@ -1499,6 +1698,156 @@ int merge_index(SORTPARAM *param, uchar *sort_buffer,
 } /* merge_index */
 
 
+/**
+  Get the length of a record in the packed format.
+
+  @param param   Sort parameters
+  @param record  Start of the record
+*/
+
+static uint packed_record_length(SORTPARAM *param, uchar *record)
+{
+  uchar *res= record + uint4korr(record);
+  return (uint) (res - record) + (param->addon_field ? uint4korr(res) :
+                                  param->ref_length);
+}
+
+
+/**
+  Write a record in the packed format to a file.
+
+  @param param        Sort parameters
+  @param to_file      File to write to
+  @param record       Start of the record
+  @param result_only  Write only the ref or addon part of the record
+
+  @retval
+    0   OK
+  @retval
+    1   Error
+*/
+
+static bool write_packed_record(SORTPARAM *param, IO_CACHE *to_file,
+                                uchar *record, bool result_only)
+{
+  if (result_only)
+  {
+    uchar *res= record + uint4korr(record);
+    return my_b_write(to_file, res,
+                      param->addon_field ? uint4korr(res) : param->ref_length);
+  }
+  return my_b_write(to_file, record, packed_record_length(param, record));
+}
+
+
+/**
+  Read records in the packed format to the buffer of a BUFFPEK.
+
+  Like read_to_buffer(), but reads as many complete records as fit into
+  the buffer, which has room for buffpek->max_keys records of the
+  maximal length.
+
+  @retval
+    (uint)-1 if something goes wrong
+  @retval
+    Number of bytes read
+*/
+
+static uint read_packed_to_buffer(SORTPARAM *param, IO_CACHE *fromfile,
+                                  BUFFPEK *buffpek)
+{
+  size_t length;
+  uchar *pos, *end;
+  uint count;
+
+  if (!buffpek->count)
+    return 0;
+  if ((length= mysql_file_pread(fromfile->file, buffpek->base,
+                                buffpek->max_keys * param->rec_length,
+                                buffpek->file_pos, MYF(MY_WME))) ==
+      MY_FILE_ERROR)
+    return (uint) -1;                           /* purecov: inspected */
+
+  pos= buffpek->base;
+  end= pos + length;
+  for (count= 0; count < buffpek->count; count++)
+  {
+    /* Stop at the first record that was not read completely */
+    uint record_length;
+    if (pos + PACKED_LENGTH_BYTES > end ||
+        (param->addon_field &&
+         pos + uint4korr(pos) + PACKED_LENGTH_BYTES > end) ||
+        pos + (record_length= packed_record_length(param, pos)) > end)
+      break;
+    pos+= record_length;
+  }
+  if (!count)
+    return (uint) -1;                           /* purecov: deadcode */
+
+  buffpek->key= buffpek->base;
+  buffpek->file_pos+= (pos - buffpek->base);
+  buffpek->count-= count;
+  buffpek->mem_count= count;
+  return (uint) (pos - buffpek->base);
+}
+
+
+/**
+  Compare two records in the packed format.
+
+  Fixed length sort fields are compared with memcmp(), packed ones with
+  the collation of the column. Records with equal keys are ordered by
+  the row reference, as with fixed length keys.
+
+  @param arg  Sort parameters
+  @param a    Pointer to the first record
+  @param b    Pointer to the second record
+*/
+
+static int packed_sort_key_cmp(void *arg, uchar **a, uchar **b)
+{
+  SORTPARAM *param= (SORTPARAM*) arg;
+  uchar *pos_a= *a + PACKED_LENGTH_BYTES;
+  uchar *pos_b= *b + PACKED_LENGTH_BYTES;
+  int res;
+
+  for (SORT_FIELD *sort_field= param->local_sortorder;
+       sort_field != param->end;
+       sort_field++)
+  {
+    bool maybe_null= (sort_field->field ? sort_field->field->maybe_null() :
+                      sort_field->item->maybe_null);
+    if (!sort_field->packed)
+    {
+      uint length= sort_field->length + maybe_null;
+      if ((res= memcmp(pos_a, pos_b, length)))
+        return res;
+      pos_a+= length;
+      pos_b+= length;
+      continue;
+    }
+    if (maybe_null)
+    {
+      if (*pos_a != *pos_b)
+        return (int) *pos_a - (int) *pos_b;
+      pos_a++;
+      pos_b++;
+    }
+    uint length_a= uint2korr(pos_a);
+    uint length_b= uint2korr(pos_b);
+    CHARSET_INFO *cs= sort_field->field->sort_charset();
+    if ((res= cs->coll->strnncollsp(cs, pos_a + 2, length_a,
+                                    pos_b + 2, length_b, 0)))
+      return sort_field->reverse ? -res : res;
+    pos_a+= 2 + length_a;
+    pos_b+= 2 + length_b;
+  }
+  if (param->addon_field)
+    return 0;
+  return memcmp(*a + uint4korr(*a), *b + uint4korr(*b), param->ref_length);
+}
+
+
 static uint suffix_length(ulong string_length)
 {
   if (string_length < 256)
@@ -1520,11 +1869,15 @@ static uint suffix_length(ulong string_length)
   @param s_length	          Number of items to sort
   @param[out] multi_byte_charset Set to 1 if we are using multi-byte charset
                                  (In which case we have to use strxnfrm())
+  @param[out] packed_sort_keys   Set to 1 if some fields are packed
 
   @note
     sortorder->length is updated for each sort item.
   @n
     sortorder->need_strxnfrm is set 1 if we have to use strxnfrm
+  @n
+    sortorder->packed is set 1 for VARCHAR columns. They are stored with
+    their actual length instead of being padded to the maximal one.
 
   @return
     Total length of sort buffer in bytes
@@ -1532,17 +1885,32 @@ static uint suffix_length(ulong string_length)
 
 static uint
 sortlength(THD *thd, SORT_FIELD *sortorder, uint s_length,
-           bool *multi_byte_charset)
+           bool *multi_byte_charset, bool *packed_sort_keys)
 {
   reg2 uint length;
   CHARSET_INFO *cs;
   *multi_byte_charset= 0;
+  *packed_sort_keys= 0;
 
   length=0;
   for (; s_length-- ; sortorder++)
   {
     sortorder->need_strxnfrm= 0;
     sortorder->suffix_length= 0;
+    sortorder->packed= 0;
+    if (sortorder->field &&
+        sortorder->field->real_type() == MYSQL_TYPE_VARCHAR)
+    {
+      /* The value, at most max_sort_length bytes of it, and its length */
+      sortorder->packed= 1;
+      *packed_sort_keys= 1;
+      sortorder->length= min(sortorder->field->field_length,
+                             thd->variables.max_sort_length) + 2;
+      if (sortorder->field->maybe_null())
+        length++;				// Place for NULL marker
+      length+= sortorder->length;
+      continue;
+    }
     if (sortorder->field)
     {
       cs= sortorder->field->sort_charset();
@@ -1743,6 +2111,41 @@ unpack_addon_fields(struct st_sort_addon_field *addon_field, uchar *buff,
   }
 }
 
+
+/**
+  Copy (unpack) values appended to sorted fields in the packed format
+  back to their regular positions.
+
+  @param addon_field     Array of descriptors for appended fields
+  @param buff            Buffer which to unpack the value from
+  @param buff_end        End of the buffer
+
+  @note
+    The function is used instead of unpack_addon_fields() if
+    FILESORT_INFO::using_packed_addons is set.
+*/
+
+static void
+unpack_packed_addon_fields(struct st_sort_addon_field *addon_field,
+                           uchar *buff, uchar *buff_end)
+{
+  Field *field;
+  SORT_ADDON_FIELD *addonf= addon_field;
+  uchar *nulls= buff + PACKED_LENGTH_BYTES;
+  const uchar *pos= nulls + addonf->offset;
+
+  for ( ; (field= addonf->field) ; addonf++)
+  {
+    if (addonf->null_bit && (addonf->null_bit & nulls[addonf->null_offset]))
+    {
+      field->set_null();
+      continue;
+    }
+    field->set_notnull();
+    pos= field->unpack(field->ptr, pos, buff_end, 0);
+  }
+}
+
 /*
 ** functions to change a double or float to a sortable string
 ** The following should work for IEEE
@@ -44,6 +44,7 @@
 #include "probes_mysql.h"
 #include "debug_sync.h"         // DEBUG_SYNC
 #include "sql_audit.h"
+#include "sql_alter.h"          // online_alter_log_row
 
 #ifdef WITH_PARTITION_STORAGE_ENGINE
 #include "ha_partition.h"
@@ -1409,7 +1410,11 @@ commit_one_phase_2(THD *thd, bool all, THD_TRANS *trans, bool is_real_trans)
   }
   /* Free resources and perform other cleanup even for 'empty' transactions. */
   if (is_real_trans)
+  {
     thd->transaction.cleanup();
+    if (unlikely(thd->online_alter_keys != NULL))
+      online_alter_log_trans_end(thd);
+  }
 
   DBUG_RETURN(error);
 }
@@ -1484,7 +1489,11 @@ int ha_rollback_trans(THD *thd, bool all)
   }
   /* Always cleanup. Even if nht==0. There may be savepoints. */
   if (is_real_trans)
+  {
     thd->transaction.cleanup();
+    if (unlikely(thd->online_alter_keys != NULL))
+      online_alter_log_trans_end(thd);
+  }
   if (all)
     thd->transaction_rollback_request= FALSE;
 
@@ -5178,6 +5187,9 @@ int handler::ha_write_row(uchar *buf)
   if (unlikely(error))
     DBUG_RETURN(error);
   rows_changed++;
+  if (unlikely(table_share->online_alter_log) &&
+      (error= online_alter_log_row(table, 0, buf)))
+    DBUG_RETURN(error);
   if (unlikely(error= binlog_log_row(table, 0, buf, log_func)))
     DBUG_RETURN(error); /* purecov: inspected */
 
@@ -5207,6 +5219,9 @@ int handler::ha_update_row(const uchar *old_data, uchar *new_data)
   if (unlikely(error))
     return error;
   rows_changed++;
+  if (unlikely(table_share->online_alter_log) &&
+      (error= online_alter_log_row(table, old_data, new_data)))
+    return error;
   if (unlikely(error= binlog_log_row(table, old_data, new_data, log_func)))
     return error;
   return 0;
@@ -5233,6 +5248,9 @@ int handler::ha_delete_row(const uchar *buf)
   if (unlikely(error))
     return error;
   rows_changed++;
+  if (unlikely(table_share->online_alter_log) &&
+      (error= online_alter_log_row(table, buf, 0)))
+    return error;
   if (unlikely(error= binlog_log_row(table, buf, 0, log_func)))
     return error;
   return 0;
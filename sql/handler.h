@@ -188,6 +188,17 @@
 */
 #define HA_MUST_USE_TABLE_CONDITION_PUSHDOWN (LL(1) << 42)
 
+/*
+  ALTER ONLINE TABLE can copy the table while other connections change it.
+  The engine must change rows only through ha_write_row(), ha_update_row()
+  and ha_delete_row() (no foreign key cascades on the table), and
+  extra(HA_EXTRA_ONLINE_ALTER_READ) must make the following reads of the
+  statement non-locking reads of committed rows, which are re-done in a new
+  transaction after each commit. Changes of the rows made during the copy
+  are collected by the server in an Online_alter_log.
+*/
+#define HA_CAN_ONLINE_ALTER (LL(1) << 43)
+
 /*
   Set of all binlog flags. Currently only contain the capabilities
   flags.
@@ -81,6 +81,7 @@
 #include "sql_base.h"                       // close_tables_for_reopen
 #include "sql_parse.h"                     // is_log_table_write_query
 #include "sql_acl.h"                       // SUPER_ACL
+#include "sp_cache.h"                      // sp_cache_invalidate_table
 #include <hash.h>
 #include <assert.h>
 
@@ -278,7 +279,20 @@ MYSQL_LOCK *mysql_lock_tables(THD *thd, TABLE **tables, uint count, uint flags)
     /* Clear the lock type of all lock data to avoid reusage. */
     reset_lock_data(sql_lock, 1);
     my_free(sql_lock);
-    sql_lock= 0;
+    DBUG_RETURN(NULL);
+  }
+
+  /*
+    Stored routines may be changed by writing to mysql.proc directly.
+    Readers of mysql.proc are blocked now, so routines they cache after
+    this point are read after the change.
+  */
+  for (uint i= 0; i < count; i++)
+  {
+    if (tables[i]->s->table_category == TABLE_CATEGORY_SYSTEM &&
+        tables[i]->reginfo.lock_type >= TL_WRITE_ALLOW_WRITE)
+      sp_cache_invalidate_table(tables[i]->s->db.str,
+                                tables[i]->s->table_name.str);
   }
   DBUG_RETURN(sql_lock);
 }
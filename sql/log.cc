@@ -2788,6 +2788,18 @@ bool MYSQL_QUERY_LOG::write(THD *thd, time_t current_time,
                       "Yes" : "No"),
                      thd->query_plan_fsort_passes) == (size_t) -1)
        tmp_errno= errno;
+     if ((thd->variables.log_slow_verbosity & LOG_SLOW_VERBOSITY_QUERY_PLAN) &&
+         thd->query_plan_range_opt_time)
+     {
+       char range_opt_time_buff[22+7];
+       sprintf(range_opt_time_buff, "%.6f",
+               ulonglong2double(thd->query_plan_range_opt_time)/1000000.0);
+       if (my_b_printf(&log_file,
+                       "# Range_opt_time: %s  Range_opt_memory: %lu\n",
+                       range_opt_time_buff,
+                       thd->query_plan_range_opt_memory) == (size_t) -1)
+         tmp_errno= errno;
+     }
     if (thd->db && strcmp(thd->db, db))
     {						// Database changed
       if (my_b_printf(&log_file,"use %s;\n",thd->db) == (size_t) -1)
@@ -52,6 +52,7 @@
 
 #include <base64.h>
 #include <my_bitmap.h>
+#include <zlib.h>
 #include "rpl_utility.h"
 
 
@@ -78,6 +79,70 @@ TYPELIB binlog_checksum_typelib=
 };
 
 
+/*
+  Layout of the compressed part of an event with LOG_EVENT_COMPRESSED_F:
+
+    1 byte   algorithm (BINLOG_COMPRESS_ZLIB)
+    4 bytes  length of the uncompressed data
+    rest     the compressed data
+*/
+#define BINLOG_COMPRESS_ZLIB 0
+#define BINLOG_COMPRESS_HEADER_LEN 5
+
+#ifndef MYSQL_CLIENT
+/* Size of the buffer binlog_buf_compress() needs for 'len' bytes */
+static size_t binlog_compress_bound(size_t len)
+{
+  return BINLOG_COMPRESS_HEADER_LEN + compressBound((uLong) len);
+}
+
+/*
+  Compress 'len' bytes of 'src' into 'dst', which has
+  binlog_compress_bound(len) bytes.
+
+  @retval 0  *dst_len bytes, less than len, were written to dst
+  @retval 1  the data does not compress
+*/
+static bool binlog_buf_compress(const uchar *src, size_t len, uchar *dst,
+                                size_t *dst_len)
+{
+  uLongf zlen= (uLongf) (binlog_compress_bound(len) -
+                         BINLOG_COMPRESS_HEADER_LEN);
+  if (compress((Bytef*) dst + BINLOG_COMPRESS_HEADER_LEN, &zlen,
+               (const Bytef*) src, (uLong) len) != Z_OK ||
+      zlen + BINLOG_COMPRESS_HEADER_LEN >= len)
+    return 1;
+  dst[0]= BINLOG_COMPRESS_ZLIB;
+  int4store(dst + 1, (uint32) len);
+  *dst_len= zlen + BINLOG_COMPRESS_HEADER_LEN;
+  return 0;
+}
+#endif
+
+/*
+  Get the uncompressed length of the data compressed by
+  binlog_buf_compress(); 1 if the data is not valid.
+*/
+static bool binlog_buf_uncompressed_len(const uchar *src, size_t len,
+                                        size_t *ulen)
+{
+  if (len < BINLOG_COMPRESS_HEADER_LEN || src[0] != BINLOG_COMPRESS_ZLIB)
+    return 1;
+  *ulen= uint4korr(src + 1);
+  return *ulen > MAX_MAX_ALLOWED_PACKET;
+}
+
+/* Uncompress the data into 'dst' of binlog_buf_uncompressed_len() bytes */
+static bool binlog_buf_uncompress(const uchar *src, size_t len, uchar *dst,
+                                  size_t ulen)
+{
+  uLongf dst_len= (uLongf) ulen;
+  return (uncompress((Bytef*) dst, &dst_len,
+                     (const Bytef*) src + BINLOG_COMPRESS_HEADER_LEN,
+                     (uLong) (len - BINLOG_COMPRESS_HEADER_LEN)) != Z_OK ||
+          dst_len != ulen);
+}
+
 
 #define log_cs	&my_charset_latin1
 
@@ -2363,19 +2428,26 @@ void Log_event::print_base64(IO_CACHE* file,
 {
   const uchar *ptr= (const uchar *)temp_buf;
   uint32 size= uint4korr(ptr + EVENT_LEN_OFFSET);
+  const char *base64_str= print_event_info->prepared_base64;
+  char *tmp_str= NULL;
   DBUG_ENTER("Log_event::print_base64");
 
-  size_t const tmp_str_sz= base64_needed_encoded_length((int) size);
-  char *const tmp_str= (char *) my_malloc(tmp_str_sz, MYF(MY_WME));
-  if (!tmp_str) {
-    fprintf(stderr, "\nError: Out of memory. "
-            "Could not print correct binlog event.\n");
-    DBUG_VOID_RETURN;
-  }
-
-  if (base64_encode(ptr, (size_t) size, tmp_str))
+  if (!base64_str &&
+      print_event_info->base64_output_mode != BASE64_OUTPUT_DECODE_ROWS)
   {
-    DBUG_ASSERT(0);
+    size_t const tmp_str_sz= base64_needed_encoded_length((int) size);
+    if (!(tmp_str= (char *) my_malloc(tmp_str_sz, MYF(MY_WME))))
+    {
+      fprintf(stderr, "\nError: Out of memory. "
+              "Could not print correct binlog event.\n");
+      DBUG_VOID_RETURN;
+    }
+
+    if (base64_encode(ptr, (size_t) size, tmp_str))
+    {
+      DBUG_ASSERT(0);
+    }
+    base64_str= tmp_str;
   }
 
   if (print_event_info->base64_output_mode != BASE64_OUTPUT_DECODE_ROWS)
@@ -2383,13 +2455,28 @@ void Log_event::print_base64(IO_CACHE* file,
     if (my_b_tell(file) == 0)
       my_b_printf(file, "\nBINLOG '\n");
 
-    my_b_printf(file, "%s\n", tmp_str);
+    my_b_printf(file, "%s\n", base64_str);
 
     if (!more)
       my_b_printf(file, "'%s\n", print_event_info->delimiter);
   }
   
-  if (print_event_info->verbose)
+  if (print_event_info->verbose && print_event_info->prepared_verbose &&
+      ptr[4] != TABLE_MAP_EVENT)
+  {
+    /* The rows were printed by a decode thread, copy them */
+    IO_CACHE *const rows= print_event_info->prepared_verbose;
+    if (!reinit_io_cache(rows, READ_CACHE, 0L, FALSE, FALSE))
+    {
+      size_t length= my_b_bytes_in_cache(rows);
+      do
+      {
+        my_b_write(file, rows->read_pos, length);
+        rows->read_pos= rows->read_end;
+      } while ((length= my_b_fill(rows)));
+    }
+  }
+  else if (print_event_info->verbose)
   {
     Rows_log_event *ev= NULL;
     if (checksum_alg != BINLOG_CHECKSUM_ALG_UNDEF &&
@@ -2749,20 +2836,42 @@ bool Query_log_event::write(IO_CACHE* file)
   DBUG_ASSERT(status_vars_len <= MAX_SIZE_LOG_EVENT_STATUS);
   int2store(buf + Q_STATUS_VARS_LEN_OFFSET, status_vars_len);
 
+  /*
+    Long statements are compressed with --log-bin-compress. Derived
+    events keep their query as it is.
+  */
+  uchar *query_buf= (uchar*) query, *compressed= 0;
+  size_t query_len= q_len;
+  flags&= ~LOG_EVENT_COMPRESSED_F;
+  if (opt_bin_log_compress && get_type_code() == QUERY_EVENT &&
+      q_len >= opt_bin_log_compress_min_len &&
+      (compressed= (uchar*) my_malloc(binlog_compress_bound(q_len), MYF(0))))
+  {
+    if (binlog_buf_compress((uchar*) query, q_len, compressed, &query_len))
+      query_len= q_len;
+    else
+    {
+      query_buf= compressed;
+      flags|= LOG_EVENT_COMPRESSED_F;
+    }
+  }
+
   /*
     Calculate length of whole event
     The "1" below is the \0 in the db's length
   */
-  event_length= (uint) (start-buf) + get_post_header_size_for_derived() + db_len + 1 + q_len;
-
-  return (write_header(file, event_length) ||
-          wrapper_my_b_safe_write(file, (uchar*) buf, QUERY_HEADER_LEN) ||
-          write_post_header_for_derived(file) ||
-          wrapper_my_b_safe_write(file, (uchar*) start_of_status,
-                          (uint) (start-start_of_status)) ||
-          wrapper_my_b_safe_write(file, (db) ? (uchar*) db : (uchar*)"", db_len + 1) ||
-          wrapper_my_b_safe_write(file, (uchar*) query, q_len) ||
-	  write_footer(file)) ? 1 : 0;
+  event_length= (uint) (start-buf) + get_post_header_size_for_derived() + db_len + 1 + query_len;
+
+  bool res= (write_header(file, event_length) ||
+             wrapper_my_b_safe_write(file, (uchar*) buf, QUERY_HEADER_LEN) ||
+             write_post_header_for_derived(file) ||
+             wrapper_my_b_safe_write(file, (uchar*) start_of_status,
+                             (uint) (start-start_of_status)) ||
+             wrapper_my_b_safe_write(file, (db) ? (uchar*) db : (uchar*)"", db_len + 1) ||
+             wrapper_my_b_safe_write(file, query_buf, query_len) ||
+             write_footer(file));
+  my_free(compressed);
+  return res;
 }
 
 /**
@@ -3264,6 +3373,19 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
     sql_parse.cc
     */
 
+  /* The query of a compressed event is uncompressed into data_buf */
+  ulong compressed_len= 0;
+  if (flags & LOG_EVENT_COMPRESSED_F)
+  {
+    size_t query_len;
+    if (data_len <= db_len ||
+        binlog_buf_uncompressed_len(end + db_len + 1, data_len - db_len - 1,
+                                    &query_len))
+      DBUG_VOID_RETURN;
+    compressed_len= data_len - db_len - 1;
+    data_len= db_len + 1 + query_len;
+  }
+
 #if !defined(MYSQL_CLIENT) && defined(HAVE_QUERY_CACHE)
   if (!(start= data_buf = (Log_event::Byte*) my_malloc(catalog_len + 1
                                                     +  time_zone_len + 1
@@ -3316,7 +3438,15 @@ Query_log_event::Query_log_event(const char* buf, uint event_len,
   */
 
   /* A 2nd variable part; this is common to all versions */ 
-  memcpy((char*) start, end, data_len);          // Copy db and query
+  if (compressed_len)
+  {
+    memcpy((char*) start, end, db_len + 1);
+    if (binlog_buf_uncompress(end + db_len + 1, compressed_len,
+                              start + db_len + 1, data_len - db_len - 1))
+      DBUG_VOID_RETURN;
+  }
+  else
+    memcpy((char*) start, end, data_len);          // Copy db and query
   start[data_len]= '\0';              // End query with \0 (For safetly)
   db= (char *)start;
   query= (char *)(start + db_len + 1);
@@ -8009,12 +8139,18 @@ Rows_log_event::Rows_log_event(THD *thd_arg, TABLE *tbl_arg, ulong tid,
     m_table(tbl_arg),
     m_table_id(tid),
     m_width(tbl_arg ? tbl_arg->s->fields : 1),
-    m_rows_buf(0), m_rows_cur(0), m_rows_end(0), m_flags(0) 
+    m_rows_buf(0), m_rows_cur(0), m_rows_end(0), m_flags(0),
+    m_rows_compressed(0), m_rows_compressed_len(0)
 #ifdef HAVE_REPLICATION
     , m_curr_row(NULL), m_curr_row_end(NULL),
-    m_key(NULL), m_key_info(NULL), m_key_nr(0)
+    m_key(NULL), m_key_info(NULL), m_key_nr(0),
+    m_located_rows(NULL), m_located_next(NULL),
+    m_locate_rows(FALSE), m_rows_scanned(FALSE), m_rows_ordered(FALSE)
 #endif
 {
+#ifdef HAVE_REPLICATION
+  my_hash_clear(&m_row_hash);
+#endif
   /*
     We allow a special form of dummy event when the table, and cols
     are null and the table id is ~0UL.  This is a temporary
@@ -8061,10 +8197,19 @@ Rows_log_event::Rows_log_event(const char *buf, uint event_len,
     m_table_id(0), m_rows_buf(0), m_rows_cur(0), m_rows_end(0)
 #if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
     , m_curr_row(NULL), m_curr_row_end(NULL),
-    m_key(NULL), m_key_info(NULL), m_key_nr(0)
+    m_key(NULL), m_key_info(NULL), m_key_nr(0),
+    m_located_rows(NULL), m_located_next(NULL),
+    m_locate_rows(FALSE), m_rows_scanned(FALSE), m_rows_ordered(FALSE)
 #endif
 {
   DBUG_ENTER("Rows_log_event::Rows_log_event(const char*,...)");
+#ifdef MYSQL_SERVER
+  m_rows_compressed= 0;
+  m_rows_compressed_len= 0;
+#endif
+#if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
+  my_hash_clear(&m_row_hash);
+#endif
   uint8 const common_header_len= description_event->common_header_len;
   uint8 const post_header_len= description_event->post_header_len[event_type-1];
 
@@ -8148,15 +8293,30 @@ Rows_log_event::Rows_log_event(const char *buf, uint event_len,
   DBUG_PRINT("info",("m_table_id: %lu  m_flags: %d  m_width: %lu  data_size: %lu",
                      m_table_id, m_flags, m_width, (ulong) data_size));
 
-  m_rows_buf= (uchar*) my_malloc(data_size, MYF(MY_WME));
+  if (flags & LOG_EVENT_COMPRESSED_F)
+  {
+    size_t rows_len= 0;
+    if (!binlog_buf_uncompressed_len(ptr_rows_data, data_size, &rows_len) &&
+        (m_rows_buf= (uchar*) my_malloc(rows_len, MYF(MY_WME))) &&
+        binlog_buf_uncompress(ptr_rows_data, data_size, m_rows_buf, rows_len))
+    {
+      my_free(m_rows_buf);
+      m_rows_buf= 0;
+    }
+    else if (m_rows_buf)
+      m_rows_end= m_rows_buf + rows_len;
+  }
+  else if ((m_rows_buf= (uchar*) my_malloc(data_size, MYF(MY_WME))))
+  {
+    memcpy(m_rows_buf, ptr_rows_data, data_size);
+    m_rows_end= m_rows_buf + data_size;
+  }
   if (likely((bool)m_rows_buf))
   {
 #if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
     m_curr_row= m_rows_buf;
 #endif
-    m_rows_end= m_rows_buf + data_size;
     m_rows_cur= m_rows_end;
-    memcpy(m_rows_buf, ptr_rows_data, data_size);
   }
   else
     m_cols.bitmap= 0; // to not free it
@@ -8190,6 +8350,10 @@ int Rows_log_event::get_data_size()
   if (type_code == UPDATE_ROWS_EVENT)
     data_size+= no_bytes_in_map(&m_cols_ai);
 
+#ifdef MYSQL_SERVER
+  if (m_rows_compressed)
+    return data_size + (uint) m_rows_compressed_len;
+#endif
   data_size+= (uint) (m_rows_cur - m_rows_buf);
   return data_size; 
 }
@@ -8254,6 +8418,134 @@ int Rows_log_event::do_add_row_data(uchar *row_data, size_t length)
 #endif
 
 #if !defined(MYSQL_CLIENT) && defined(HAVE_REPLICATION)
+/*
+  A row of the event sorted by order_rows().
+*/
+struct st_ordered_row
+{
+  const uchar *row;             /* Row (before image) in the event */
+  uchar *key;                   /* Primary key of the row */
+};
+
+
+static int cmp_ordered_rows(const void *arg, const void *a, const void *b)
+{
+  KEY *key= (KEY*) arg;
+  st_ordered_row *row_a= (st_ordered_row*) a;
+  st_ordered_row *row_b= (st_ordered_row*) b;
+  int res= key_tuple_cmp(key->key_part, row_a->key, row_b->key,
+                         key->key_length);
+  /* Rows with the same key are applied in the order of the event */
+  if (!res && row_a->row != row_b->row)
+    res= row_a->row < row_b->row ? -1 : 1;
+  return res;
+}
+
+
+/**
+  Sort the rows of the event by primary key.
+
+  Engines that store the rows in primary key order
+  (HA_PRIMARY_KEY_REQUIRED_FOR_POSITION) then read and write the rows of a
+  large event in the order of their pages instead of at random.
+
+  The rows are only sorted when this can not change the result: the table
+  must not be referenced by a foreign key, no row of an Update event may
+  change its primary key, a Write event must not replace rows, and the
+  table must not have other unique keys for Write and Update events.
+
+  @returns Error code on failure, 0 on success.
+*/
+int Rows_log_event::order_rows(const Relay_log_info *rli)
+{
+  TABLE *table= m_table;
+  Log_event_type type= get_type_code();
+  KEY *key= table->key_info + table->s->primary_key;
+  bool ordered= TRUE;
+  int error= 0;
+  DBUG_ENTER("Rows_log_event::order_rows");
+
+  if (!(table->file->ha_table_flags() & HA_PRIMARY_KEY_REQUIRED_FOR_POSITION) ||
+      table->s->primary_key >= MAX_KEY ||
+      table->file->referenced_by_foreign_key())
+    DBUG_RETURN(0);
+  if (type == WRITE_ROWS_EVENT &&
+      slave_exec_mode == SLAVE_EXEC_MODE_IDEMPOTENT)
+    DBUG_RETURN(0);
+  /*
+    The rows of an Update event may pass a unique value from one row to
+    another, which only works in the order of the event.
+  */
+  if (type != DELETE_ROWS_EVENT)
+  {
+    for (uint i= 0; i < table->s->keys; i++)
+    {
+      if (i != table->s->primary_key &&
+          (table->key_info[i].flags & HA_NOSAME))
+        DBUG_RETURN(0);
+    }
+  }
+
+  init_sql_alloc(&m_order_root, 8192, 0);
+  my_init_dynamic_array(&m_row_order, sizeof(st_ordered_row), 256, 256);
+  m_rows_ordered= TRUE;
+
+  for (m_curr_row= m_rows_buf; m_curr_row < m_rows_end && ordered; )
+  {
+    st_ordered_row row;
+    prepare_record(table, m_width, FALSE);
+    if ((error= unpack_current_row(rli)))
+      break;
+    row.row= m_curr_row;
+    if (!(row.key= (uchar*) alloc_root(&m_order_root, key->key_length)) ||
+        insert_dynamic(&m_row_order, (uchar*) &row))
+    {
+      error= HA_ERR_OUT_OF_MEM;
+      break;
+    }
+    key_copy(row.key, table->record[0], key, 0);
+
+    m_curr_row= m_curr_row_end;
+    if (type == UPDATE_ROWS_EVENT)
+    {
+      if ((error= unpack_current_row(rli)))
+        break;
+      if (key_cmp(key->key_part, row.key, key->key_length))
+        ordered= FALSE;
+      m_curr_row= m_curr_row_end;
+    }
+  }
+
+  if (error || !ordered || m_row_order.elements < 2)
+  {
+    end_order_rows();
+    m_curr_row= m_rows_buf;
+    DBUG_RETURN(error);
+  }
+
+  my_qsort2(m_row_order.buffer, m_row_order.elements, sizeof(st_ordered_row),
+            cmp_ordered_rows, key);
+  m_row_order_next= 0;
+  m_curr_row= dynamic_element(&m_row_order, 0, st_ordered_row*)->row;
+  m_curr_row_end= NULL;
+  if (type == WRITE_ROWS_EVENT)
+    table->file->ha_start_bulk_insert(m_row_order.elements);
+  DBUG_PRINT("info", ("%u rows sorted by primary key", m_row_order.elements));
+  DBUG_RETURN(0);
+}
+
+
+void Rows_log_event::end_order_rows()
+{
+  if (m_rows_ordered)
+  {
+    delete_dynamic(&m_row_order);
+    free_root(&m_order_root, MYF(0));
+    m_rows_ordered= FALSE;
+  }
+}
+
+
 int Rows_log_event::do_apply_event(Relay_log_info const *rli)
 {
   DBUG_ENTER("Rows_log_event::do_apply_event(Relay_log_info*)");
@@ -8490,6 +8782,8 @@ int Rows_log_event::do_apply_event(Relay_log_info const *rli)
 
     // Do event specific preparations 
     error= do_before_row_operations(rli);
+    if (!error)
+      error= order_rows(rli);
 
     /*
       Bug#56662 Assertion failed: next_insert_id == 0, file handler.cc
@@ -8561,13 +8855,21 @@ int Rows_log_event::do_apply_event(Relay_log_info const *rli)
       DBUG_ASSERT(error || m_curr_row < m_curr_row_end);
       DBUG_ASSERT(error || m_curr_row_end <= m_rows_end);
   
-      m_curr_row= m_curr_row_end;
+      if (!m_rows_ordered)
+        m_curr_row= m_curr_row_end;
+      else if (++m_row_order_next < m_row_order.elements)
+        m_curr_row= dynamic_element(&m_row_order, m_row_order_next,
+                                    st_ordered_row*)->row;
+      else
+        m_curr_row= m_rows_end;
  
       if (error == 0 && !transactional_table)
         thd->transaction.all.modified_non_trans_table=
           thd->transaction.stmt.modified_non_trans_table= TRUE;
     } // row processing loop
 
+    end_order_rows();
+
     /*
       Restore the sql_mode after the rows event is processed.
     */
@@ -8797,12 +9099,44 @@ bool Rows_log_event::write_data_body(IO_CACHE*file)
     res= res || wrapper_my_b_safe_write(file, (uchar*) m_cols_ai.bitmap,
                                 no_bytes_in_map(&m_cols_ai));
   }
+  if (m_rows_compressed)
+    return res || wrapper_my_b_safe_write(file, m_rows_compressed,
+                                          m_rows_compressed_len);
   DBUG_DUMP("rows", m_rows_buf, data_size);
   res= res || wrapper_my_b_safe_write(file, m_rows_buf, (size_t) data_size);
 
   return res;
 
 }
+
+/*
+  Write the event, with its rows compressed if --log-bin-compress is set
+  and they are at least --log-bin-compress-min-len bytes long.
+*/
+bool Rows_log_event::write(IO_CACHE *file)
+{
+  size_t const data_size= m_rows_cur - m_rows_buf;
+  bool res;
+
+  flags&= ~LOG_EVENT_COMPRESSED_F;
+  if (opt_bin_log_compress && data_size >= opt_bin_log_compress_min_len &&
+      (m_rows_compressed= (uchar*) my_malloc(binlog_compress_bound(data_size),
+                                             MYF(0))))
+  {
+    if (binlog_buf_compress(m_rows_buf, data_size, m_rows_compressed,
+                            &m_rows_compressed_len))
+    {
+      my_free(m_rows_compressed);
+      m_rows_compressed= 0;
+    }
+    else
+      flags|= LOG_EVENT_COMPRESSED_F;
+  }
+  res= Log_event::write(file);
+  my_free(m_rows_compressed);
+  m_rows_compressed= 0;
+  return res;
+}
 #endif
 
 #if defined(HAVE_REPLICATION) && !defined(MYSQL_CLIENT)
@@ -8824,20 +9158,29 @@ void Rows_log_event::print_helper(FILE *file,
 {
   IO_CACHE *const head= &print_event_info->head_cache;
   IO_CACHE *const body= &print_event_info->body_cache;
+  bool const last_stmt_event= get_flags(STMT_END_F);
+  /*
+    The BINLOG statement is ended after the last event of a statement,
+    or of the last statement of a batch (see mysqlbinlog
+    --batch-row-statements).
+  */
+  bool const last_batch_event= last_stmt_event &&
+    ++print_event_info->batched_statements >=
+      print_event_info->batch_statements;
   if (!print_event_info->short_form)
   {
-    bool const last_stmt_event= get_flags(STMT_END_F);
-    print_header(head, print_event_info, !last_stmt_event);
+    print_header(head, print_event_info, !last_batch_event);
     my_b_printf(head, "\t%s: table id %lu%s\n",
                 name, m_table_id,
                 last_stmt_event ? " flags: STMT_END_F" : "");
-    print_base64(body, print_event_info, !last_stmt_event);
+    print_base64(body, print_event_info, !last_batch_event);
   }
 
-  if (get_flags(STMT_END_F))
+  if (last_batch_event)
   {
     copy_event_cache_to_file_and_reinit(head, file);
     copy_event_cache_to_file_and_reinit(body, file);
+    print_event_info->batched_statements= 0;
   }
 }
 #endif
@@ -9920,7 +10263,7 @@ Rows_log_event::write_row(const Relay_log_info *const rli,
   if ((error= unpack_current_row(rli)))
     DBUG_RETURN(error);
 
-  if (m_curr_row == m_rows_buf)
+  if (m_curr_row == m_rows_buf && !m_rows_ordered)
   {
     /* this is the first row to be inserted, we estimate the rows with
        the size of the first row and use that value to initialize
@@ -10315,11 +10658,21 @@ int Rows_log_event::find_key()
     }
   }
 
+  /*
+    Rows are located by one scan of the table or, for a key that does not
+    identify a row, one scan of the index for each key value (locate_row()).
+    BLACKHOLE pretends to find every row it is asked for, so it can not be
+    scanned for them.
+  */
+  m_locate_rows= m_table->file->ht->db_type != DB_TYPE_BLACKHOLE_DB;
+
   if (best_key_nr == MAX_KEY)
   {
     m_key_info= NULL;
     DBUG_RETURN(0);
   }
+  if ((best_key->flags & (HA_NOSAME | HA_NULL_PART_KEY)) == HA_NOSAME)
+    m_locate_rows= FALSE;
 
   // Allocate buffer for key searches
   m_key= (uchar *) my_malloc(best_key->key_length, MYF(MY_WME));
@@ -10378,6 +10731,321 @@ void issue_long_find_row_warning(Log_event_type type,
 }
 
 
+/*
+  A row of an Update or Delete event located by locate_row().
+*/
+struct st_located_row
+{
+  ulong hash;                   /* record_hash() of the before image */
+  ulong after_hash;             /* record_hash() of the after image */
+  const uchar *row;             /* Before image in the event */
+  uchar *ref;                   /* Position of the row found */
+  bool found, searched;
+  st_located_row *next;
+};
+
+
+/*
+  Hash of the fields of table->record[0].
+
+  Records for which record_compare() finds no difference have the same
+  hash.
+*/
+static ulong record_hash(TABLE *table)
+{
+  ulong nr= 1, nr2= 4;
+  for (Field **ptr= table->field ; *ptr ; ptr++)
+  {
+    Field *field= *ptr;
+    if (!field->is_null() && (field->flags & BLOB_FLAG))
+    {
+      /* Field::hash() would hash the pointer to the blob */
+      Field_blob *blob= (Field_blob*) field;
+      uchar *data;
+      blob->get_ptr(&data);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, data,
+                                     blob->get_length(), &nr, &nr2);
+    }
+    else
+      field->hash(&nr, &nr2);
+  }
+  return nr;
+}
+
+
+/**
+  Read the before images of the event for locate_row().
+
+  The before image of every row is hashed with record_hash(), so that
+  the rows can be matched against the rows of a single scan of the table,
+  instead of scanning the table once for every row.
+
+  Rows are not located this way when an after image of an Update event
+  could be matched by a later before image (the same row changed more
+  than once by the event, e.g. by a trigger on the master): they have to
+  be found one by one, after the earlier changes.
+
+  @returns Error code on failure, 0 on success.
+*/
+int Rows_log_event::init_locate_rows(const Relay_log_info *rli)
+{
+  TABLE *table= m_table;
+  const uchar *saved_row= m_curr_row;
+  st_located_row **last= &m_located_rows;
+  uint count= 0;
+  int error= 0;
+  DBUG_ENTER("Rows_log_event::init_locate_rows");
+
+  init_sql_alloc(&m_locate_root, 8192, 0);
+  for (m_curr_row= m_rows_buf; m_curr_row < m_rows_end; count++)
+  {
+    st_located_row *row;
+    prepare_record(table, m_width, FALSE);
+    if ((error= unpack_current_row(rli)))
+      break;
+    if (!(row= (st_located_row*) alloc_root(&m_locate_root,
+                                            sizeof(st_located_row) +
+                                            table->file->ref_length)))
+    {
+      error= HA_ERR_OUT_OF_MEM;
+      break;
+    }
+    row->hash= record_hash(table);
+    row->row= m_curr_row;
+    row->ref= (uchar*) (row + 1);
+    row->found= row->searched= FALSE;
+    row->next= NULL;
+    *last= row;
+    last= &row->next;
+
+    m_curr_row= m_curr_row_end;
+    if (get_type_code() == UPDATE_ROWS_EVENT)
+    {
+      if ((error= unpack_current_row(rli)))
+        break;
+      row->after_hash= record_hash(table);
+      m_curr_row= m_curr_row_end;
+    }
+  }
+
+  if (!error &&
+      my_hash_init(&m_row_hash, &my_charset_bin, count,
+                   offsetof(st_located_row, hash), sizeof(ulong), 0, 0, 0))
+    error= HA_ERR_OUT_OF_MEM;
+  for (st_located_row *row= m_located_rows; row && !error; row= row->next)
+  {
+    if (my_hash_insert(&m_row_hash, (uchar*) row))
+      error= HA_ERR_OUT_OF_MEM;
+  }
+  if (!error && get_type_code() == UPDATE_ROWS_EVENT)
+  {
+    for (st_located_row *row= m_located_rows; row; row= row->next)
+    {
+      if (my_hash_search(&m_row_hash, (uchar*) &row->after_hash,
+                         sizeof(ulong)))
+      {
+        DBUG_PRINT("info", ("rows changed more than once, not located"));
+        end_locate_rows();
+        break;
+      }
+    }
+  }
+
+  m_located_next= m_located_rows;
+  m_curr_row= saved_row;
+  DBUG_RETURN(error);
+}
+
+
+void Rows_log_event::end_locate_rows()
+{
+  if (my_hash_inited(&m_row_hash))
+  {
+    my_hash_free(&m_row_hash);
+    free_root(&m_locate_root, MYF(0));
+  }
+  m_located_rows= m_located_next= NULL;
+  m_locate_rows= m_rows_scanned= FALSE;
+}
+
+
+/**
+  Match the row in table->record[0] against the before images not found
+  yet, and remember its position for the first one that is equal.
+
+  @returns Error code on failure, 0 on success.
+
+  @post table->record[0] contains the row again.
+*/
+int Rows_log_event::match_located_row(const Relay_log_info *rli)
+{
+  TABLE *table= m_table;
+  ulong hash= record_hash(table);
+  HASH_SEARCH_STATE state;
+  st_located_row *row;
+  int error= 0;
+
+  store_record(table, record[1]);
+  for (row= (st_located_row*) my_hash_first(&m_row_hash, (uchar*) &hash,
+                                            sizeof(ulong), &state);
+       row;
+       row= (st_located_row*) my_hash_next(&m_row_hash, (uchar*) &hash,
+                                           sizeof(ulong), &state))
+  {
+    m_curr_row= row->row;
+    prepare_record(table, m_width, FALSE);
+    if ((error= unpack_current_row(rli)))
+      break;
+    if (!record_compare(table))
+    {
+      restore_record(table, record[1]);
+      table->file->position(table->record[0]);
+      memcpy(row->ref, table->file->ref, table->file->ref_length);
+      row->found= TRUE;
+      my_hash_delete(&m_row_hash, (uchar*) row);
+      break;
+    }
+  }
+  restore_record(table, record[1]);
+  return error;
+}
+
+
+/**
+  Scan the table, or the index for the key of the current row, for the
+  rows of the event.
+
+  @returns Error code on failure, 0 on success.
+*/
+int Rows_log_event::scan_located_rows(const Relay_log_info *rli)
+{
+  TABLE *table= m_table;
+  int error;
+  DBUG_ENTER("Rows_log_event::scan_located_rows");
+
+  if (m_key_info)
+  {
+    DBUG_PRINT("info",("locating rows using key #%u [%s] (index_read)",
+                       m_key_nr, m_key_info->name));
+    m_located_next->searched= TRUE;
+    key_copy(m_key, table->record[0], m_key_info, 0);
+    if ((error= table->file->ha_index_init(m_key_nr, FALSE)))
+    {
+      table->file->print_error(error, MYF(0));
+      DBUG_RETURN(error);
+    }
+    error= table->file->ha_index_read_map(table->record[0], m_key,
+                                          HA_WHOLE_KEY, HA_READ_KEY_EXACT);
+    while ((!error || error == HA_ERR_RECORD_DELETED) &&
+           m_row_hash.records)
+    {
+      if (!error && (error= match_located_row(rli)))
+        break;
+      error= table->file->ha_index_next_same(table->record[0], m_key,
+                                             m_key_info->key_length);
+    }
+  }
+  else
+  {
+    DBUG_PRINT("info",("locating rows using table scan (rnd_next)"));
+    m_rows_scanned= TRUE;
+    if ((error= table->file->ha_rnd_init_with_error(1)))
+      DBUG_RETURN(error);
+    error= table->file->ha_rnd_next(table->record[0]);
+    while ((!error || error == HA_ERR_RECORD_DELETED) &&
+           m_row_hash.records)
+    {
+      if (!error && (error= match_located_row(rli)))
+        break;
+      error= table->file->ha_rnd_next(table->record[0]);
+    }
+  }
+  table->file->ha_index_or_rnd_end();
+
+  if (error == HA_ERR_END_OF_FILE || error == HA_ERR_KEY_NOT_FOUND ||
+      error == HA_ERR_RECORD_DELETED)
+    error= 0;
+  else if (error)
+    table->file->print_error(error, MYF(0));
+  DBUG_RETURN(error);
+}
+
+
+/**
+  Locate the current row, which is unpacked in table->record[0], among the
+  rows found by scan_located_rows().
+
+  The first row of the event not found yet starts a scan of the table, or
+  of the index for its key value, that locates all the rows it can.
+
+  @returns Error code on failure, 0 on success.
+
+  @post In case of success @c m_table->record[0] contains the record found
+  and the table is positioned on it, as after find_row().
+*/
+int Rows_log_event::locate_row(const Relay_log_info *rli)
+{
+  TABLE *table= m_table;
+  const uchar *curr_row= m_curr_row;
+  int error;
+  DBUG_ENTER("Rows_log_event::locate_row");
+
+  if (!my_hash_inited(&m_row_hash))
+  {
+    if ((error= init_locate_rows(rli)))
+      DBUG_RETURN(error);
+    /* Unpack the current row again */
+    prepare_record(table, m_width, FALSE);
+    if ((error= unpack_current_row(rli)))
+      DBUG_RETURN(error);
+    if (!m_locate_rows)
+      DBUG_RETURN(-1);
+  }
+
+  /* The rows are applied in the order of the event */
+  while (m_located_next && m_located_next->row < curr_row)
+    m_located_next= m_located_next->next;
+  if (!m_located_next || m_located_next->row != curr_row)
+  {
+    my_error(ER_SLAVE_CORRUPT_EVENT, MYF(0));
+    DBUG_RETURN(HA_ERR_CORRUPT_EVENT);
+  }
+
+  if (!m_located_next->found &&
+      !(m_key_info ? m_located_next->searched : m_rows_scanned))
+  {
+    error= scan_located_rows(rli);
+    /* Unpack the current row again */
+    m_curr_row= curr_row;
+    prepare_record(table, m_width, FALSE);
+    if (!error)
+      error= unpack_current_row(rli);
+    if (error)
+      DBUG_RETURN(error);
+  }
+
+  if (!m_located_next->found)
+  {
+    DBUG_PRINT("info", ("Record not found"));
+    error= m_key_info ? HA_ERR_KEY_NOT_FOUND : HA_ERR_END_OF_FILE;
+    table->file->print_error(error, MYF(0));
+    DBUG_RETURN(error);
+  }
+
+  if ((error= table->file->ha_rnd_init_with_error(0)))
+    DBUG_RETURN(error);
+  if ((error= table->file->ha_rnd_pos(table->record[0],
+                                      m_located_next->ref)))
+  {
+    if (error == HA_ERR_RECORD_DELETED)
+      error= HA_ERR_KEY_NOT_FOUND;
+    table->file->print_error(error, MYF(0));
+    table->file->ha_rnd_end();
+  }
+  DBUG_RETURN(error);
+}
+
+
 /**
   Locate the current row in event's table.
 
@@ -10476,6 +11144,19 @@ int Rows_log_event::find_row(const Relay_log_info *rli)
    */
   table->use_all_columns();
 
+  if (m_locate_rows)
+  {
+    if (m_key_info)
+      is_index_scan= true;
+    else
+      is_table_scan= true;
+    /* -1 means the rows are searched one by one after all */
+    if ((error= locate_row(rli)) != -1)
+      goto end;
+    is_index_scan= is_table_scan= false;
+    error= 0;
+  }
+
   /*
     Save copy of the record in table->record[1]. It might be needed 
     later if linear search is used to find exact match.
@@ -10756,6 +11437,7 @@ Delete_rows_log_event::do_after_row_operations(const Slave_reporting_capability
   my_free(m_key);
   m_key= NULL;
   m_key_info= NULL;
+  end_locate_rows();
 
   return error;
 }
@@ -10883,6 +11565,7 @@ Update_rows_log_event::do_after_row_operations(const Slave_reporting_capability
   my_free(m_key); // Free for multi_malloc
   m_key= NULL;
   m_key_info= NULL;
+  end_locate_rows();
 
   return error;
 }
@@ -11095,7 +11778,9 @@ st_print_event_info::st_print_event_info()
    lc_time_names_number(~0),
    charset_database_number(ILLEGAL_CHARSET_INFO_NUMBER),
    thread_id(0), thread_id_printed(false), skip_replication(0),
-   base64_output_mode(BASE64_OUTPUT_UNSPEC), printed_fd_event(FALSE)
+   base64_output_mode(BASE64_OUTPUT_UNSPEC), printed_fd_event(FALSE),
+   batch_statements(1), batched_statements(0),
+   prepared_base64(NULL), prepared_verbose(NULL)
 {
   /*
     Currently we only use static PRINT_EVENT_INFO objects, so zeroed at
@@ -522,6 +522,15 @@ struct sql_ex_info
 */
 #define LOG_EVENT_SKIP_REPLICATION_F 0x8000
 
+/**
+   @def LOG_EVENT_COMPRESSED_F
+
+   The rows of a Rows_log_event, or the query of a Query_log_event, are
+   compressed (see --log-bin-compress). Like LOG_EVENT_SKIP_REPLICATION_F
+   this is a MariaDB flag allocated from the end of the available values.
+*/
+#define LOG_EVENT_COMPRESSED_F 0x4000
+
 
 /**
   @def OPTIONS_WRITTEN_TO_BIN_LOG
@@ -754,6 +763,20 @@ typedef struct st_print_event_info
   table_mapping m_table_map;
   table_mapping m_table_map_ignored;
 
+  /*
+    Row events of up to batch_statements statements are printed as one
+    BINLOG statement; batched_statements counts those not yet printed.
+  */
+  uint batch_statements;
+  uint batched_statements;
+
+  /*
+    Base64 text and verbose rows of the event being printed, when they
+    were prepared ahead by a mysqlbinlog decode thread; NULL otherwise.
+  */
+  const char *prepared_base64;
+  IO_CACHE *prepared_verbose;
+
   /*
      These two caches are used by the row-based replication events to
      collect the header information and the main body of the events
@@ -3824,6 +3847,7 @@ public:
   ulong get_table_id() const        { return m_table_id; }
 
 #ifdef MYSQL_SERVER
+  virtual bool write(IO_CACHE *file);
   virtual bool write_data_header(IO_CACHE *file);
   virtual bool write_data_body(IO_CACHE *file);
   virtual const char *get_db() { return m_table->s->db.str; }
@@ -3889,6 +3913,12 @@ protected:
 
   flag_set m_flags;		/* Flags for row-level events */
 
+#ifdef MYSQL_SERVER
+  /* The rows compressed while the event is written, see write() */
+  uchar    *m_rows_compressed;
+  size_t    m_rows_compressed_len;
+#endif
+
   /* helper functions */
 
 #if defined(MYSQL_SERVER) && defined(HAVE_REPLICATION)
@@ -3898,8 +3928,34 @@ protected:
   KEY      *m_key_info; /* Pointer to KEY info for m_key_nr */
   uint      m_key_nr;   /* Key number */
 
+  /*
+    Before images of an Update or Delete event located by one scan of the
+    table or of m_key_nr (locate_row()), in the order of the event.
+  */
+  struct st_located_row *m_located_rows, *m_located_next;
+  HASH      m_row_hash; /* Rows not found yet, by record_hash() */
+  MEM_ROOT  m_locate_root;
+  bool      m_locate_rows;  /* Locate rows by scan instead of find_row() */
+  bool      m_rows_scanned; /* Table scan for the rows done */
+
+  /*
+    Rows of the event in the order they are applied, when order_rows()
+    sorted them by primary key.
+  */
+  DYNAMIC_ARRAY m_row_order;
+  MEM_ROOT  m_order_root;
+  uint      m_row_order_next;
+  bool      m_rows_ordered;
+
   int find_key(); // Find a best key to use in find_row()
   int find_row(const Relay_log_info *const);
+  int init_locate_rows(const Relay_log_info *const);
+  int match_located_row(const Relay_log_info *const);
+  int scan_located_rows(const Relay_log_info *const);
+  int locate_row(const Relay_log_info *const);
+  void end_locate_rows();
+  int order_rows(const Relay_log_info *const);
+  void end_order_rows();
   int write_row(const Relay_log_info *const, const bool);
 
   // Unpack the current row into m_table->record[0]
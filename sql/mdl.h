@@ -113,6 +113,19 @@ enum enum_mdl_type {
     SELECT ... FOR UPDATE.
   */
   MDL_SHARED_WRITE,
+  /*
+    An upgradable shared metadata lock which allows concurrent updates and
+    reads of table data.
+    A connection holding this kind of lock can read table metadata and read
+    table data. It should not modify data as this lock is compatible with
+    SR and SW locks.
+    Can be upgraded to X metadata lock.
+    Not compatible with another SU lock, so at most one connection can
+    prepare to upgrade the lock.
+    To be used for the copy phase of ALTER ONLINE TABLE, which is entered
+    by downgrading the SNW lock taken when the table was opened.
+  */
+  MDL_SHARED_UPGRADABLE,
   /*
     An upgradable shared metadata lock which blocks all attempts to update
     table data, allowing reads.
@@ -493,6 +506,7 @@ public:
   enum_mdl_type get_type() const { return m_type; }
   MDL_lock *get_lock() const { return m_lock; }
   void downgrade_exclusive_lock(enum_mdl_type type);
+  void downgrade_lock(enum_mdl_type type);
 
   bool has_stronger_or_equal_type(enum_mdl_type type) const;
 
@@ -146,9 +146,13 @@ extern ulonglong thd_startup_options;
 extern ulong thread_id;
 extern ulong binlog_cache_use, binlog_cache_disk_use;
 extern ulong binlog_stmt_cache_use, binlog_stmt_cache_disk_use;
+extern ulong binlog_tail_cache_size;
+extern ulong binlog_tail_cache_hits, binlog_tail_cache_fills;
+extern ulong slave_event_queue_size, slave_event_queue_hits;
 extern ulong aborted_threads,aborted_connects;
 extern ulong delayed_insert_timeout;
 extern ulong delayed_insert_limit, delayed_queue_size;
+extern ulong delayed_insert_max_latency, delayed_insert_batches;
 extern ulong delayed_insert_threads, delayed_insert_writes;
 extern ulong delayed_rows_in_use,delayed_insert_errors;
 extern ulong slave_open_temp_tables;
@@ -231,8 +235,8 @@ extern PSI_mutex_key key_BINLOG_LOCK_index, key_BINLOG_LOCK_prep_xids,
   key_LOCK_connection_count, key_LOCK_crypt, key_LOCK_delayed_create,
   key_LOCK_delayed_insert, key_LOCK_delayed_status, key_LOCK_error_log,
   key_LOCK_gdl, key_LOCK_global_system_variables,
-  key_LOCK_logger, key_LOCK_manager,
-  key_LOCK_prepared_stmt_count,
+  key_LOCK_load_read_ahead, key_LOCK_logger, key_LOCK_manager,
+  key_LOCK_online_alter_log, key_LOCK_prepared_stmt_count,
   key_LOCK_rpl_status, key_LOCK_server_started, key_LOCK_status,
   key_LOCK_table_share, key_LOCK_thd_data,
   key_LOCK_user_conn, key_LOG_LOCK_log,
@@ -260,6 +264,7 @@ extern PSI_cond_key key_PAGE_cond, key_COND_active, key_COND_pool;
 extern PSI_cond_key key_BINLOG_COND_prep_xids, key_BINLOG_update_cond,
   key_COND_cache_status_changed, key_COND_manager,
   key_COND_rpl_status, key_COND_server_started,
+  key_COND_load_read_ahead,
   key_delayed_insert_cond, key_delayed_insert_cond_client,
   key_item_func_sleep_cond, key_master_info_data_cond,
   key_master_info_start_cond, key_master_info_stop_cond,
@@ -274,7 +279,8 @@ extern PSI_cond_key key_RELAYLOG_COND_queue_busy;
 extern PSI_cond_key key_TC_LOG_MMAP_COND_queue_busy;
 
 extern PSI_thread_key key_thread_bootstrap, key_thread_delayed_insert,
-  key_thread_handle_manager, key_thread_kill_server, key_thread_main,
+  key_thread_handle_manager, key_thread_kill_server,
+  key_thread_load_read_ahead, key_thread_main,
   key_thread_one_connection, key_thread_signal_hand;
 
 extern PSI_file_key key_file_binlog, key_file_binlog_index, key_file_casetest,
@@ -545,6 +551,8 @@ extern ulong thread_created;
 extern scheduler_functions *thread_scheduler, *extra_thread_scheduler;
 extern char *opt_log_basename;
 extern my_bool opt_master_verify_checksum;
+extern my_bool opt_bin_log_compress;
+extern ulong opt_bin_log_compress_min_len;
 extern my_bool opt_stack_trace;
 extern my_bool opt_expect_abort;
 extern my_bool opt_slave_sql_verify_checksum;
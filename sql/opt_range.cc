@@ -118,6 +118,7 @@
 #include <m_ctype.h>
 #include "sql_select.h"
 #include "filesort.h"         // filesort_free_buffers
+#include <my_bit.h>           // my_bit_log2
 
 #ifndef EXTRA_DEBUG
 #define test_rb_tree(A,B) {}
@@ -358,6 +359,15 @@ public:
      elements(1),use_count(1),left(0),right(0),
      next_key_part(0), color(BLACK), type(type_arg)
   {}
+  using Sql_alloc::operator new;
+  using Sql_alloc::operator delete;
+  /*
+    Allocate a SEL_ARG from the pool of objects released during this range
+    analysis, or from param->mem_root if the pool is empty.
+  */
+  static void *operator new(size_t size, RANGE_OPT_PARAM *param) throw ();
+  static void operator delete(void *ptr, RANGE_OPT_PARAM *param)
+  { /* never called */ }
   inline bool is_same(SEL_ARG *arg)
   {
     if (type != arg->type || part != arg->part)
@@ -844,6 +854,19 @@ public:
   /* Number of SEL_ARG objects allocated by SEL_ARG::clone_tree operations */
   uint alloced_sel_args; 
 
+  /*
+    SEL_ARG objects that are no longer referenced from any SEL_ARG graph,
+    linked through SEL_ARG::next. They are reused by
+    SEL_ARG::operator new(size_t, RANGE_OPT_PARAM*).
+  */
+  SEL_ARG *free_sel_args;
+
+  void release_sel_arg(SEL_ARG *arg)
+  {
+    arg->next= free_sel_args;
+    free_sel_args= arg;
+  }
+
   bool force_default_mrr;
   KEY_PART *key[MAX_KEY]; /* First key parts of keys used in the query */
 
@@ -889,6 +912,7 @@ class TABLE_READ_PLAN;
   class TRP_INDEX_INTERSECT;
   class TRP_INDEX_MERGE;
   class TRP_GROUP_MIN_MAX;
+  class TRP_SKIP_SCAN;
 
 struct st_index_scan_info;
 struct st_ror_scan_info;
@@ -935,6 +959,9 @@ TABLE_READ_PLAN *merge_same_index_scans(PARAM *param, SEL_IMERGE *imerge,
 static
 TRP_GROUP_MIN_MAX *get_best_group_min_max(PARAM *param, SEL_TREE *tree,
                                           double read_time);
+static
+TRP_SKIP_SCAN *get_best_skip_scan(PARAM *param, SEL_TREE *tree,
+                                  double read_time);
 
 #ifndef DBUG_OFF
 static void print_sel_tree(PARAM *param, SEL_TREE *tree, key_map *tree_map,
@@ -2384,6 +2411,18 @@ QUICK_RANGE::QUICK_RANGE()
   min_keypart_map(0), max_keypart_map(0)
 {}
 
+void *SEL_ARG::operator new(size_t size, RANGE_OPT_PARAM *param) throw ()
+{
+  SEL_ARG *arg;
+  if ((arg= param->free_sel_args))
+  {
+    param->free_sel_args= arg->next;
+    return arg;
+  }
+  return alloc_root(param->mem_root, size);
+}
+
+
 SEL_ARG::SEL_ARG(SEL_ARG &arg) :Sql_alloc()
 {
   type=arg.type;
@@ -2443,7 +2482,7 @@ SEL_ARG *SEL_ARG::clone(RANGE_OPT_PARAM *param, SEL_ARG *new_parent,
 
   if (type != KEY_RANGE)
   {
-    if (!(tmp= new (param->mem_root) SEL_ARG(type)))
+    if (!(tmp= new (param) SEL_ARG(type)))
       return 0;					// out of memory
     tmp->prev= *next_arg;			// Link into next/prev chain
     (*next_arg)->next=tmp;
@@ -2452,8 +2491,8 @@ SEL_ARG *SEL_ARG::clone(RANGE_OPT_PARAM *param, SEL_ARG *new_parent,
   }
   else
   {
-    if (!(tmp= new (param->mem_root) SEL_ARG(field,part, min_value,max_value,
-                                             min_flag, max_flag, maybe_flag)))
+    if (!(tmp= new (param) SEL_ARG(field,part, min_value,max_value,
+                                   min_flag, max_flag, maybe_flag)))
       return 0;					// OOM
     tmp->parent=new_parent;
     tmp->next_key_part=next_key_part;
@@ -2778,6 +2817,35 @@ public:
 };
 
 
+/*
+  Plan for a QUICK_SKIP_SCAN_SELECT scan.
+  QUICK_SKIP_SCAN_SELECT fetches full rows unless the index is covering, in
+  which case the join optimizer enables key-only reads itself, so
+  make_quick() ignores retrieve_full_rows.
+*/
+
+class TRP_SKIP_SCAN : public TABLE_READ_PLAN
+{
+private:
+  KEY *index_info;
+  uint index;
+  uint prefix_len;       /* Length of the skipped key prefix */
+  uint prefix_key_parts; /* Number of keyparts in the skipped prefix */
+  SEL_ARG *range_tree;   /* Intervals over the first keypart after prefix */
+public:
+  TRP_SKIP_SCAN(KEY *index_info_arg, uint index_arg, uint prefix_len_arg,
+                uint prefix_key_parts_arg, SEL_ARG *range_tree_arg)
+  : index_info(index_info_arg), index(index_arg),
+    prefix_len(prefix_len_arg), prefix_key_parts(prefix_key_parts_arg),
+    range_tree(range_tree_arg)
+  {}
+  virtual ~TRP_SKIP_SCAN() {}                 /* Remove gcc warning */
+
+  QUICK_SELECT_I *make_quick(PARAM *param, bool retrieve_full_rows,
+                             MEM_ROOT *parent_alloc);
+};
+
+
 typedef struct st_index_scan_info
 {
   uint      idx;      /* # of used key in param->keys */
@@ -2853,6 +2921,24 @@ static int fill_used_fields_bitmap(PARAM *param)
 }
 
 
+/*
+  Get the total size of the blocks allocated by a MEM_ROOT
+
+  NOTE
+    Used to report the memory consumed by range analysis in the slow log.
+*/
+
+static size_t mem_root_allocated_size(MEM_ROOT *root)
+{
+  size_t size= 0;
+  for (USED_MEM *block= root->free; block; block= block->next)
+    size+= block->size;
+  for (USED_MEM *block= root->used; block; block= block->next)
+    size+= block->size;
+  return size;
+}
+
+
 /*
   Test if a key can be used in different ranges
 
@@ -2961,6 +3047,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
     KEY_PART *key_parts;
     KEY *key_info;
     PARAM param;
+    ulonglong range_opt_start;
 
     if (check_stack_overrun(thd, 2*STACK_MIN_SIZE + sizeof(PARAM), buff))
       DBUG_RETURN(0);                           // Fatal error flag is set
@@ -2981,6 +3068,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
     param.remove_jump_scans= TRUE;
     param.force_default_mrr= ordered_output;
 
+    range_opt_start= microsecond_interval_timer();
     thd->no_errors=1;				// Don't warn about NULL
     init_sql_alloc(&alloc, thd->variables.range_alloc_block_size, 0);
     if (!(param.key_parts=
@@ -3031,6 +3119,7 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
     }
     param.key_parts_end=key_parts;
     param.alloced_sel_args= 0;
+    param.free_sel_args= NULL;
 
     /* Calculate cost of full index read for the shortest covering index */
     if (!head->covering_keys.is_clear_all())
@@ -3083,6 +3172,20 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
       }
     }
 
+    /*
+      Try to construct a QUICK_SKIP_SCAN_SELECT. This must be done before
+      remove_nonrange_trees() drops the trees over non-leading key parts.
+    */
+    if (tree && optimizer_flag(thd, OPTIMIZER_SWITCH_SKIP_SCAN))
+    {
+      TRP_SKIP_SCAN *skip_trp;
+      if ((skip_trp= get_best_skip_scan(&param, tree, best_read_time)))
+      {
+        best_trp= skip_trp;
+        best_read_time= best_trp->read_cost;
+      }
+    }
+
     if (tree)
     {
       /*
@@ -3192,9 +3295,13 @@ int SQL_SELECT::test_quick_select(THD *thd, key_map keys_to_use,
     }
 
   free_mem:
+    set_if_bigger(thd->query_plan_range_opt_memory,
+                  (ulong) mem_root_allocated_size(&alloc));
     free_root(&alloc,MYF(0));			// Return memory & allocator
     thd->mem_root= param.old_root;
     thd->no_errors=0;
+    thd->query_plan_range_opt_time+= (microsecond_interval_timer() -
+                                      range_opt_start);
   }
 
   DBUG_EXECUTE("info", print_quick(quick, &needed_reg););
@@ -3451,6 +3558,7 @@ bool prune_partitions(THD *thd, TABLE *table, Item *pprune_cond)
   range_par->remove_jump_scans= FALSE;
   range_par->real_keynr[0]= 0;
   range_par->alloced_sel_args= 0;
+  range_par->free_sel_args= NULL;
 
   thd->no_errors=1;				// Don't warn about NULL
   thd->mem_root=&alloc;
@@ -8832,6 +8940,176 @@ get_range(SEL_ARG **e1,SEL_ARG **e2,SEL_ARG *root1)
 }
 
 
+/*
+  Check if a SEL_ARG tree is a plain list of intervals over one key part,
+  i.e. none of its intervals refers to a tree over the next key parts.
+*/
+
+static bool is_single_keypart_tree(SEL_ARG *key)
+{
+  if (key->type != SEL_ARG::KEY_RANGE)
+    return FALSE;
+  for (SEL_ARG *pos= key->first(); pos; pos= pos->next)
+  {
+    if (pos->next_key_part)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/*
+  Link an ordered array of intervals into a balanced red-black tree
+
+  SYNOPSIS
+    build_balanced_tree()
+      elems      Array of intervals in ascending order
+      first      Index of the first element of the subtree
+      last       Index of the last element of the subtree
+      parent     Parent of the subtree root
+      depth      Depth of the subtree root, the tree root has depth 1
+      red_depth  Elements at this depth are colored red
+
+  DESCRIPTION
+    The middle element becomes the subtree root. The leaves of such a tree
+    are at depth h or h+1, where h= floor(log2(#elements + 1)). Coloring all
+    elements at depth h+1 red and all others black gives a tree in which
+    every path from the root to a leaf has exactly h black elements.
+
+  RETURN
+    Root of the subtree
+*/
+
+static SEL_ARG *build_balanced_tree(SEL_ARG **elems, int first, int last,
+                                    SEL_ARG *parent, uint depth,
+                                    uint red_depth)
+{
+  if (first > last)
+    return &null_element;
+  int middle= (first + last) / 2;
+  SEL_ARG *root= elems[middle];
+  root->parent= parent;
+  root->color= depth == red_depth ? SEL_ARG::RED : SEL_ARG::BLACK;
+  root->left= build_balanced_tree(elems, first, middle - 1, root, depth + 1,
+                                  red_depth);
+  root->right= build_balanced_tree(elems, middle + 1, last, root, depth + 1,
+                                   red_depth);
+  return root;
+}
+
+
+/*
+  Produce "key1 OR key2" for two interval lists over the same key part
+
+  SYNOPSIS
+    key_or_single_keypart()
+      param   Range analysis context
+      key1    First argument, root of its RB-tree
+      key2    Second argument, root of its RB-tree
+
+  DESCRIPTION
+    This is a special case of key_or() for trees without next_key_part
+    references, e.g. the trees built for "kp1 IN (...) OR kp1 IN (...)".
+    Both interval lists are sorted, so they are merged in a single pass,
+    and the result is linked into a balanced RB-tree in linear time
+    instead of inserting the intervals of one tree into the other one by
+    one.
+
+    The arguments are modified in place only if they are not shared
+    (use_count == 0). Intervals of a shared tree are copied only if they
+    start a new interval of the result, intervals that are swallowed by a
+    neighbour are not copied at all. Swallowed intervals of unshared trees
+    are returned to the SEL_ARG pool of param.
+
+    The caller has already decremented use_count of both arguments.
+
+  RETURN
+    RB-tree root of the resulting SEL_ARG graph
+    NULL if the result is the full range (or on OOM)
+*/
+
+static SEL_ARG *
+key_or_single_keypart(RANGE_OPT_PARAM *param, SEL_ARG *key1, SEL_ARG *key2)
+{
+  bool key1_shared= key1->use_count != 0;
+  bool key2_shared= key2->use_count != 0;
+  bool maybe_flag= key1->maybe_flag || key2->maybe_flag;
+  uint max_part_no= max(key1->max_part_no, key2->max_part_no);
+  SEL_ARG **elems;
+  SEL_ARG *e1= key1->first(), *e2= key2->first();
+  SEL_ARG *cur= NULL, *root;
+  uint n_elems= 0;
+
+  if (!(elems= (SEL_ARG**) alloc_root(param->mem_root,
+                                      sizeof(SEL_ARG*) *
+                                      (key1->elements + key2->elements))))
+    return 0;                                   // OOM
+
+  while (e1 || e2)
+  {
+    SEL_ARG *elem;
+    bool elem_shared;
+    if (!e2 || (e1 && e1->cmp_min_to_min(e2) <= 0))
+    {
+      elem= e1;
+      elem_shared= key1_shared;
+      e1= e1->next;
+    }
+    else
+    {
+      elem= e2;
+      elem_shared= key2_shared;
+      e2= e2->next;
+    }
+
+    if (cur)
+    {
+      int cmp= cur->cmp_max_to_min(elem);
+      if (cmp >= 0 || cmp == -2)
+      {
+        /* elem overlaps with cur or is adjacent to it: extend cur */
+        if (cur->cmp_max_to_max(elem) < 0)
+        {
+          cur->max_value= elem->max_value;
+          cur->max_flag= elem->max_flag;
+        }
+        cur->maybe_flag|= elem->maybe_flag;
+        if (!elem_shared)
+          param->release_sel_arg(elem);
+        if ((cur->min_flag & NO_MIN_RANGE) && (cur->max_flag & NO_MAX_RANGE))
+        {
+          /* Full range */
+          if (maybe_flag)
+            return new SEL_ARG(SEL_ARG::MAYBE_KEY);
+          return 0;
+        }
+        continue;
+      }
+      elems[n_elems++]= cur;
+    }
+    /* Intervals of a shared tree are copied before they are relinked */
+    cur= elem;
+    if (elem_shared && !(cur= new (param) SEL_ARG(*elem)))
+      return 0;                                 // OOM
+  }
+  elems[n_elems++]= cur;
+
+  /* Link the result into the next/prev list and the RB-tree */
+  for (uint i= 0; i < n_elems; i++)
+  {
+    elems[i]->prev= i ? elems[i - 1] : NULL;
+    elems[i]->next= i + 1 < n_elems ? elems[i + 1] : NULL;
+  }
+  root= build_balanced_tree(elems, 0, (int) n_elems - 1, NULL, 1,
+                            my_bit_log2(n_elems + 1) + 1);
+  root->elements= n_elems;
+  root->use_count= 1;
+  root->maybe_flag= maybe_flag;
+  root->max_part_no= max_part_no;
+  return root;
+}
+
+
 /**
    Combine two range expression under a common OR. On a logical level, the
    transformation is key_or( expr1, expr2 ) => expr1 OR expr2.
@@ -8932,6 +9210,22 @@ key_or(RANGE_OPT_PARAM *param, SEL_ARG *key1,SEL_ARG *key2)
     return key2;
   }
 
+  /*
+    Merging two sorted interval lists is linear in their total size, while
+    inserting the intervals of one list into the other one by one costs
+    O(log n) per interval. Prefer the merge when the second argument is
+    not negligibly small.
+  */
+  {
+    ulong small_elements= min(key1->elements, key2->elements);
+    ulong big_elements= max(key1->elements, key2->elements);
+    if (small_elements > 1 &&
+        small_elements * (my_bit_log2(big_elements) + 1) >=
+          small_elements + big_elements &&
+        is_single_keypart_tree(key1) && is_single_keypart_tree(key2))
+      return key_or_single_keypart(param, key1, key2);
+  }
+
   if (key1->use_count > 0)
   {
     if (key2->use_count == 0 || key1->elements > key2->elements)
@@ -14116,6 +14410,492 @@ void QUICK_GROUP_MIN_MAX_SELECT::add_keys_and_lengths(String *key_names,
 }
 
 
+/*******************************************************************************
+* Implementation of QUICK_SKIP_SCAN_SELECT
+*******************************************************************************/
+
+/*
+  Test if this access method is applicable to an index with range conditions
+  over a non-leading key part, and if so, construct a new TRP object.
+
+  SYNOPSIS
+    get_best_skip_scan()
+    param    Parameter from test_quick_select
+    tree     Range tree constructed from the WHERE clause
+    read_time Best read time so far (=table/index scan time)
+
+  DESCRIPTION
+    Consider an index I = <A_1,...,A_k, B, C_1,...,C_n> and a query
+
+      SELECT ... FROM T WHERE RNG(B) AND ...
+
+    where RNG(B) is a disjunction of intervals over B, and there are no
+    conditions over A_1,...,A_k that the range optimizer can use. Normally
+    such a query is answered by a full table or index scan. If the prefix
+    <A_1,...,A_k> has few distinct values, it is cheaper to enumerate them by
+    jumping from one prefix value to the next one, and to perform an index
+    range scan for each interval of RNG(B) inside every prefix.
+
+    Conditions for applicability:
+    SS1. The range tree for I has a root over a key part with number k > 0
+         (a tree with a root over the first key part is a regular range
+         scan), and the root is neither a MAYBE tree nor a MAYBE key.
+    SS2. I is an ordered index (a B-tree).
+    SS3. None of A_1,...,A_k, B is a partial key part or a BLOB part.
+    SS4. There is index statistics for the prefix <A_1,...,A_k>.
+    SS5. None of the intervals over B is (-inf, +inf).
+
+    Only the intervals over B are used for access; conditions over C_1..C_n
+    that may be present in the tree as well as all other conditions remain
+    in the WHERE clause and are checked for each retrieved row.
+
+  NOTES
+    The cost model is similar to cost_group_min_max(): every group costs one
+    index dive to find the next prefix value plus one dive per interval, the
+    total number of index blocks touched is bounded by the size of the index.
+
+  RETURN
+    If the index is applicable and cheaper than read_time, the new TRP object,
+    NULL otherwise.
+*/
+
+static TRP_SKIP_SCAN *
+get_best_skip_scan(PARAM *param, SEL_TREE *tree, double read_time)
+{
+  THD *thd= param->thd;
+  TABLE *table= param->table;
+  ha_rows table_records= table->file->stats.records;
+  TRP_SKIP_SCAN *read_plan= NULL;
+  SEL_ARG *best_range_tree= NULL;
+  KEY *best_index_info= NULL;
+  uint best_index= 0;
+  uint best_prefix_len= 0;
+  uint best_prefix_key_parts= 0;
+  double best_read_cost= read_time;
+  ha_rows best_records= 0;
+  DBUG_ENTER("get_best_skip_scan");
+
+  if (thd->lex->sql_command != SQLCOM_SELECT)
+    DBUG_RETURN(NULL);       /* Keep UPDATE/DELETE on tried-and-true paths. */
+  if (table_records == 0)
+    DBUG_RETURN(NULL);
+
+  for (uint idx= 0; idx < param->keys; idx++)
+  {
+    SEL_ARG *key_tree= tree->keys[idx];
+    uint keynr= param->real_keynr[idx];
+    KEY *index_info= table->key_info + keynr;
+    KEY_PART_INFO *key_part, *range_part;
+    uint prefix_key_parts;
+    uint prefix_len= 0;
+    uint n_ranges= 0;
+    uint n_eq_ranges= 0;
+    ulong keys_per_group, keys_per_point;
+    uint keys_per_block, num_blocks;
+    ha_rows num_groups, records;
+    double io_cost, cpu_cost, read_cost;
+
+    /* Check (SS1). */
+    if (!key_tree || key_tree->type != SEL_ARG::KEY_RANGE ||
+        key_tree->part == 0 || key_tree->maybe_flag)
+      continue;
+    prefix_key_parts= key_tree->part;
+    range_part= index_info->key_part + prefix_key_parts;
+
+    /* Check (SS2). */
+    if ((index_info->algorithm != HA_KEY_ALG_BTREE &&
+         index_info->algorithm != HA_KEY_ALG_UNDEF) ||
+        !(table->file->index_flags(keynr, prefix_key_parts, 1) &
+          HA_READ_ORDER))
+      continue;
+
+    /* Check (SS3). */
+    for (key_part= index_info->key_part; key_part <= range_part; key_part++)
+    {
+      if (key_part->key_part_flag & (HA_PART_KEY_SEG | HA_BLOB_PART))
+        break;
+      if (key_part != range_part)
+        prefix_len+= key_part->store_length;
+    }
+    if (key_part <= range_part)
+      continue;
+
+    /* Check (SS4). */
+    if (!(keys_per_group= index_info->rec_per_key[prefix_key_parts - 1]))
+      continue;
+
+    /* Check (SS5) and count the intervals. */
+    for (SEL_ARG *range= key_tree->first(); range; range= range->next)
+    {
+      if ((range->min_flag & NO_MIN_RANGE) && (range->max_flag & NO_MAX_RANGE))
+      {
+        n_ranges= 0;
+        break;
+      }
+      n_ranges++;
+      if (range->is_singlepoint())
+        n_eq_ranges++;
+    }
+    if (n_ranges == 0)
+      continue;
+
+    /*
+      Estimate the number of rows: a point interval matches a sub-group of
+      the size given by index statistics, for other intervals we guess that
+      they cover a third of their group.
+    */
+    num_groups= table_records / keys_per_group + 1;
+    keys_per_point= index_info->rec_per_key[prefix_key_parts];
+    if (keys_per_point == 0)
+      keys_per_point= keys_per_group / 10 + 1;
+    records= num_groups * (n_eq_ranges * keys_per_point +
+                           (n_ranges - n_eq_ranges) * (keys_per_group / 3 + 1));
+    set_if_smaller(records, table_records);
+
+    keys_per_block= (table->file->stats.block_size / 2 /
+                     (index_info->key_length + table->file->ref_length) + 1);
+    num_blocks= (uint) (table_records / keys_per_block) + 1;
+    io_cost= min(rows2double(num_groups) * (1 + n_ranges) +
+                 rows2double(records) / keys_per_block,
+                 (double) num_blocks);
+    if (!table->covering_keys.is_set(keynr))
+      io_cost+= table->file->read_time(keynr, 0, records);
+    cpu_cost= rows2double(num_groups + records) / TIME_FOR_COMPARE;
+    read_cost= io_cost + cpu_cost;
+
+    DBUG_PRINT("info",
+               ("index %s  groups: %lu  ranges: %u  rows: %lu  cost: %g",
+                index_info->name, (ulong) num_groups, n_ranges,
+                (ulong) records, read_cost));
+
+    if (read_cost < best_read_cost)
+    {
+      best_read_cost= read_cost;
+      best_records= records;
+      best_range_tree= key_tree;
+      best_index_info= index_info;
+      best_index= keynr;
+      best_prefix_len= prefix_len;
+      best_prefix_key_parts= prefix_key_parts;
+    }
+  }
+
+  if (best_range_tree &&
+      (read_plan= new (param->mem_root) TRP_SKIP_SCAN(best_index_info,
+                                                      best_index,
+                                                      best_prefix_len,
+                                                      best_prefix_key_parts,
+                                                      best_range_tree)))
+  {
+    read_plan->read_cost= best_read_cost;
+    read_plan->records= best_records;
+    DBUG_PRINT("info",
+               ("Returning skip scan plan: cost: %g, records: %lu",
+                read_plan->read_cost, (ulong) read_plan->records));
+  }
+
+  DBUG_RETURN(read_plan);
+}
+
+
+/*
+  Construct a new quick select object for a skip scan.
+
+  SYNOPSIS
+    TRP_SKIP_SCAN::make_quick()
+    param              Parameter from test_quick_select
+    retrieve_full_rows ignored
+    parent_alloc       ignored
+
+  RETURN
+    New QUICK_SKIP_SCAN_SELECT object if successfully created,
+    NULL otherwise.
+*/
+
+QUICK_SELECT_I *
+TRP_SKIP_SCAN::make_quick(PARAM *param, bool retrieve_full_rows,
+                          MEM_ROOT *parent_alloc)
+{
+  QUICK_SKIP_SCAN_SELECT *quick;
+  MEM_ROOT *old_root= param->thd->mem_root;
+  DBUG_ENTER("TRP_SKIP_SCAN::make_quick");
+
+  if (!(quick= new QUICK_SKIP_SCAN_SELECT(param->table, param->thd,
+                                          index_info, index, prefix_len,
+                                          prefix_key_parts, read_cost,
+                                          records)))
+    DBUG_RETURN(NULL);
+
+  if (quick->init())
+  {
+    delete quick;
+    DBUG_RETURN(NULL);
+  }
+
+  /* The QUICK_RANGE objects must live as long as the quick select. */
+  param->thd->mem_root= &quick->alloc;
+  for (SEL_ARG *range= range_tree->first(); range; range= range->next)
+  {
+    if (quick->add_range(range))
+    {
+      param->thd->mem_root= old_root;
+      delete quick;
+      DBUG_RETURN(NULL);
+    }
+  }
+  param->thd->mem_root= old_root;
+
+  DBUG_RETURN(quick);
+}
+
+
+QUICK_SKIP_SCAN_SELECT::
+QUICK_SKIP_SCAN_SELECT(TABLE *table, THD *thd, KEY *index_info_arg,
+                       uint use_index, uint prefix_len_arg,
+                       uint prefix_key_parts_arg, double read_cost_arg,
+                       ha_rows records_arg)
+  :file(table->file), index_info(index_info_arg),
+   prefix_len(prefix_len_arg), prefix_key_parts(prefix_key_parts_arg),
+   cur_range(0), min_search_key(NULL), max_search_key(NULL),
+   seen_first_key(FALSE), in_range(FALSE)
+{
+  head=       table;
+  index=      use_index;
+  record=     head->record[0];
+  read_time=  read_cost_arg;
+  records=    records_arg;
+  range_key_len= index_info->key_part[prefix_key_parts].store_length;
+  used_key_parts= prefix_key_parts + 1;
+  max_used_key_length= prefix_len + range_key_len;
+
+  init_sql_alloc(&alloc, thd->variables.range_alloc_block_size, 0);
+  my_init_dynamic_array(&ranges, sizeof(QUICK_RANGE*), 16, 16);
+}
+
+
+/*
+  Do post-constructor initialization.
+
+  SYNOPSIS
+    QUICK_SKIP_SCAN_SELECT::init()
+
+  DESCRIPTION
+    Allocate the buffers for the search keys: each one holds the current
+    prefix followed by one endpoint of the current range.
+
+  RETURN
+    0      OK
+    other  Error code
+*/
+
+int QUICK_SKIP_SCAN_SELECT::init()
+{
+  if (min_search_key) /* Already initialized. */
+    return 0;
+  if (!(min_search_key= (uchar*) alloc_root(&alloc, max_used_key_length)) ||
+      !(max_search_key= (uchar*) alloc_root(&alloc, max_used_key_length)))
+    return 1;
+  return 0;
+}
+
+
+QUICK_SKIP_SCAN_SELECT::~QUICK_SKIP_SCAN_SELECT()
+{
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::~QUICK_SKIP_SCAN_SELECT");
+  if (file->inited != handler::NONE)
+  {
+    DBUG_ASSERT(file == head->file);
+    file->ha_index_or_rnd_end();
+  }
+  delete_dynamic(&ranges);
+  free_root(&alloc,MYF(0));
+  DBUG_VOID_RETURN;
+}
+
+
+/*
+  Create a QUICK_RANGE object from a SEL_ARG interval over the range key
+  part and append it to the array of ranges.
+
+  SYNOPSIS
+    QUICK_SKIP_SCAN_SELECT::add_range()
+    sel_range  Interval over the first key part after the skipped prefix
+
+  RETURN
+    FALSE on success
+    TRUE  otherwise
+*/
+
+bool QUICK_SKIP_SCAN_SELECT::add_range(SEL_ARG *sel_range)
+{
+  QUICK_RANGE *range;
+  uint range_flag= sel_range->min_flag | sel_range->max_flag;
+
+  if (sel_range->is_singlepoint())
+    range_flag|= EQ_RANGE;
+  range= new QUICK_RANGE(sel_range->min_value, range_key_len,
+                         make_keypart_map(sel_range->part),
+                         sel_range->max_value, range_key_len,
+                         make_keypart_map(sel_range->part),
+                         range_flag);
+  if (!range)
+    return TRUE;
+  if (insert_dynamic(&ranges, (uchar*)&range))
+    return TRUE;
+  return FALSE;
+}
+
+
+int QUICK_SKIP_SCAN_SELECT::reset(void)
+{
+  int result;
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::reset");
+
+  seen_first_key= FALSE;
+  in_range= FALSE;
+  cur_range= ranges.elements;          /* Forces a jump to the first prefix */
+  if (file->inited == handler::NONE &&
+      (result= file->ha_index_init(index, 1)))
+  {
+    file->print_error(result, MYF(0));
+    DBUG_RETURN(result);
+  }
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Find the first key of the next distinct prefix and store the prefix in
+  the search key buffers.
+
+  SYNOPSIS
+    QUICK_SKIP_SCAN_SELECT::next_prefix()
+
+  RETURN
+    0                    on success
+    HA_ERR_END_OF_FILE   if there are no more prefixes
+    other                if some error occurred
+*/
+
+int QUICK_SKIP_SCAN_SELECT::next_prefix()
+{
+  int result;
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::next_prefix");
+
+  /* The end of the last range must not stop the jump to the next prefix. */
+  file->end_range= NULL;
+  if (!seen_first_key)
+  {
+    result= file->ha_index_first(record);
+    seen_first_key= TRUE;
+  }
+  else
+    result= file->ha_index_read_map(record, min_search_key,
+                                    make_prev_keypart_map(prefix_key_parts),
+                                    HA_READ_AFTER_KEY);
+  if (result)
+    DBUG_RETURN(result == HA_ERR_KEY_NOT_FOUND ? HA_ERR_END_OF_FILE : result);
+
+  key_copy(min_search_key, record, index_info, prefix_len);
+  memcpy(max_search_key, min_search_key, prefix_len);
+  cur_range= 0;
+  DBUG_RETURN(0);
+}
+
+
+/*
+  Get the next row in index order.
+
+  SYNOPSIS
+    QUICK_SKIP_SCAN_SELECT::get_next()
+
+  DESCRIPTION
+    Continue scanning the current range inside the current prefix. When it
+    is exhausted, start scanning the next range with the same prefix, and
+    when all ranges are exhausted, jump to the next prefix value.
+
+  RETURN
+    0                  on success
+    HA_ERR_END_OF_FILE if returned all keys
+    other              if some error occurred
+*/
+
+int QUICK_SKIP_SCAN_SELECT::get_next()
+{
+  int result;
+  DBUG_ENTER("QUICK_SKIP_SCAN_SELECT::get_next");
+
+  for (;;)
+  {
+    if (in_range)
+    {
+      if ((result= file->read_range_next()) != HA_ERR_END_OF_FILE)
+        DBUG_RETURN(result);
+      in_range= FALSE;
+    }
+
+    if (cur_range == ranges.elements && (result= next_prefix()))
+      DBUG_RETURN(result);
+
+    QUICK_RANGE *range;
+    key_range start_key, end_key;
+    const key_part_map prefix_map= make_prev_keypart_map(prefix_key_parts);
+    get_dynamic(&ranges, (uchar*)&range, cur_range++);
+
+    start_key.key= min_search_key;
+    if (range->flag & NO_MIN_RANGE)
+    {
+      start_key.length= prefix_len;
+      start_key.keypart_map= prefix_map;
+      start_key.flag= HA_READ_KEY_OR_NEXT;
+    }
+    else
+    {
+      memcpy(min_search_key + prefix_len, range->min_key, range->min_length);
+      start_key.length= prefix_len + range->min_length;
+      start_key.keypart_map= prefix_map | range->min_keypart_map;
+      start_key.flag= ((range->flag & NEAR_MIN) ? HA_READ_AFTER_KEY :
+                       (range->flag & EQ_RANGE) ? HA_READ_KEY_EXACT :
+                                                  HA_READ_KEY_OR_NEXT);
+    }
+
+    end_key.key= max_search_key;
+    if (range->flag & NO_MAX_RANGE)
+    {
+      end_key.length= prefix_len;
+      end_key.keypart_map= prefix_map;
+      end_key.flag= HA_READ_AFTER_KEY;
+    }
+    else
+    {
+      memcpy(max_search_key + prefix_len, range->max_key, range->max_length);
+      end_key.length= prefix_len + range->max_length;
+      end_key.keypart_map= prefix_map | range->max_keypart_map;
+      end_key.flag= ((range->flag & NEAR_MAX) ? HA_READ_BEFORE_KEY :
+                                                HA_READ_AFTER_KEY);
+    }
+
+    result= file->read_range_first(&start_key, &end_key,
+                                   test(range->flag & EQ_RANGE), TRUE);
+    if (result != HA_ERR_END_OF_FILE)
+    {
+      if (!result)
+        in_range= TRUE;
+      DBUG_RETURN(result);
+    }
+  }
+}
+
+
+void QUICK_SKIP_SCAN_SELECT::add_keys_and_lengths(String *key_names,
+                                                  String *used_lengths)
+{
+  bool first= TRUE;
+
+  add_key_and_length(key_names, used_lengths, &first);
+}
+
+
 #ifndef DBUG_OFF
 
 static void print_sel_tree(PARAM *param, SEL_TREE *tree, key_map *tree_map,
@@ -14368,6 +15148,19 @@ void QUICK_GROUP_MIN_MAX_SELECT::dbug_dump(int indent, bool verbose)
 }
 
 
+
+void QUICK_SKIP_SCAN_SELECT::dbug_dump(int indent, bool verbose)
+{
+  fprintf(DBUG_FILE,
+          "%*squick_skip_scan_select: index %s (%d), prefix key parts: %d, "
+          "length: %d\n",
+	  indent, "", index_info->name, index, prefix_key_parts,
+          max_used_key_length);
+  fprintf(DBUG_FILE, "%*susing %d quick_ranges inside each prefix\n",
+          indent, "", ranges.elements);
+}
+
+
 #endif /* !DBUG_OFF */
 
 /*****************************************************************************
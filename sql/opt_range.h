@@ -304,7 +304,8 @@ public:
     QS_TYPE_FULLTEXT   = 4,
     QS_TYPE_ROR_INTERSECT = 5,
     QS_TYPE_ROR_UNION = 6,
-    QS_TYPE_GROUP_MIN_MAX = 7
+    QS_TYPE_GROUP_MIN_MAX = 7,
+    QS_TYPE_SKIP_SCAN = 8
   };
 
   /* Get type of this quick select - one of the QS_TYPE_* values */
@@ -952,6 +953,61 @@ public:
 };
 
 
+/*
+  Index access method for queries with range conditions over a non-leading
+  key part, e.g.
+
+       SELECT ... FROM T WHERE [RNG(B)] AND [other conditions]
+
+  where the index is (A_1,...,A_k, B, ...) and there are no conditions over
+  A_1,...,A_k usable for range access.
+
+  The quick select enumerates the distinct values of the prefix
+  (A_1,...,A_k) by jumping over groups with index_read_map(HA_READ_AFTER_KEY),
+  and for every such prefix performs an index range scan for each of the
+  intervals over B. It is profitable when the prefix has few distinct values
+  compared to the number of rows in the table. Rows are returned in index
+  order. The class of applicable queries is described in
+  get_best_skip_scan() in opt_range.cc.
+*/
+
+class QUICK_SKIP_SCAN_SELECT : public QUICK_SELECT_I
+{
+private:
+  handler * const file;   /* The handler used to get data. */
+  KEY  *index_info;       /* The index chosen for data access */
+  const uint prefix_len;  /* Length of the skipped key prefix. */
+  const uint prefix_key_parts; /* Number of keyparts in the skipped prefix */
+  uint range_key_len;     /* Length of the key part the ranges are over. */
+  DYNAMIC_ARRAY ranges;   /* Array of QUICK_RANGE ptrs over the range part */
+  uint cur_range;         /* Next range to scan within the current prefix */
+  uchar *min_search_key;  /* Current prefix extended with a range start */
+  uchar *max_search_key;  /* Current prefix extended with a range end */
+  bool seen_first_key;    /* Denotes whether the first prefix was read. */
+  bool in_range;          /* TRUE while a range inside a prefix is scanned */
+  int  next_prefix();
+public:
+  MEM_ROOT alloc;         /* Memory pool for this quick select. */
+  QUICK_SKIP_SCAN_SELECT(TABLE *table, THD *thd, KEY *index_info,
+                         uint use_index, uint prefix_len,
+                         uint prefix_key_parts, double read_cost,
+                         ha_rows records);
+  ~QUICK_SKIP_SCAN_SELECT();
+  bool add_range(SEL_ARG *sel_range);
+  int init();
+  void need_sorted_output() { /* always do it */ }
+  int reset();
+  int get_next();
+  bool reverse_sorted() { return false; }
+  bool unique_key_range() { return false; }
+  int get_type() { return QS_TYPE_SKIP_SCAN; }
+  void add_keys_and_lengths(String *key_names, String *used_lengths);
+#ifndef DBUG_OFF
+  void dbug_dump(int indent, bool verbose);
+#endif
+};
+
+
 class QUICK_SELECT_DESC: public QUICK_RANGE_SELECT
 {
 public:
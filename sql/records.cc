@@ -29,6 +29,7 @@
 #include "sql_priv.h"
 #include "records.h"
 #include "filesort.h"            // filesort_free_buffers
+#include "sql_sort.h"                           // PACKED_LENGTH_BYTES
 #include "opt_range.h"                          // SQL_SELECT
 #include "sql_class.h"                          // THD
 #include "sql_base.h"
@@ -511,11 +512,22 @@ static int rr_from_tempfile(READ_RECORD *info)
 
 static int rr_unpack_from_tempfile(READ_RECORD *info)
 {
-  if (my_b_read(info->io_cache, info->rec_buf, info->ref_length))
-    return -1;
   TABLE *table= info->table;
+  uint length= info->ref_length;
+  if (table->sort.using_packed_addons)
+  {
+    /* The record starts with its length, see sql_sort.h */
+    if (my_b_read(info->io_cache, info->rec_buf, PACKED_LENGTH_BYTES))
+      return -1;
+    length= uint4korr(info->rec_buf);
+    if (my_b_read(info->io_cache, info->rec_buf + PACKED_LENGTH_BYTES,
+                  length - PACKED_LENGTH_BYTES))
+      return -1;
+  }
+  else if (my_b_read(info->io_cache, info->rec_buf, info->ref_length))
+    return -1;
   (*table->sort.unpack)(table->sort.addon_field, info->rec_buf,
-                        info->rec_buf + info->ref_length);
+                        info->rec_buf + length);
 
   return 0;
 }
@@ -298,6 +298,19 @@ public:
   char ign_master_log_name_end[FN_REFLEN];
   ulonglong ign_master_log_pos_end;
 
+  /*
+    The events the slave I/O thread appended last to the hot relay log, in
+    a ring buffer of slave_event_queue_size bytes from which the SQL thread
+    takes them instead of reading them back (see queue_event() and
+    next_event()). The buffer holds the range [event_queue_start,
+    event_queue_end) of the relay log which relay_log.get_open_count()
+    was event_queue_open_count for.
+    Protected by rli->relay_log.LOCK_log.
+  */
+  uchar *event_queue_buf;
+  uint32 event_queue_open_count;
+  my_off_t event_queue_start, event_queue_end;
+
   /* 
     Indentifies where the SQL Thread should create temporary files for the
     LOAD DATA INFILE. This is used for security reasons.
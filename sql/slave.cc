@@ -4173,6 +4173,62 @@ static int queue_old_event(Master_info *mi, const char *buf,
   }
 }
 
+/*
+  Copy an event the I/O thread has appended to the hot relay log into the
+  event queue of rli (see Relay_log_info::event_queue_buf).
+
+  @param rli         relay log info of the I/O thread
+  @param open_count  relay_log.get_open_count() when the event was written
+  @param pos         offset of the event in the relay log
+  @param buf         the event
+  @param event_len   length of the event
+*/
+
+static void event_queue_append(Relay_log_info *rli, uint32 open_count,
+                               my_off_t pos, const char *buf,
+                               ulong event_len)
+{
+  size_t offset, first;
+
+  mysql_mutex_assert_owner(rli->relay_log.get_log_lock());
+  if (event_len > slave_event_queue_size ||
+      (!rli->event_queue_buf &&
+       !(rli->event_queue_buf= (uchar*) my_malloc(slave_event_queue_size,
+                                                  MYF(0)))))
+    return;
+
+  if (open_count != rli->event_queue_open_count ||
+      pos != rli->event_queue_end)
+  {
+    /* Other events were written to the relay log meanwhile: start over */
+    rli->event_queue_open_count= open_count;
+    rli->event_queue_start= rli->event_queue_end= pos;
+  }
+  offset= (size_t) (pos % slave_event_queue_size);
+  first= min((size_t) event_len, slave_event_queue_size - offset);
+  memcpy(rli->event_queue_buf + offset, buf, first);
+  memcpy(rli->event_queue_buf, buf + first, event_len - first);
+  rli->event_queue_end= pos + event_len;
+  if (rli->event_queue_end - rli->event_queue_start > slave_event_queue_size)
+    rli->event_queue_start= rli->event_queue_end - slave_event_queue_size;
+}
+
+
+/*
+  Copy 'length' bytes of the relay log at offset 'pos' out of the event
+  queue. The bytes must be in the queue.
+*/
+
+static void event_queue_copy(Relay_log_info *rli, uchar *to, my_off_t pos,
+                             size_t length)
+{
+  size_t offset= (size_t) (pos % slave_event_queue_size);
+  size_t first= min(length, slave_event_queue_size - offset);
+  memcpy(to, rli->event_queue_buf + offset, first);
+  memcpy(to + first, rli->event_queue_buf, length - first);
+}
+
+
 /*
   queue_event()
 
@@ -4531,8 +4587,11 @@ static int queue_event(Master_info* mi,const char* buf, ulong event_len)
   else
   {
     /* write the event to the relay log */
+    uint32 open_count= rli->relay_log.get_open_count();
+    my_off_t relay_pos= my_b_append_tell(rli->relay_log.get_log_file());
     if (likely(!(rli->relay_log.appendv(buf,event_len,0))))
     {
+      event_queue_append(rli, open_count, relay_pos, buf, event_len);
       mi->master_log_pos+= inc_pos;
       DBUG_PRINT("info", ("master_log_pos: %lu", (ulong) mi->master_log_pos));
       rli->relay_log.harvest_bytes_written(&rli->log_space_total);
@@ -4939,6 +4998,57 @@ static IO_CACHE *reopen_relay_log(Relay_log_info *rli, const char **errmsg)
 }
 
 
+/*
+  Take the event at the current position of the hot relay log from the
+  event queue the I/O thread fills (see event_queue_append()).
+
+  @param rli      relay log info of the SQL thread
+  @param cur_log  the hot relay log
+
+  @return the event, with cur_log positioned after it, or 0 if the event
+          has to be read from the relay log (which also reports errors).
+*/
+
+static Log_event *event_queue_read(Relay_log_info *rli, IO_CACHE *cur_log)
+{
+  my_off_t pos= my_b_tell(cur_log);
+  uchar head[LOG_EVENT_MINIMAL_HEADER_LEN];
+  ulong data_len;
+  char *buf;
+  const char *errmsg= 0;
+  Log_event *ev;
+
+  mysql_mutex_assert_owner(rli->relay_log.get_log_lock());
+  if (!rli->event_queue_buf ||
+      rli->event_queue_open_count != rli->cur_log_old_open_count ||
+      pos < rli->event_queue_start ||
+      pos + LOG_EVENT_MINIMAL_HEADER_LEN > rli->event_queue_end)
+    return 0;
+
+  event_queue_copy(rli, head, pos, sizeof(head));
+  data_len= uint4korr(head + EVENT_LEN_OFFSET);
+  if (data_len < LOG_EVENT_MINIMAL_HEADER_LEN ||
+      data_len > slave_max_allowed_packet ||
+      pos + data_len > rli->event_queue_end ||
+      !(buf= (char*) my_malloc(data_len + 1, MYF(0))))
+    return 0;
+  /* some events use the extra byte to null-terminate strings */
+  buf[data_len]= 0;
+  event_queue_copy(rli, (uchar*) buf, pos, data_len);
+  if (!(ev= Log_event::read_log_event(buf, data_len, &errmsg,
+                                      rli->relay_log.description_event_for_exec,
+                                      opt_slave_sql_verify_checksum)))
+  {
+    my_free(buf);
+    return 0;
+  }
+  ev->register_temp_buf(buf, TRUE);
+  my_b_seek(cur_log, pos + data_len);
+  slave_event_queue_hits++;
+  return ev;
+}
+
+
 /**
   Reads next event from the relay log.  Should be called from the
   slave IO thread.
@@ -5037,7 +5147,8 @@ static Log_event* next_event(Relay_log_info* rli)
       But if the relay log is created by new_file(): then the solution is:
       MYSQL_BIN_LOG::open() will write the buffered description event.
     */
-    if ((ev= Log_event::read_log_event(cur_log,0,
+    if ((hot_log && (ev= event_queue_read(rli, cur_log))) ||
+        (ev= Log_event::read_log_event(cur_log,0,
                                        rli->relay_log.description_event_for_exec,
                                        opt_slave_sql_verify_checksum)))
 
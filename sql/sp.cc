@@ -548,12 +548,25 @@ db_find_routine(THD *thd, stored_procedure_type type, sp_name *name,
   ulonglong sql_mode, saved_mode= thd->variables.sql_mode;
   Open_tables_backup open_tables_state_backup;
   Stored_program_creation_ctx *creation_ctx;
+  sp_definition def;
+  ulong cache_version= sp_definition_cache_version();
+  ulong warn_count;
 
   DBUG_ENTER("db_find_routine");
   DBUG_PRINT("enter", ("type: %d name: %.*s",
 		       type, (int) name->m_name.length, name->m_name.str));
 
   *sphp= 0;                                     // In case of errors
+
+  /* Another thread may have read the definition already. */
+  def.chistics= &chistics;
+  if (sp_definition_cache_lookup(type, name, thd->mem_root, &def))
+    DBUG_RETURN(db_load_routine(thd, type, name, sphp,
+                                def.sql_mode, def.params, def.returns,
+                                def.body, chistics, def.definer,
+                                def.created, def.modified,
+                                def.creation_ctx));
+
   if (!(table= open_proc_table_for_read(thd, &open_tables_state_backup)))
     DBUG_RETURN(SP_OPEN_TABLE_FAILED);
 
@@ -652,11 +665,30 @@ db_find_routine(THD *thd, stored_procedure_type type, sp_name *name,
   chistics.comment.str= ptr;
   chistics.comment.length= length;
 
+  warn_count= thd->warning_info->statement_warn_count();
   creation_ctx= Stored_routine_creation_ctx::load_from_db(thd, name, table);
 
   close_system_tables(thd, &open_tables_state_backup);
   table= 0;
 
+  /*
+    Share the definition unless loading it produced warnings, which
+    other threads would not get.
+  */
+  if (creation_ctx &&
+      thd->warning_info->statement_warn_count() == warn_count)
+  {
+    def.sql_mode= sql_mode;
+    def.params= params;
+    def.returns= returns;
+    def.body= body;
+    def.definer= definer;
+    def.created= created;
+    def.modified= modified;
+    def.creation_ctx= creation_ctx;
+    sp_definition_cache_insert(type, name, cache_version, &def);
+  }
+
   ret= db_load_routine(thd, type, name, sphp,
                        sql_mode, params, returns, body, chistics,
                        definer, created, modified, creation_ctx);
@@ -24,6 +24,40 @@
 static mysql_mutex_t Cversion_lock;
 static ulong volatile Cversion= 0;
 
+/*
+  Routine definitions shared by all threads (see sp_definition).
+*/
+
+static mysql_mutex_t Cdefinitions_lock;
+static HASH Cdefinitions;
+/*
+  Version of the shared definitions. It changes with Cversion, and also
+  when mysql.proc is changed directly, which the per-thread caches of
+  parsed routines ignore.
+*/
+static ulong volatile Cdefinitions_version= 0;
+
+/*
+  An entry of the shared definition cache. It lives in its own MEM_ROOT,
+  and threads only get copies of it, so it can be removed at any time.
+*/
+
+struct sp_cached_definition
+{
+  MEM_ROOT mem_root;
+  /* Cdefinitions_version before the definition was read from mysql.proc. */
+  ulong version;
+  /* Type of the routine followed by its qualified name. */
+  LEX_STRING key;
+  sp_definition def;
+  st_sp_chistics chistics;
+};
+
+extern "C" uchar *hash_get_key_for_sp_definition(const uchar *ptr,
+                                                 size_t *plen,
+                                                 my_bool first);
+extern "C" void hash_free_sp_definition(void *p);
+
 
 /*
   Cache of stored routines. 
@@ -80,11 +114,12 @@ private:
 }; // class sp_cache
 
 #ifdef HAVE_PSI_INTERFACE
-static PSI_mutex_key key_Cversion_lock;
+static PSI_mutex_key key_Cversion_lock, key_Cdefinitions_lock;
 
 static PSI_mutex_info all_sp_cache_mutexes[]=
 {
-  { &key_Cversion_lock, "Cversion_lock", PSI_FLAG_GLOBAL}
+  { &key_Cversion_lock, "Cversion_lock", PSI_FLAG_GLOBAL},
+  { &key_Cdefinitions_lock, "Cdefinitions_lock", PSI_FLAG_GLOBAL}
 };
 
 static void init_sp_cache_psi_keys(void)
@@ -109,6 +144,10 @@ void sp_cache_init()
 #endif
 
   mysql_mutex_init(key_Cversion_lock, &Cversion_lock, MY_MUTEX_INIT_FAST);
+  mysql_mutex_init(key_Cdefinitions_lock, &Cdefinitions_lock,
+                   MY_MUTEX_INIT_FAST);
+  my_hash_init(&Cdefinitions, system_charset_info, 0, 0, 0,
+               hash_get_key_for_sp_definition, hash_free_sp_definition, 0);
 }
 
 
@@ -137,6 +176,8 @@ void sp_cache_clear(sp_cache **cp)
 
 void sp_cache_end()
 {
+  my_hash_free(&Cdefinitions);
+  mysql_mutex_destroy(&Cdefinitions_lock);
   mysql_mutex_destroy(&Cversion_lock);
 }
 
@@ -213,7 +254,10 @@ sp_head *sp_cache_lookup(sp_cache **cp, sp_name *name)
 void sp_cache_invalidate()
 {
   DBUG_PRINT("info",("sp_cache: invalidating"));
-  thread_safe_increment(Cversion, &Cversion_lock);
+  mysql_mutex_lock(&Cversion_lock);
+  Cversion++;
+  Cdefinitions_version++;
+  mysql_mutex_unlock(&Cversion_lock);
 }
 
 
@@ -263,6 +307,177 @@ sp_cache_enforce_limit(sp_cache *c, ulong upper_limit_for_elements)
    c->enforce_limit(upper_limit_for_elements);
 }
 
+/**
+  Return the current version of the shared definition cache.
+*/
+
+ulong sp_definition_cache_version()
+{
+  return Cdefinitions_version;
+}
+
+
+/**
+  Invalidate all shared definitions if a table is mysql.proc.
+
+  This is called when a statement write locks a system table or removes a
+  table from the table definition cache, so that definitions changed by
+  statements other than CREATE/ALTER/DROP PROCEDURE/FUNCTION are read
+  again. Routines already parsed by a thread stay in its cache.
+
+  @param[in] db          Database of the table
+  @param[in] table_name  Name of the table
+*/
+
+void sp_cache_invalidate_table(const char *db, const char *table_name)
+{
+  if (!strcmp(table_name, "proc") && !strcmp(db, MYSQL_SCHEMA_NAME.str))
+    thread_safe_increment(Cdefinitions_version, &Cversion_lock);
+}
+
+
+static bool make_definition_key(char *key, size_t *length, int type,
+                                sp_name *name)
+{
+  if (name->m_qname.length + 1 > NAME_LEN * 2 + 2)
+    return TRUE;
+  key[0]= (char) type;
+  memcpy(key + 1, name->m_qname.str, name->m_qname.length);
+  *length= name->m_qname.length + 1;
+  return FALSE;
+}
+
+
+/*
+  Copy a routine definition and the strings it points to into a MEM_ROOT.
+  The characteristics are copied into to->chistics.
+*/
+
+static bool copy_definition(MEM_ROOT *mem_root, const sp_definition *from,
+                            sp_definition *to)
+{
+  st_sp_chistics *chistics= to->chistics;
+
+  *to= *from;
+  to->chistics= chistics;
+  *chistics= *from->chistics;
+  if (chistics->comment.length &&
+      !(chistics->comment.str= strmake_root(mem_root,
+                                            from->chistics->comment.str,
+                                            from->chistics->comment.length)))
+    return TRUE;
+  return (!(to->params= strdup_root(mem_root, from->params)) ||
+          !(to->returns= strdup_root(mem_root, from->returns)) ||
+          !(to->body= strdup_root(mem_root, from->body)) ||
+          !(to->definer= strdup_root(mem_root, from->definer)) ||
+          !(to->creation_ctx= from->creation_ctx->clone(mem_root)));
+}
+
+
+/**
+  Copy the definition of a routine from the shared definition cache.
+
+  @param[in]  type      Type of the routine (TYPE_ENUM_PROCEDURE/...)
+  @param[in]  name      Name of the routine
+  @param[in]  mem_root  Memory for the copy
+  @param[out] def       Definition. def->chistics must point to the
+                        characteristics to fill.
+
+  @return TRUE if an up to date definition was found and copied,
+          FALSE otherwise.
+*/
+
+bool sp_definition_cache_lookup(int type, sp_name *name, MEM_ROOT *mem_root,
+                                sp_definition *def)
+{
+  char key[NAME_LEN * 2 + 2];
+  size_t key_length;
+  sp_cached_definition *entry;
+  bool found= FALSE;
+
+  if (make_definition_key(key, &key_length, type, name))
+    return FALSE;
+
+  mysql_mutex_lock(&Cdefinitions_lock);
+  if ((entry= (sp_cached_definition *) my_hash_search(&Cdefinitions,
+                                                      (uchar *) key,
+                                                      key_length)))
+  {
+    /* Reading a ulong variable with no lock. */
+    if (entry->version < Cdefinitions_version)
+      my_hash_delete(&Cdefinitions, (uchar *) entry);
+    else
+      found= !copy_definition(mem_root, &entry->def, def);
+  }
+  mysql_mutex_unlock(&Cdefinitions_lock);
+  return found;
+}
+
+
+/**
+  Put the definition of a routine into the shared definition cache.
+
+  @param[in] type     Type of the routine (TYPE_ENUM_PROCEDURE/...)
+  @param[in] name     Name of the routine
+  @param[in] version  Value of sp_definition_cache_version() before the
+                      definition was read from mysql.proc
+  @param[in] def      Definition
+
+  @note
+    The cache is emptied when it has stored_program_cache entries, like
+    the per-thread caches.
+*/
+
+void sp_definition_cache_insert(int type, sp_name *name, ulong version,
+                                const sp_definition *def)
+{
+  char key[NAME_LEN * 2 + 2];
+  size_t key_length;
+  MEM_ROOT own_root;
+  sp_cached_definition *entry, *old_entry;
+
+  if (version < Cdefinitions_version ||
+      make_definition_key(key, &key_length, type, name))
+    return;
+
+  init_sql_alloc(&own_root, 1024, 0);
+  if (!(entry= (sp_cached_definition *) alloc_root(&own_root,
+                                                   sizeof(*entry))) ||
+      !(entry->key.str= (char *) memdup_root(&own_root, key, key_length)))
+  {
+    free_root(&own_root, MYF(0));
+    return;
+  }
+  entry->key.length= key_length;
+  entry->version= version;
+  entry->def.chistics= &entry->chistics;
+  if (copy_definition(&own_root, def, &entry->def))
+  {
+    free_root(&own_root, MYF(0));
+    return;
+  }
+  memcpy(&entry->mem_root, &own_root, sizeof(MEM_ROOT));
+
+  mysql_mutex_lock(&Cdefinitions_lock);
+  if ((old_entry= (sp_cached_definition *) my_hash_search(&Cdefinitions,
+                                                          (uchar *) key,
+                                                          key_length)))
+  {
+    if (old_entry->version > version)
+    {
+      mysql_mutex_unlock(&Cdefinitions_lock);
+      hash_free_sp_definition(entry);
+      return;
+    }
+    my_hash_delete(&Cdefinitions, (uchar *) old_entry);
+  }
+  if (Cdefinitions.records >= stored_program_cache_size)
+    my_hash_reset(&Cdefinitions);
+  if (my_hash_insert(&Cdefinitions, (uchar *) entry))
+    hash_free_sp_definition(entry);
+  mysql_mutex_unlock(&Cdefinitions_lock);
+}
+
 /*************************************************************************
   Internal functions 
  *************************************************************************/
@@ -287,6 +502,26 @@ void hash_free_sp_head(void *p)
 }
 
 
+uchar *hash_get_key_for_sp_definition(const uchar *ptr, size_t *plen,
+                                      my_bool first)
+{
+  sp_cached_definition *entry= (sp_cached_definition *) ptr;
+  *plen= entry->key.length;
+  return (uchar *) entry->key.str;
+}
+
+
+void hash_free_sp_definition(void *p)
+{
+  sp_cached_definition *entry= (sp_cached_definition *) p;
+  MEM_ROOT own_root;
+
+  /* The entry itself is allocated in the MEM_ROOT. */
+  memcpy(&own_root, &entry->mem_root, sizeof(MEM_ROOT));
+  free_root(&own_root, MYF(0));
+}
+
+
 sp_cache::sp_cache()
 {
   init();
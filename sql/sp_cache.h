@@ -33,6 +33,32 @@
 class sp_head;
 class sp_cache;
 class sp_name;
+class Stored_program_creation_ctx;
+struct st_sp_chistics;
+struct st_mem_root;
+
+/*
+  Definition of a stored routine as it is read from mysql.proc.
+
+  Besides the per-thread caches of parsed routines, the definitions are
+  kept in one cache shared by all threads, so that a thread which does not
+  have a routine in its own cache parses it without reading mysql.proc.
+  The parsed sp_head objects themselves are not shared, since executing a
+  routine changes its instructions.
+*/
+
+struct sp_definition
+{
+  ulonglong sql_mode;
+  const char *params;
+  const char *returns;
+  const char *body;
+  const char *definer;
+  longlong created;
+  longlong modified;
+  st_sp_chistics *chistics;
+  Stored_program_creation_ctx *creation_ctx;
+};
 
 /*
   Cache usage scenarios:
@@ -53,6 +79,13 @@ class sp_name;
   
   3. Before thread exit:
     sp_cache_clear();
+
+  4. Loading a routine which is not in the thread's cache:
+    // copy the definition if it is up to date
+    sp_definition_cache_lookup();
+
+    // otherwise read mysql.proc and share what was read
+    sp_definition_cache_insert();
 */
 
 void sp_cache_init();
@@ -64,5 +97,11 @@ void sp_cache_invalidate();
 void sp_cache_flush_obsolete(sp_cache **cp, sp_head **sp);
 ulong sp_cache_version();
 void sp_cache_enforce_limit(sp_cache *cp, ulong upper_limit_for_elements);
+ulong sp_definition_cache_version();
+void sp_cache_invalidate_table(const char *db, const char *table_name);
+bool sp_definition_cache_lookup(int type, sp_name *name,
+                                st_mem_root *mem_root, sp_definition *def);
+void sp_definition_cache_insert(int type, sp_name *name, ulong version,
+                                const sp_definition *def);
 
 #endif /* _SP_CACHE_H_ */
@@ -546,7 +546,9 @@ sp_head::sp_head()
    unsafe_flags(0),
    m_recursion_level(0),
    m_next_cached_sp(0),
-   m_cont_level(0)
+   m_cont_level(0),
+   m_trg_rcontext(0),
+   m_trg_call_arena(&m_trg_mem_root, STMT_INITIALIZED_FOR_SP)
 {
   const LEX_STRING str_reset= { NULL, 0 };
 
@@ -770,6 +772,7 @@ sp_head::~sp_head()
   /* sp_head::restore_thd_mem_root() must already have been called. */
   DBUG_ASSERT(m_thd == NULL);
 
+  free_trigger_context();
   for (uint ip = 0 ; (i = get_instr(ip)) ; ip++)
     delete i;
   delete_dynamic(&m_instr);
@@ -1635,9 +1638,9 @@ set_routine_security_ctx(THD *thd, sp_head *sp, bool is_proc,
                            information about definer's privileges
                            on subject table
 
-  @todo
-    - TODO: we should create sp_rcontext once per command and reuse it
-    on subsequent executions of a trigger.
+  @note
+    The runtime context is created for the first row of a statement and
+    used for its other rows.
 
   @retval
     FALSE  on success
@@ -1654,93 +1657,131 @@ sp_head::execute_trigger(THD *thd,
   sp_rcontext *octx = thd->spcont;
   sp_rcontext *nctx = NULL;
   bool err_status= FALSE;
-  MEM_ROOT call_mem_root;
-  Query_arena call_arena(&call_mem_root, Query_arena::STMT_INITIALIZED_FOR_SP);
   Query_arena backup_arena;
 
   DBUG_ENTER("sp_head::execute_trigger");
   DBUG_PRINT("info", ("trigger %s", m_name.str));
 
+  /*
+    The runtime context and the privileges checked for the first row of a
+    statement are used for its other rows.
+  */
+  if (m_trg_rcontext &&
+      (m_trg_query_id != thd->query_id || m_trg_caller_ctx != octx))
+    free_trigger_context();
+
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
   Security_context *save_ctx= NULL;
 
+  if (m_trg_rcontext)
+  {
+    if (m_trg_definer_ctx)
+    {
+      save_ctx= thd->security_ctx;
+      thd->security_ctx= &m_security_ctx;
+    }
+  }
+  else
+  {
+    if (m_chistics->suid != SP_IS_NOT_SUID &&
+        m_security_ctx.change_security_context(thd,
+                                               &m_definer_user,
+                                               &m_definer_host,
+                                               &m_db,
+                                               &save_ctx))
+      DBUG_RETURN(TRUE);
 
-  if (m_chistics->suid != SP_IS_NOT_SUID &&
-      m_security_ctx.change_security_context(thd,
-                                             &m_definer_user,
-                                             &m_definer_host,
-                                             &m_db,
-                                             &save_ctx))
-    DBUG_RETURN(TRUE);
-
-  /*
-    Fetch information about table-level privileges for subject table into
-    GRANT_INFO instance. The access check itself will happen in
-    Item_trigger_field, where this information will be used along with
-    information about column-level privileges.
-  */
+    /*
+      Fetch information about table-level privileges for subject table into
+      GRANT_INFO instance. The access check itself will happen in
+      Item_trigger_field, where this information will be used along with
+      information about column-level privileges.
+    */
 
-  fill_effective_table_privileges(thd,
-                                  grant_info,
-                                  db_name->str,
-                                  table_name->str);
+    fill_effective_table_privileges(thd,
+                                    grant_info,
+                                    db_name->str,
+                                    table_name->str);
 
-  /* Check that the definer has TRIGGER privilege on the subject table. */
+    /* Check that the definer has TRIGGER privilege on the subject table. */
 
-  if (!(grant_info->privilege & TRIGGER_ACL))
-  {
-    char priv_desc[128];
-    get_privilege_desc(priv_desc, sizeof(priv_desc), TRIGGER_ACL);
+    if (!(grant_info->privilege & TRIGGER_ACL))
+    {
+      char priv_desc[128];
+      get_privilege_desc(priv_desc, sizeof(priv_desc), TRIGGER_ACL);
 
-    my_error(ER_TABLEACCESS_DENIED_ERROR, MYF(0), priv_desc,
-             thd->security_ctx->priv_user, thd->security_ctx->host_or_ip,
-             table_name->str);
+      my_error(ER_TABLEACCESS_DENIED_ERROR, MYF(0), priv_desc,
+               thd->security_ctx->priv_user, thd->security_ctx->host_or_ip,
+               table_name->str);
 
-    m_security_ctx.restore_security_context(thd, save_ctx);
-    DBUG_RETURN(TRUE);
+      m_security_ctx.restore_security_context(thd, save_ctx);
+      DBUG_RETURN(TRUE);
+    }
   }
 #endif // NO_EMBEDDED_ACCESS_CHECKS
 
-  /*
-    Prepare arena and memroot for objects which lifetime is whole
-    duration of trigger call (sp_rcontext, it's tables and items,
-    sp_cursor and Item_cache holders for case expressions).  We can't
-    use caller's arena/memroot for those objects because in this case
-    some fixed amount of memory will be consumed for each trigger
-    invocation and so statements which involve lot of them will hog
-    memory.
-
-    TODO: we should create sp_rcontext once per command and reuse it
-    on subsequent executions of a trigger.
-  */
-  init_sql_alloc(&call_mem_root, MEM_ROOT_BLOCK_SIZE, 0);
-  thd->set_n_backup_active_arena(&call_arena, &backup_arena);
-
-  if (!(nctx= new sp_rcontext(m_pcont, 0, octx)) ||
-      nctx->init(thd))
+  if (!m_trg_rcontext)
   {
-    err_status= TRUE;
-    goto err_with_cleanup;
-  }
+    /*
+      Prepare arena and memroot for objects which lifetime is whole
+      duration of trigger call (sp_rcontext, it's tables and items,
+      sp_cursor and Item_cache holders for case expressions).  We can't
+      use caller's arena/memroot for those objects because in this case
+      some fixed amount of memory will be consumed for each trigger
+      invocation and so statements which involve lot of them will hog
+      memory.
+    */
+    init_sql_alloc(&m_trg_mem_root, MEM_ROOT_BLOCK_SIZE, 0);
+    m_trg_call_arena.free_list= NULL;
+    thd->set_n_backup_active_arena(&m_trg_call_arena, &backup_arena);
+
+    if (!(nctx= new sp_rcontext(m_pcont, 0, octx)) ||
+        nctx->init(thd))
+    {
+      delete nctx;
+      thd->restore_active_arena(&m_trg_call_arena, &backup_arena);
+      m_trg_call_arena.free_items();
+      free_root(&m_trg_mem_root, MYF(0));
+      err_status= TRUE;
+      goto err_with_cleanup;
+    }
 
 #ifndef DBUG_OFF
-  nctx->sp= this;
+    nctx->sp= this;
 #endif
 
+    m_trg_rcontext= nctx;
+    m_trg_query_id= thd->query_id;
+    m_trg_caller_ctx= octx;
+#ifndef NO_EMBEDDED_ACCESS_CHECKS
+    m_trg_definer_ctx= save_ctx != NULL;
+#endif
+  }
+  else
+  {
+    nctx= m_trg_rcontext;
+    thd->set_n_backup_active_arena(&m_trg_call_arena, &backup_arena);
+  }
+
   thd->spcont= nctx;
 
   err_status= execute(thd, FALSE);
 
-err_with_cleanup:
-  thd->restore_active_arena(&call_arena, &backup_arena);
+  thd->restore_active_arena(&m_trg_call_arena, &backup_arena);
+
+  /*
+    Cursors are allocated in the call arena on every execution, so
+    the context of a trigger which has cursors is not kept.
+  */
+  if (err_status || !nctx->is_reusable() ||
+      m_pcont->max_cursor_index())
+    free_trigger_context();
 
+err_with_cleanup:
 #ifndef NO_EMBEDDED_ACCESS_CHECKS
   m_security_ctx.restore_security_context(thd, save_ctx);
 #endif // NO_EMBEDDED_ACCESS_CHECKS
 
-  delete nctx;
-  call_arena.free_items();
-  free_root(&call_mem_root, MYF(0));
   thd->spcont= octx;
 
   if (thd->killed)
@@ -1750,6 +1791,23 @@ err_with_cleanup:
 }
 
 
+/**
+  Free the runtime context execute_trigger() kept for the rows of a
+  statement.
+*/
+
+void sp_head::free_trigger_context()
+{
+  if (m_trg_rcontext)
+  {
+    delete m_trg_rcontext;
+    m_trg_rcontext= NULL;
+    m_trg_call_arena.free_items();
+    free_root(&m_trg_mem_root, MYF(0));
+  }
+}
+
+
 /**
   Execute a function.
 
@@ -2939,6 +2997,9 @@ sp_lex_keeper::reset_lex_and_exec_core(THD *thd, uint *nextp,
   int res= 0;
   DBUG_ENTER("reset_lex_and_exec_core");
 
+  if (open_tables && is_simple_expression())
+    DBUG_RETURN(exec_simple_expression(thd, nextp, instr));
+
   /*
     The flag is saved at the entry to the following substatement.
     It's reset further in the common code part.
@@ -3057,6 +3118,54 @@ sp_lex_keeper::reset_lex_and_exec_core(THD *thd, uint *nextp,
 }
 
 
+/**
+  Execute an instruction which evaluates a simple expression (see
+  sp_lex_keeper::is_simple_expression()).
+
+  This is the part of reset_lex_and_exec_core() such an instruction needs:
+  it opens nothing, so no statement is committed, no tables are closed and
+  no metadata locks are released afterwards.
+
+  @note
+    The Items of the expression are still fixed on every execution, since
+    fix_fields() may register item tree changes which are rolled back
+    after each instruction.
+
+  @return
+    0/non-0 - Success/Failure
+*/
+
+int
+sp_lex_keeper::exec_simple_expression(THD *thd, uint *nextp, sp_instr *instr)
+{
+  int res;
+  DBUG_ENTER("sp_lex_keeper::exec_simple_expression");
+
+  bool parent_modified_non_trans_table= thd->transaction.stmt.modified_non_trans_table;
+  thd->transaction.stmt.modified_non_trans_table= FALSE;
+  DBUG_ASSERT(!thd->derived_tables);
+  DBUG_ASSERT(thd->change_list.is_empty());
+
+  thd->lex= m_lex;
+  thd->set_query_id(next_query_id());
+
+  /* This is all reinit_stmt_before_use() does for such a LEX. */
+  m_lex->thd= thd;
+  m_lex->unit.set_thd(thd);
+  m_lex->current_select= &m_lex->select_lex;
+  m_lex->allow_sum_func= 0;
+  m_lex->in_sum_func= NULL;
+
+  res= instr->exec_core(thd, nextp);
+  DBUG_PRINT("info",("exec_core returned: %d", res));
+
+  thd->rollback_item_tree_changes();
+  thd->stmt_arena->state= Query_arena::STMT_EXECUTED;
+  thd->transaction.stmt.modified_non_trans_table|= parent_modified_non_trans_table;
+  DBUG_RETURN(res || thd->is_error());
+}
+
+
 /*
   sp_instr class functions
 */
@@ -520,6 +520,19 @@ private:
   */
   HASH m_sptabs;
 
+  /**
+    Runtime context of a trigger, which execute_trigger() keeps for the
+    other rows of the statement it was created for.
+  */
+  sp_rcontext *m_trg_rcontext;
+  MEM_ROOT m_trg_mem_root;      ///< Memory of m_trg_rcontext
+  Query_arena m_trg_call_arena; ///< Items of m_trg_rcontext
+  query_id_t m_trg_query_id;    ///< Statement of m_trg_rcontext
+  sp_rcontext *m_trg_caller_ctx;///< Runtime context of the statement
+  bool m_trg_definer_ctx;       ///< Runs with m_security_ctx
+
+  void free_trigger_context();
+
   bool
   execute(THD *thd, bool merge_da_on_success);
 
@@ -705,6 +718,20 @@ public:
   }
 private:
 
+  /**
+    Check if the LEX only holds an expression which uses neither tables,
+    nor subqueries, nor stored functions, so that evaluating it needs
+    no statement setup, table opening or statement commit.
+  */
+  bool is_simple_expression() const
+  {
+    return !m_lex->query_tables && !lex_query_tables_own_last &&
+           !m_lex->uses_stored_routines() &&
+           !m_lex->all_selects_list->next_select_in_list();
+  }
+
+  int exec_simple_expression(THD *thd, uint *nextp, sp_instr *instr);
+
   LEX *m_lex;
   /**
     Indicates whenever this sp_lex_keeper instance responsible
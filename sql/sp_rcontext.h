@@ -223,6 +223,16 @@ class sp_rcontext : public Sql_alloc
     return m_cstack[i];
   }
 
+  /*
+    Check that an execution left no active handlers or open cursors
+    behind, so that the context can be used for another execution.
+  */
+  inline bool
+  is_reusable() const
+  {
+    return !m_hcount && !m_hsp && !m_ihsp && !m_ccount;
+  }
+
   /*
     CASE expressions support.
   */
@@ -17,6 +17,7 @@
 #include "sql_table.h"                       // mysql_alter_table,
                                              // mysql_exchange_partition
 #include "sql_alter.h"
+#include "key.h"                             // key_copy
 
 bool Alter_table_statement::execute(THD *thd)
 {
@@ -107,3 +108,250 @@ bool Alter_table_statement::execute(THD *thd)
 
   DBUG_RETURN(result);
 }
+
+
+/**
+  Primary keys of the rows that a transaction changed in a table with
+  an Online_alter_log. Kept in THD::online_alter_keys until the end of
+  the transaction.
+*/
+
+struct Online_alter_trans_keys
+{
+  Online_alter_trans_keys *next;
+  Online_alter_log *log;
+  DYNAMIC_ARRAY keys;
+};
+
+
+Online_alter_log::Online_alter_log(uint key_length_arg)
+  :key_length(key_length_arg), users(1), failed(FALSE)
+{
+  mysql_mutex_init(key_LOCK_online_alter_log, &lock, MY_MUTEX_INIT_FAST);
+  my_hash_init(&keys, &my_charset_bin, 256, 0, key_length, NULL, NULL, 0);
+  init_alloc_root(&mem_root, 8192, 0);
+}
+
+
+Online_alter_log::~Online_alter_log()
+{
+  my_hash_free(&keys);
+  free_root(&mem_root, MYF(0));
+  mysql_mutex_destroy(&lock);
+}
+
+
+/**
+  Create a log for the primary key of a table and attach it to the share.
+
+  Must be called while no other connection can change the table, i.e.
+  with an upgradable metadata lock that blocks writes.
+*/
+
+Online_alter_log *Online_alter_log::attach(TABLE_SHARE *share)
+{
+  Online_alter_log *log;
+  DBUG_ASSERT(share->primary_key != MAX_KEY);
+  DBUG_ASSERT(!share->online_alter_log);
+
+  if (!(log= new Online_alter_log(share->key_info[share->primary_key].
+                                  key_length)))
+    return NULL;
+  mysql_mutex_lock(&share->LOCK_ha_data);
+  share->online_alter_log= log;
+  mysql_mutex_unlock(&share->LOCK_ha_data);
+  return log;
+}
+
+
+/**
+  Stop logging the changes of the table. Transactions that still have
+  keys for the log keep it until they end.
+*/
+
+void Online_alter_log::detach(TABLE_SHARE *share)
+{
+  Online_alter_log *log;
+
+  mysql_mutex_lock(&share->LOCK_ha_data);
+  log= share->online_alter_log;
+  share->online_alter_log= NULL;
+  mysql_mutex_unlock(&share->LOCK_ha_data);
+  if (log)
+    log->release();
+}
+
+
+void Online_alter_log::acquire()
+{
+  mysql_mutex_lock(&lock);
+  users++;
+  mysql_mutex_unlock(&lock);
+}
+
+
+void Online_alter_log::release()
+{
+  uint left;
+  mysql_mutex_lock(&lock);
+  left= --users;
+  mysql_mutex_unlock(&lock);
+  if (!left)
+    delete this;
+}
+
+
+/**
+  Add the keys of an ended transaction to the log.
+
+  This can't fail the transaction, which has already ended: if we run
+  out of memory, the ALTER TABLE that reads the log fails instead.
+*/
+
+void Online_alter_log::add_keys(const uchar *key, uint count)
+{
+  const uchar *end= key + count * key_length;
+  mysql_mutex_lock(&lock);
+  for (; key < end && !failed; key+= key_length)
+  {
+    uchar *copy;
+    if (my_hash_search(&keys, key, key_length))
+      continue;
+    if (!(copy= (uchar*) memdup_root(&mem_root, key, key_length)) ||
+        my_hash_insert(&keys, copy))
+      failed= TRUE;
+  }
+  mysql_mutex_unlock(&lock);
+}
+
+
+/**
+  Move all keys in the log to an array.
+
+  @retval FALSE  ok
+  @retval TRUE   out of memory, some changes of the table were lost
+*/
+
+bool Online_alter_log::take_keys(DYNAMIC_ARRAY *to)
+{
+  bool error;
+  mysql_mutex_lock(&lock);
+  for (ulong i= 0; i < keys.records && !failed; i++)
+  {
+    if (insert_dynamic(to, my_hash_element(&keys, i)))
+      failed= TRUE;
+  }
+  my_hash_reset(&keys);
+  free_root(&mem_root, MYF(MY_MARK_BLOCKS_FREE));
+  error= failed;
+  mysql_mutex_unlock(&lock);
+  return error;
+}
+
+
+/**
+  Store the primary key of a record that isn't in table->record[0].
+*/
+
+static void online_alter_key_image(TABLE *table, const uchar *record,
+                                   uchar *key)
+{
+  KEY *key_info= table->key_info + table->s->primary_key;
+  KEY_PART_INFO *key_part, *end= key_info->key_part + key_info->key_parts;
+  my_ptrdiff_t diff= record - table->record[0];
+
+  for (key_part= key_info->key_part; key_part < end; key_part++)
+    key_part->field->move_field_offset(diff);
+  key_copy(key, (uchar*) record, key_info, 0, TRUE);
+  for (key_part= key_info->key_part; key_part < end; key_part++)
+    key_part->field->move_field_offset(-diff);
+}
+
+
+/**
+  Remember the primary key of a changed row for the Online_alter_log of
+  the table.
+
+  Called by the handler after a row was written, updated or deleted while
+  table->s->online_alter_log is set.
+
+  @param table     The changed table
+  @param old_data  The row before the change, or NULL for an insert
+  @param new_data  The row after the change, or NULL for a delete
+
+  @return 0 or HA_ERR_OUT_OF_MEM
+*/
+
+int online_alter_log_row(TABLE *table, const uchar *old_data,
+                         const uchar *new_data)
+{
+  THD *thd= table->in_use;
+  TABLE_SHARE *share= table->s;
+  Online_alter_log *log= share->online_alter_log;
+  Online_alter_trans_keys *trans;
+  uchar old_key[MAX_KEY_LENGTH], new_key[MAX_KEY_LENGTH];
+
+  /* Only compare the pointer: the log may be gone if we don't use it. */
+  for (trans= thd->online_alter_keys; trans; trans= trans->next)
+  {
+    if (trans->log == log)
+      break;
+  }
+  if (!trans)
+  {
+    mysql_mutex_lock(&share->LOCK_ha_data);
+    if ((log= share->online_alter_log))
+      log->acquire();
+    mysql_mutex_unlock(&share->LOCK_ha_data);
+    if (!log)
+      return 0;                                 // ALTER TABLE has ended
+    if (!(trans= (Online_alter_trans_keys*)
+          my_malloc(sizeof(*trans), MYF(MY_WME))))
+    {
+      log->release();
+      return HA_ERR_OUT_OF_MEM;
+    }
+    trans->log= log;
+    my_init_dynamic_array(&trans->keys, log->key_length, 64, 64);
+    trans->next= thd->online_alter_keys;
+    thd->online_alter_keys= trans;
+  }
+  log= trans->log;
+
+  if (old_data)
+  {
+    online_alter_key_image(table, old_data, old_key);
+    if (insert_dynamic(&trans->keys, old_key))
+      return HA_ERR_OUT_OF_MEM;
+  }
+  if (new_data)
+  {
+    online_alter_key_image(table, new_data, new_key);
+    if ((!old_data || memcmp(old_key, new_key, log->key_length)) &&
+        insert_dynamic(&trans->keys, new_key))
+      return HA_ERR_OUT_OF_MEM;
+  }
+  return 0;
+}
+
+
+/**
+  Add the keys of the rows changed by the transaction to the logs.
+
+  Called after the transaction was committed or rolled back, so that
+  ALTER TABLE reads the committed rows once it has taken the keys.
+*/
+
+void online_alter_log_trans_end(THD *thd)
+{
+  Online_alter_trans_keys *trans;
+  while ((trans= thd->online_alter_keys))
+  {
+    thd->online_alter_keys= trans->next;
+    trans->log->add_keys((uchar*) trans->keys.buffer,
+                         trans->keys.elements);
+    trans->log->release();
+    delete_dynamic(&trans->keys);
+    my_free(trans);
+  }
+}
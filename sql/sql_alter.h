@@ -63,4 +63,54 @@ public:
   bool execute(THD *thd);
 };
 
+
+/**
+  Change log of ALTER ONLINE TABLE.
+
+  While ALTER ONLINE TABLE copies a table that other connections may
+  change (see HA_CAN_ONLINE_ALTER), the log is attached to the TABLE_SHARE
+  of the table. handler::ha_write_row(), ha_update_row() and
+  ha_delete_row() remember the primary key of every changed row for the
+  transaction (online_alter_log_row()), and the keys are added to the log
+  after the transaction has ended (online_alter_log_trans_end()).
+  ALTER TABLE takes the keys from the log and copies the current version
+  of these rows again; the keys left at the end are applied under an
+  exclusive metadata lock, just before the tables are switched.
+
+  The log is reference counted: the TABLE_SHARE holds one reference while
+  the log is attached to it, and every transaction with keys for the log
+  holds one until its keys are added.
+*/
+
+class Online_alter_log
+{
+public:
+  static Online_alter_log *attach(TABLE_SHARE *share);
+  static void detach(TABLE_SHARE *share);
+
+  void add_keys(const uchar *keys, uint count);
+  bool take_keys(DYNAMIC_ARRAY *to);
+  void acquire();
+  void release();
+
+  /** Length of the primary key images in the log */
+  const uint key_length;
+
+private:
+  Online_alter_log(uint key_length_arg);
+  ~Online_alter_log();
+
+  mysql_mutex_t lock;
+  /** Distinct key images, allocated in mem_root */
+  HASH keys;
+  MEM_ROOT mem_root;
+  uint users;
+  /** Keys were lost because we ran out of memory */
+  bool failed;
+};
+
+int online_alter_log_row(TABLE *table, const uchar *old_data,
+                         const uchar *new_data);
+void online_alter_log_trans_end(THD *thd);
+
 #endif
@@ -9444,6 +9444,9 @@ void tdc_remove_table(THD *thd, enum_tdc_remove_table_type remove_type,
 
   if (! has_lock)
     mysql_mutex_unlock(&LOCK_open);
+
+  /* mysql.proc may have been dropped, altered or replaced. */
+  sp_cache_invalidate_table(db, table_name);
   DBUG_VOID_RETURN;
 }
 
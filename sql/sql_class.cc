@@ -63,6 +63,7 @@
 #include "sql_parse.h"                          // is_update_query
 #include "sql_callback.h"
 #include "sql_connect.h"
+#include "sql_alter.h"                          // online_alter_log_trans_end
 
 /*
   The following is used to initialise Table_ident with a internal
@@ -815,6 +816,7 @@ THD::THD()
    failed_com_change_user(0),
    is_fatal_error(0),
    transaction_rollback_request(0),
+   online_alter_keys(0),
    is_fatal_sub_stmt_error(0),
    rand_used(0),
    time_zone_used(0),
@@ -1396,6 +1398,7 @@ void THD::cleanup(void)
 
   transaction.xid_state.xa_state= XA_NOTR;
   trans_rollback(this);
+  online_alter_log_trans_end(this);
   xid_cache_delete(&transaction.xid_state);
 
   locked_tables_list.unlock_locked_tables(this);
@@ -47,6 +47,7 @@
 
 class Reprepare_observer;
 class Relay_log_info;
+struct Online_alter_trans_keys;
 
 class Query_log_event;
 class Load_log_event;
@@ -639,6 +640,9 @@ typedef struct system_status_var
   ulong filesort_range_count;
   ulong filesort_rows;
   ulong filesort_scan_count;
+  ulong load_data_rows;
+  ulong load_data_read_ahead_blocks;
+  ulong load_data_read_ahead_waits;   /* Parser waited for the file */
   /* Prepared statements and binary protocol */
   ulong com_stmt_prepare;
   ulong com_stmt_reprepare;
@@ -2152,6 +2156,9 @@ public:
   ulong	     rand_saved_seed1, rand_saved_seed2;
   ulong      query_plan_flags; 
   ulong      query_plan_fsort_passes; 
+  /* Time (in microseconds) and peak memory used by range analysis */
+  ulonglong  query_plan_range_opt_time;
+  ulong      query_plan_range_opt_memory;
   pthread_t  real_id;                           /* For debugging */
   my_thread_id  thread_id;
   uint	     tmp_table, global_disable_checkpoint;
@@ -2220,6 +2227,11 @@ public:
     rollback. Reset in ha_rollback.
   */
   bool       transaction_rollback_request;
+  /**
+    Keys of the rows that the current transaction changed in tables
+    which are altered online, see online_alter_log_row().
+  */
+  Online_alter_trans_keys *online_alter_keys;
   /**
     TRUE if we are in a sub-statement and the current error can
     not be safely recovered until we left the sub-statement mode.
@@ -3561,16 +3573,24 @@ public:
   }
 };
 
+class Hash_dedup;
+
 class select_union :public select_result_interceptor
 {
 public:
   TMP_TABLE_PARAM tmp_table_param;
   int write_err; /* Error code from the last send_data->ha_write_row call. */
+  /* Removes duplicates of UNION DISTINCT when the table has no unique key */
+  Hash_dedup *hash_dedup;
+  bool hash_dedup_done;
 public:
   TABLE *table;
   ha_rows records;
 
-  select_union() :write_err(0), table(0), records(0) { tmp_table_param.init(); }
+  select_union()
+    :write_err(0), hash_dedup(0), hash_dedup_done(0), table(0), records(0)
+  { tmp_table_param.init(); }
+  ~select_union();
   int prepare(List<Item> &list, SELECT_LEX_UNIT *u);
   int send_data(List<Item> &items);
   bool send_eof();
@@ -3582,6 +3602,40 @@ public:
                                    bool bit_fields_as_long,
                                    bool create_table);
   TMP_TABLE_PARAM *get_tmp_table_param() { return &tmp_table_param; }
+  bool init_hash_dedup(THD *thd);
+  bool end_hash_dedup();
+  void reset_hash_dedup();
+};
+
+
+/*
+  Sends the rows of a UNION ALL to the final result as they are produced,
+  instead of collecting them in the temporary table of the UNION. The
+  fields of the temporary table are only used to convert each row to the
+  column types of the UNION; the table is never written.
+*/
+
+class select_union_direct :public select_union
+{
+  select_result *result;                        /* The final result */
+  ha_rows offset, limit;                        /* LIMIT of the UNION */
+public:
+  ha_rows sent_rows;
+
+  select_union_direct(select_result *result_arg)
+    :result(result_arg), offset(0), limit(HA_POS_ERROR), sent_rows(0)
+  {}
+  int send_data(List<Item> &items);
+  void set_limit(ha_rows offset_arg, ha_rows limit_arg)
+  {
+    offset= offset_arg;
+    limit= limit_arg;
+  }
+  /* Number of rows the UNION still consumes, HA_POS_ERROR if unlimited */
+  ha_rows rows_wanted()
+  {
+    return limit == HA_POS_ERROR ? HA_POS_ERROR : offset + limit;
+  }
 };
 
 /* Base subselect interface class */
@@ -3773,6 +3827,7 @@ typedef struct st_sort_field {
   Item_result result_type;		/* Type of item */
   bool reverse;				/* if descending sort */
   bool need_strxnfrm;			/* If we have to use strxnfrm() */
+  bool packed;                          /* Stored with length, not padded */
 } SORT_FIELD;
 
 
@@ -3926,6 +3981,78 @@ public:
 };
 
 
+/*
+  Hash_dedup removes duplicate rows from a temporary table that has no
+  unique index over the row.
+
+  Rows are checked one by one as they are written (check_record()), or
+  all at once with a scan of the table (delete_duplicates()). Distinct
+  rows are kept in memory in packed form in a hash table split into
+  partitions by the hash value. Each slot holds a 32-bit fingerprint of
+  the row so that most probes never touch the row itself.
+
+  When the rows take more than max_in_memory_size bytes, the largest
+  partition is dropped from memory ("spilled"); its rows are not checked
+  any more until delete_duplicates() rescans the table for the rows of
+  the spilled partitions. A partition that is the only one left in memory
+  is never spilled, so every scan finishes at least one partition.
+*/
+
+class Hash_dedup :public Sql_alloc
+{
+  enum { PARTITION_BITS= 5, PARTITIONS= 1 << PARTITION_BITS };
+  enum enum_partition_state { PART_ACTIVE, PART_SPILLED, PART_DONE };
+
+  struct Slot
+  {
+    uint32 fingerprint;
+    uchar *row;                                 /* 0 for an empty slot */
+  };
+
+  struct Partition
+  {
+    MEM_ROOT mem_root;                          /* Packed rows */
+    Slot *slots;
+    uint size;                                  /* Number of slots, 2^N */
+    uint count;                                 /* Rows in the partition */
+    size_t memory;                              /* Bytes used */
+    enum_partition_state state;
+  };
+
+  TABLE *table;
+  Field **first_field;
+  ulonglong max_in_memory_size;
+  ulonglong memory_used;
+  uint null_bytes;                              /* One bit per field */
+  uchar *row_buff;                              /* Packed current row */
+  size_t row_buff_length;
+  Partition partitions[PARTITIONS];
+
+  ulonglong hash_record();
+  uchar *pack_record(size_t *length);
+  bool compare_packed(const uchar *row);
+  int check_in_partition(Partition *part, ulonglong hash_value);
+  bool grow(Partition *part);
+  void free_partition(Partition *part, enum_partition_state new_state);
+  void spill_largest();
+  uint partitions_in_state(enum_partition_state state);
+
+public:
+  enum { ROW_UNIQUE= 0, ROW_DUPLICATE= 1, ROW_NOT_CHECKED= 2 };
+
+  Hash_dedup(TABLE *table_arg, Field **first_field_arg,
+             ulonglong max_in_memory_size_arg);
+  ~Hash_dedup();
+  static bool can_dedup(Field **first_field);
+  int check_record();
+  int delete_duplicates(THD *thd, Item *having);
+  /* Don't check the rows in memory; delete_duplicates() will do it */
+  void defer_all();
+  bool has_unchecked_rows() { return partitions_in_state(PART_SPILLED) != 0; }
+  void reset();
+};
+
+
 class multi_delete :public select_result_interceptor
 {
   TABLE_LIST *delete_tables, *table_being_deleted;
@@ -2896,6 +2896,41 @@ pthread_handler_t handle_delayed_insert(void *arg)
         }
         mysql_cond_broadcast(&di->cond_client);
       }
+      /*
+        Wait up to delayed_insert_max_latency milliseconds for more rows,
+        so that they are written in one batch.
+      */
+      if (di->stacked_inserts && delayed_insert_max_latency && !thd->killed &&
+          di->stacked_inserts < delayed_insert_limit &&
+          di->stacked_inserts < delayed_queue_size)
+      {
+        struct timespec abstime;
+        set_timespec_nsec(abstime, delayed_insert_max_latency * 1000000ULL);
+
+        mysql_mutex_unlock(&di->mutex);
+        mysql_mutex_lock(&di->thd.mysys_var->mutex);
+        di->thd.mysys_var->current_mutex= &di->mutex;
+        di->thd.mysys_var->current_cond= &di->cond;
+        mysql_mutex_unlock(&di->thd.mysys_var->mutex);
+        mysql_mutex_lock(&di->mutex);
+        thd_proc_info(&(di->thd), "Waiting for more rows");
+
+        while (!thd->killed &&
+               di->stacked_inserts < delayed_insert_limit &&
+               di->stacked_inserts < delayed_queue_size)
+        {
+          int error= mysql_cond_timedwait(&di->cond, &di->mutex, &abstime);
+          if (error == ETIMEDOUT || error == ETIME)
+            break;
+        }
+        mysql_mutex_unlock(&di->mutex);
+        mysql_mutex_lock(&di->thd.mysys_var->mutex);
+        di->thd.mysys_var->current_mutex= 0;
+        di->thd.mysys_var->current_cond= 0;
+        mysql_mutex_unlock(&di->thd.mysys_var->mutex);
+        mysql_mutex_lock(&di->mutex);
+        thd_proc_info(&(di->thd), 0);
+      }
       if (di->stacked_inserts)
       {
         if (di->handle_inserts())
@@ -3028,9 +3063,16 @@ bool Delayed_insert::handle_inserts(void)
     We can't use row caching when using the binary log because if
     we get a crash, then binary log will contain rows that are not yet
     written to disk, which will cause problems in replication.
+    Otherwise the rows queued so far are also announced as a bulk insert;
+    more rows may be queued meanwhile, so the count can be too low for the
+    engine to turn on its write cache by itself.
   */
   if (!using_bin_log)
+  {
     table->file->extra(HA_EXTRA_WRITE_CACHE);
+    table->file->ha_start_bulk_insert((ha_rows) stacked_inserts);
+  }
+  thread_safe_increment(delayed_insert_batches, &LOCK_delayed_status);
   mysql_mutex_lock(&mutex);
 
   while ((row=rows.get()))
@@ -3156,7 +3198,8 @@ bool Delayed_insert::handle_inserts(void)
           mysql_cond_broadcast(&cond_client);   // If waiting clients
 	thd_proc_info(&thd, "reschedule");
         mysql_mutex_unlock(&mutex);
-	if ((error=table->file->extra(HA_EXTRA_NO_CACHE)))
+	if ((!using_bin_log && (error= table->file->ha_end_bulk_insert())) ||
+            (error= table->file->extra(HA_EXTRA_NO_CACHE)))
 	{
 	  /* This should never happen */
 	  table->file->print_error(error,MYF(0));
@@ -3175,7 +3218,11 @@ bool Delayed_insert::handle_inserts(void)
           goto err;
 	}
 	if (!using_bin_log)
+	{
 	  table->file->extra(HA_EXTRA_WRITE_CACHE);
+	  table->file->ha_start_bulk_insert((ha_rows) stacked_inserts);
+	}
+        thread_safe_increment(delayed_insert_batches, &LOCK_delayed_status);
         mysql_mutex_lock(&mutex);
 	thd_proc_info(&thd, "insert");
       }
@@ -3204,7 +3251,8 @@ bool Delayed_insert::handle_inserts(void)
       thd.binlog_flush_pending_rows_event(TRUE, has_trans))
     goto err;
 
-  if ((error=table->file->extra(HA_EXTRA_NO_CACHE)))
+  if ((!using_bin_log && (error= table->file->ha_end_bulk_insert())) ||
+      (error= table->file->extra(HA_EXTRA_NO_CACHE)))
   {						// This shouldn't happen
     table->file->print_error(error,MYF(0));
     sql_print_error("%s", thd.stmt_da->message());
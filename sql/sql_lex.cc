@@ -1824,6 +1824,7 @@ void st_select_lex_unit::init_query()
   prepared= optimized= executed= 0;
   item= 0;
   union_result= 0;
+  union_direct= 0;
   table= 0;
   fake_select_lex= 0;
   cleaned= 0;
@@ -604,6 +604,7 @@ class THD;
 class select_result;
 class JOIN;
 class select_union;
+class select_union_direct;
 class Procedure;
 
 
@@ -611,13 +612,15 @@ class st_select_lex_unit: public st_select_lex_node {
 protected:
   TABLE_LIST result_table_list;
   select_union *union_result;
+  /* Set if the rows of UNION ALL are sent without the temporary table */
+  select_union_direct *union_direct;
   ulonglong found_rows_for_union;
   bool saved_error;
 
 public:
   // Ensures that at least all members used during cleanup() are initialized.
   st_select_lex_unit()
-    : union_result(NULL), table(NULL), result(NULL),
+    : union_result(NULL), union_direct(NULL), table(NULL), result(NULL),
       cleaned(false),
       fake_select_lex(NULL)
   {
@@ -703,6 +706,8 @@ public:
 
   bool add_fake_select_lex(THD *thd);
   void init_prepare_fake_select_lex(THD *thd);
+  bool use_hash_distinct();
+  bool can_send_union_all_directly();
   inline bool is_prepared() { return prepared; }
   bool change_result(select_result_interceptor *result,
                      select_result_interceptor *old_result);
@@ -34,6 +34,7 @@
                         // Execute_load_query_log_event,
                         // LOG_EVENT_UPDATE_TABLE_MAP_VERSION_F
 #include <m_ctype.h>
+#include <mysys_err.h>   // EE_READ
 #include "rpl_mi.h"
 #include "sql_repl.h"
 #include "sp_head.h"
@@ -58,6 +59,177 @@ XML_TAG::XML_TAG(int l, String f, String v)
 }
 
 
+/*
+  Reads the blocks of a LOAD DATA file ahead of the parser.
+
+  A thread reads the next blocks of the file with pread() while the
+  connection thread parses and inserts the rows of the current block.
+  A block that is read is exchanged with the buffer of the IO_CACHE of
+  READ_INFO, so the cache looks as if it had read the block itself and the
+  binary log callbacks (log_loaded_block()) see the same blocks.
+*/
+
+class Read_ahead
+{
+  enum { BLOCKS= 2 };
+  uchar *block[BLOCKS];
+  size_t block_length[BLOCKS];
+  uint first, filled;                           /* Blocks ready to be used */
+  File file;
+  size_t buffer_length;
+  my_off_t pos, end_of_file;                    /* Next block to read */
+  int read_errno;
+  bool done, stop, started;
+  pthread_t thread;
+  mysql_mutex_t lock;
+  mysql_cond_t cond;
+
+public:
+  ulong blocks_read, waits;
+
+  Read_ahead(File file_arg, my_off_t end_of_file_arg, size_t length);
+  ~Read_ahead();
+  bool start();
+  void run();
+  size_t next_block(uchar **buffer);
+  int error() { return read_errno; }
+};
+
+
+Read_ahead::Read_ahead(File file_arg, my_off_t end_of_file_arg, size_t length)
+  :first(0), filled(0), file(file_arg), buffer_length(length), pos(0),
+   end_of_file(end_of_file_arg), read_errno(0), done(0), stop(0),
+   started(0), blocks_read(0), waits(0)
+{
+  for (uint i= 0; i < BLOCKS; i++)
+    block[i]= 0;
+  mysql_mutex_init(key_LOCK_load_read_ahead, &lock, MY_MUTEX_INIT_FAST);
+  mysql_cond_init(key_COND_load_read_ahead, &cond, NULL);
+}
+
+
+Read_ahead::~Read_ahead()
+{
+  if (started)
+  {
+    mysql_mutex_lock(&lock);
+    stop= 1;
+    mysql_cond_signal(&cond);
+    mysql_mutex_unlock(&lock);
+    pthread_join(thread, NULL);
+  }
+  for (uint i= 0; i < BLOCKS; i++)
+    my_free(block[i]);
+  mysql_mutex_destroy(&lock);
+  mysql_cond_destroy(&cond);
+}
+
+
+pthread_handler_t read_ahead_thread(void *arg)
+{
+  my_thread_init();
+  ((Read_ahead*) arg)->run();
+  my_thread_end();
+  pthread_exit(0);
+  return 0;
+}
+
+
+/**
+  Allocate the blocks and start the thread.
+
+  @retval 0  The file is read ahead
+  @retval 1  Out of resources, the IO_CACHE reads the file itself
+*/
+
+bool Read_ahead::start()
+{
+  for (uint i= 0; i < BLOCKS; i++)
+  {
+    if (!(block[i]= (uchar*) my_malloc(buffer_length, MYF(0))))
+      return 1;
+  }
+  if (mysql_thread_create(key_thread_load_read_ahead, &thread, NULL,
+                          read_ahead_thread, (void*) this))
+    return 1;
+  started= 1;
+  return 0;
+}
+
+
+void Read_ahead::run()
+{
+  mysql_mutex_lock(&lock);
+  while (!done)
+  {
+    while (filled == BLOCKS && !stop)
+      mysql_cond_wait(&cond, &lock);
+    if (stop)
+      break;
+    /* The block after the filled ones is not used by the reader of blocks */
+    uint slot= (first + filled) % BLOCKS;
+    size_t length= (size_t) min(buffer_length, end_of_file - pos);
+    mysql_mutex_unlock(&lock);
+    size_t read_length= length ? mysql_file_pread(file, block[slot], length,
+                                                  pos, MYF(0)) : 0;
+    mysql_mutex_lock(&lock);
+    if (read_length == (size_t) -1)
+    {
+      read_errno= my_errno;
+      done= 1;
+    }
+    else
+    {
+      if (read_length)
+      {
+        block_length[slot]= read_length;
+        pos+= read_length;
+        filled++;
+        blocks_read++;
+      }
+      /* A file that shrinks while it's loaded ends early */
+      done= read_length < length || pos >= end_of_file;
+    }
+    mysql_cond_signal(&cond);
+  }
+  mysql_mutex_unlock(&lock);
+}
+
+
+/**
+  Get the next block of the file.
+
+  @param buffer  Buffer to be read into next. Set to the buffer of the
+                 block.
+
+  @return Length of the block, 0 at end of file, (size_t) -1 on error
+*/
+
+size_t Read_ahead::next_block(uchar **buffer)
+{
+  size_t length;
+  mysql_mutex_lock(&lock);
+  if (!filled && !done)
+  {
+    waits++;
+    while (!filled && !done)
+      mysql_cond_wait(&cond, &lock);
+  }
+  if (!filled)
+    length= read_errno ? (size_t) -1 : 0;
+  else
+  {
+    swap_variables(uchar*, block[first], *buffer);
+    length= block_length[first];
+    first= (first + 1) % BLOCKS;
+    filled--;
+    mysql_cond_signal(&cond);
+  }
+  mysql_mutex_unlock(&lock);
+  return length;
+}
+
+
 class READ_INFO {
   File	file;
   uchar	*buffer,			/* Buffer for read text */
@@ -73,6 +245,20 @@ class READ_INFO {
   IO_CACHE cache;
   NET *io_net;
   int level; /* for load xml */
+  Read_ahead *read_ahead;
+  /*
+    Bytes that read_field() must look at one by one, see skip_plain_bytes().
+    special_word[] has the ASCII ones repeated in every byte of a word.
+  */
+  bool special_char[256];
+  ulonglong special_word[4];
+  uint special_words;
+  bool special_high_bytes;
+
+  void init_special_chars();
+  uchar *skip_plain_bytes(uchar *pos, uchar *end);
+
+  static int read_ahead_read(IO_CACHE *info, uchar *Buffer, size_t Count);
 
 public:
   bool error,line_cuted,found_null,enclosed;
@@ -114,6 +300,7 @@ public:
     either the table or THD value
   */
   void set_io_cache_arg(void* arg) { cache.arg = arg; }
+  void end_read_ahead(THD *thd);
 };
 
 static int read_fixed_length(THD *thd, COPY_INFO &info, TABLE_LIST *table_list,
@@ -518,6 +705,8 @@ int mysql_load(THD *thd,sql_exchange *ex,TABLE_LIST *table_list,
     table->file->extra(HA_EXTRA_WRITE_CANNOT_REPLACE);
     table->next_number_field=0;
   }
+  read_info.end_read_ahead(thd);
+  thd->status_var.load_data_rows+= info.records;
   if (file >= 0)
     mysql_file_close(file, MYF(0));
   free_blobs(table);				/* if pack_blob was used */
@@ -1332,7 +1521,7 @@ READ_INFO::READ_INFO(File file_par, uint tot_length, CHARSET_INFO *cs,
 		     bool is_fifo)
   :file(file_par), buffer(NULL), buff_length(tot_length), escape_char(escape),
    found_end_of_line(false), eof(false), need_end_io_cache(false),
-   error(false), line_cuted(false), found_null(false), read_charset(cs)
+   read_ahead(NULL), error(false), line_cuted(false), found_null(false), read_charset(cs)
 {
   field_term_ptr=(char*) field_term.ptr();
   field_term_length= field_term.length();
@@ -1366,6 +1555,7 @@ READ_INFO::READ_INFO(File file_par, uint tot_length, CHARSET_INFO *cs,
   uint length= max(cs->mbmaxlen, max(field_term_length, line_term_length)) + 1;
   set_if_bigger(length,line_start.length());
   stack=stack_pos=(int*) sql_alloc(sizeof(int)*length);
+  init_special_chars();
 
   if (!(buffer=(uchar*) my_malloc(buff_length+1,MYF(0))))
     error=1; /* purecov: inspected */
@@ -1393,6 +1583,19 @@ READ_INFO::READ_INFO(File file_par, uint tot_length, CHARSET_INFO *cs,
 #ifndef EMBEDDED_LIBRARY
       if (get_it_from_net)
 	cache.read_function = _my_b_net_read;
+      else if (!is_fifo && cache.end_of_file > cache.buffer_length)
+      {
+        /* The file is longer than the cache: read it in another thread */
+        if ((read_ahead= new Read_ahead(file, cache.end_of_file,
+                                        cache.buffer_length)) &&
+            !read_ahead->start())
+          cache.read_function= read_ahead_read;
+        else
+        {
+          delete read_ahead;
+          read_ahead= 0;
+        }
+      }
 
       if (mysql_bin_log.is_open())
 	cache.pre_read = cache.pre_close =
@@ -1405,6 +1608,7 @@ READ_INFO::READ_INFO(File file_par, uint tot_length, CHARSET_INFO *cs,
 
 READ_INFO::~READ_INFO()
 {
+  delete read_ahead;
   if (need_end_io_cache)
     ::end_io_cache(&cache);
   my_free(buffer);
@@ -1415,9 +1619,151 @@ READ_INFO::~READ_INFO()
 }
 
 
+/**
+  IO_CACHE read function that takes the blocks from Read_ahead.
+  Works like _my_b_read().
+*/
+
+int READ_INFO::read_ahead_read(IO_CACHE *info, uchar *Buffer, size_t Count)
+{
+  READ_INFO *read_info= (READ_INFO*) ((char*) info -
+                                      my_offsetof(READ_INFO, cache));
+  size_t left_length;
+
+  /* If the buffer is not empty yet, copy what is available. */
+  if ((left_length= (size_t) (info->read_end - info->read_pos)))
+  {
+    DBUG_ASSERT(Count >= left_length);
+    memcpy(Buffer, info->read_pos, left_length);
+    Buffer+= left_length;
+    Count-= left_length;
+  }
+
+  for (;;)
+  {
+    /* pos_in_file always point on where info->buffer was read */
+    my_off_t pos_in_file= info->pos_in_file +
+                          (size_t) (info->read_end - info->buffer);
+    size_t length= read_info->read_ahead->next_block(&info->buffer);
+    info->request_pos= info->write_buffer= info->buffer;
+    info->pos_in_file= pos_in_file;
+    if (length == (size_t) -1 || !length)
+    {
+      if (length)
+        my_error(EE_READ, MYF(0), my_filename(info->file),
+                 read_info->read_ahead->error());
+      info->read_pos= info->read_end= info->buffer;
+      info->error= length ? -1 : (int) left_length;
+      return 1;
+    }
+    info->read_end= info->buffer + length;
+    if (length >= Count)
+      break;
+    memcpy(Buffer, info->buffer, length);
+    Buffer+= length;
+    Count-= length;
+    left_length+= length;
+    info->read_pos= info->read_end;
+  }
+  info->read_pos= info->buffer + Count;
+  memcpy(Buffer, info->buffer, Count);
+  return 0;
+}
+
+
+/**
+  Stop reading ahead before the file is closed and count what was read in
+  the status of the connection.
+*/
+
+void READ_INFO::end_read_ahead(THD *thd)
+{
+  if (read_ahead)
+  {
+    thd->status_var.load_data_read_ahead_blocks+= read_ahead->blocks_read;
+    thd->status_var.load_data_read_ahead_waits+= read_ahead->waits;
+    delete read_ahead;
+    read_ahead= 0;
+  }
+}
+
+
 #define GET (stack_pos != stack ? *--stack_pos : my_b_get(&cache))
 #define PUSH(A) *(stack_pos++)=(A)
 
+#define BYTE_ONES  0x0101010101010101ULL
+#define BYTE_HIGHS 0x8080808080808080ULL
+
+/**
+  Mark the bytes that can end a run of field data: terminators, escape and
+  enclosure characters and the first bytes of multi-byte characters.
+*/
+
+void READ_INFO::init_special_chars()
+{
+  int chars[4]= { field_term_char, line_term_char, enclosed_char,
+                  escape_char };
+  bzero(special_char, sizeof(special_char));
+  special_words= 0;
+  special_high_bytes= 0;
+  for (uint i= 0; i < array_elements(chars); i++)
+  {
+    if (chars[i] < 0 || chars[i] > 255 || special_char[chars[i]])
+      continue;
+    special_char[chars[i]]= 1;
+    if (chars[i] < 128)
+      special_word[special_words++]= BYTE_ONES * (ulonglong) chars[i];
+    else
+      special_high_bytes= 1;
+  }
+#ifdef USE_MB
+  for (uint chr= 0; chr < 256; chr++)
+  {
+    if (my_mbcharlen(read_charset, chr) > 1)
+    {
+      special_char[chr]= 1;
+      if (chr < 128)
+        special_words= array_elements(special_word) + 1;  // No word tests
+      else
+        special_high_bytes= 1;
+    }
+  }
+#endif
+}
+
+
+/**
+  Find the first byte in [pos, end) that isn't plain field data.
+
+  Eight bytes are tested at a time: a byte of a word equals one of the
+  special ASCII bytes if the word xor'ed with the repeated byte has a zero
+  byte, and any byte with the high bit set stops the word if a special byte
+  is not ASCII. The bytes of such a word are then checked one by one.
+*/
+
+uchar *READ_INFO::skip_plain_bytes(uchar *pos, uchar *end)
+{
+  if (special_words <= array_elements(special_word))
+  {
+    for (; pos + 8 <= end; pos+= 8)
+    {
+      ulonglong word, found;
+      memcpy(&word, pos, 8);
+      found= special_high_bytes ? word & BYTE_HIGHS : 0;
+      for (uint i= 0; i < special_words; i++)
+      {
+        ulonglong diff= word ^ special_word[i];
+        found|= (diff - BYTE_ONES) & ~diff & BYTE_HIGHS;
+      }
+      if (found)
+        break;
+    }
+  }
+  while (pos < end && !special_char[*pos])
+    pos++;
+  return pos;
+}
+
 
 inline int READ_INFO::terminator(char *ptr,uint length)
 {
@@ -1477,6 +1823,21 @@ int READ_INFO::read_field()
   {
     while ( to < end_of_buff)
     {
+      if (stack_pos == stack)
+      {
+        /* Copy the bytes that need no parsing directly from the cache */
+        uchar *pos= cache.read_pos;
+        uchar *end= pos + min((size_t) (cache.read_end - pos),
+                              (size_t) (end_of_buff - to));
+        uchar *plain_end= skip_plain_bytes(pos, end);
+        if (plain_end != pos)
+        {
+          memcpy(to, pos, (size_t) (plain_end - pos));
+          to+= plain_end - pos;
+          cache.read_pos= plain_end;
+          continue;
+        }
+      }
       chr = GET;
       if (chr == my_b_EOF)
 	goto found_eof;
@@ -5509,6 +5509,8 @@ void THD::reset_for_next_command(bool calculate_userstat)
 
   thd->query_plan_flags= QPLAN_INIT;
   thd->query_plan_fsort_passes= 0;
+  thd->query_plan_range_opt_time= 0;
+  thd->query_plan_range_opt_memory= 0;
 
   thd->reset_current_stmt_binlog_format_row();
   thd->binlog_unsafe_warning_flags= 0;
@@ -610,6 +610,215 @@ send_event_to_slave(THD *thd, NET *net, String* const packet, ushort flags,
   return NULL;    /* Success */
 }
 
+/*
+  The tail of the active binary log, shared by all binlog dump threads.
+
+  Dump threads which have caught up with the binary log all read the same
+  few events. Instead of each of them reading those through its own
+  IO_CACHE under LOCK_log, the first one to need new data reads it from
+  the binary log into a ring buffer of binlog_tail_cache_size bytes, and
+  the others copy the events from there. Threads reading older events, or
+  an older binary log, read the file as before.
+*/
+
+static mysql_mutex_t LOCK_binlog_tail;
+static uchar *binlog_tail_buf;
+/* Name of the binary log in the buffer, and the range of it buffered */
+static char binlog_tail_name[FN_REFLEN];
+static my_off_t binlog_tail_start, binlog_tail_end;
+
+#ifdef HAVE_PSI_INTERFACE
+static PSI_mutex_key key_LOCK_binlog_tail;
+
+static PSI_mutex_info all_binlog_tail_mutexes[]=
+{
+  { &key_LOCK_binlog_tail, "LOCK_binlog_tail", PSI_FLAG_GLOBAL}
+};
+#endif
+
+void binlog_tail_cache_init()
+{
+#ifdef HAVE_PSI_INTERFACE
+  if (PSI_server)
+    PSI_server->register_mutex("sql", all_binlog_tail_mutexes,
+                               array_elements(all_binlog_tail_mutexes));
+#endif
+  mysql_mutex_init(key_LOCK_binlog_tail, &LOCK_binlog_tail,
+                   MY_MUTEX_INIT_FAST);
+}
+
+void binlog_tail_cache_free()
+{
+  my_free(binlog_tail_buf);
+  binlog_tail_buf= 0;
+  mysql_mutex_destroy(&LOCK_binlog_tail);
+}
+
+/* Forget the buffered tail, as RESET MASTER reuses the binary log names */
+static void binlog_tail_cache_clear()
+{
+  mysql_mutex_lock(&LOCK_binlog_tail);
+  binlog_tail_name[0]= 0;
+  binlog_tail_start= binlog_tail_end= 0;
+  mysql_mutex_unlock(&LOCK_binlog_tail);
+}
+
+/*
+  Copy 'length' bytes of the binary log at offset 'pos' out of the ring
+  buffer. The bytes must be in the buffer.
+*/
+static bool binlog_tail_copy(String *to, my_off_t pos, size_t length)
+{
+  size_t offset= (size_t) (pos % binlog_tail_cache_size);
+  size_t first= min(length, binlog_tail_cache_size - offset);
+  return (to->append((char*) binlog_tail_buf + offset, first) ||
+          to->append((char*) binlog_tail_buf, length - first));
+}
+
+/*
+  Read the part of the active binary log after the buffered range into
+  the buffer.
+
+  @param log_file_name  binary log the caller reads
+  @param pos            offset the caller reads from
+  @param file           the caller's file of log_file_name
+
+  @retval 0  some bytes were read
+  @retval 1  log_file_name is not the active binary log, pos is before
+             the buffered range, there is nothing new, or a read error.
+*/
+static bool binlog_tail_fill(const char *log_file_name, my_off_t pos,
+                             File file)
+{
+  mysql_mutex_t *log_lock= mysql_bin_log.get_log_lock();
+  my_off_t log_end;
+  size_t length, done= 0;
+
+  mysql_mutex_assert_owner(&LOCK_binlog_tail);
+  mysql_mutex_lock(log_lock);
+  if (!mysql_bin_log.is_active(log_file_name))
+  {
+    mysql_mutex_unlock(log_lock);
+    return 1;
+  }
+  log_end= my_b_tell(mysql_bin_log.get_log_file());
+  mysql_mutex_unlock(log_lock);
+
+  if (strcmp(binlog_tail_name, log_file_name) || pos > binlog_tail_end)
+  {
+    /* A new binary log, or the buffer is behind all readers: start over */
+    strmake_buf(binlog_tail_name, log_file_name);
+    binlog_tail_start= binlog_tail_end= pos;
+  }
+  else if (pos < binlog_tail_start)
+    return 1;
+  if (log_end <= binlog_tail_end)
+    return 1;
+
+  /*
+    Bytes before log_end are written and never change; read as many of
+    them as fit.
+  */
+  length= (size_t) min(log_end - binlog_tail_end,
+                       (my_off_t) binlog_tail_cache_size);
+  while (done < length)
+  {
+    my_off_t from= binlog_tail_end + done;
+    size_t offset= (size_t) (from % binlog_tail_cache_size);
+    size_t chunk= min(length - done, binlog_tail_cache_size - offset);
+    size_t res= mysql_file_pread(file, binlog_tail_buf + offset, chunk, from,
+                                 MYF(0));
+    if (res == (size_t) -1 || res == 0)
+      break;
+    done+= res;
+  }
+  if (!done)
+    return 1;
+
+  binlog_tail_end+= done;
+  if (binlog_tail_end - binlog_tail_start > binlog_tail_cache_size)
+    binlog_tail_start= binlog_tail_end - binlog_tail_cache_size;
+  binlog_tail_cache_fills++;
+  return 0;
+}
+
+/*
+  Read the event at the current position of 'log' from the buffered tail
+  of the active binary log.
+
+  @param thd            dump thread
+  @param log            the dump thread's cache of log_file_name
+  @param packet         where to append the event
+  @param checksum_alg   checksum algorithm of the events in the log
+  @param log_file_name  name of the binary log
+
+  On success the position of 'log' is moved after the event.
+
+  @retval 0  the event was appended to packet
+  @retval 1  the event must be read from the file (with
+             Log_event::read_log_event(), which also reports errors)
+*/
+static bool binlog_tail_read_event(THD *thd, IO_CACHE *log, String *packet,
+                                   uint8 checksum_alg,
+                                   const char *log_file_name)
+{
+  my_off_t pos= my_b_tell(log);
+  uint32 ev_offset= packet->length();
+  ulong data_len= 0;
+  bool filled= 0, found= 0;
+
+  if (!binlog_tail_cache_size)
+    return 1;
+  DBUG_EXECUTE_IF("corrupt_read_log_event2", return 1;);
+
+  mysql_mutex_lock(&LOCK_binlog_tail);
+  if (!binlog_tail_buf &&
+      !(binlog_tail_buf= (uchar*) my_malloc(binlog_tail_cache_size, MYF(0))))
+  {
+    mysql_mutex_unlock(&LOCK_binlog_tail);
+    return 1;
+  }
+  for (;;)
+  {
+    if (!strcmp(binlog_tail_name, log_file_name) &&
+        pos >= binlog_tail_start &&
+        pos + LOG_EVENT_MINIMAL_HEADER_LEN <= binlog_tail_end)
+    {
+      if (binlog_tail_copy(packet, pos, LOG_EVENT_MINIMAL_HEADER_LEN))
+        break;
+      data_len= uint4korr(packet->ptr() + ev_offset + EVENT_LEN_OFFSET);
+      packet->length(ev_offset);
+      /* Leave malformed or too large events to read_log_event() */
+      if (data_len < LOG_EVENT_MINIMAL_HEADER_LEN ||
+          data_len > thd->variables.max_allowed_packet)
+        break;
+      if (pos + data_len <= binlog_tail_end)
+      {
+        found= !binlog_tail_copy(packet, pos, data_len);
+        break;
+      }
+    }
+    if (filled || binlog_tail_fill(log_file_name, pos, log->file))
+      break;
+    filled= 1;
+  }
+  if (found)
+    binlog_tail_cache_hits++;
+  mysql_mutex_unlock(&LOCK_binlog_tail);
+
+  if (found && opt_master_verify_checksum &&
+      event_checksum_test((uchar*) packet->ptr() + ev_offset, data_len,
+                          checksum_alg))
+    found= 0;
+  if (!found)
+  {
+    packet->length(ev_offset);
+    return 1;
+  }
+  my_b_seek(log, pos + data_len);
+  return 0;
+}
+
 void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos,
 		       ushort flags)
 {
@@ -880,7 +1089,10 @@ impossible position";
       goto err;
 
     bool is_active_binlog= false;
-    while (!(error= Log_event::read_log_event(&log, packet, log_lock,
+    /* Events near the end of the active log come from the shared tail */
+    while (!binlog_tail_read_event(thd, &log, packet, current_checksum_alg,
+                                   log_file_name) ||
+           !(error= Log_event::read_log_event(&log, packet, log_lock,
                                               current_checksum_alg,
                                               log_file_name,
                                               &is_active_binlog)))
@@ -1906,6 +2118,7 @@ int reset_master(THD* thd)
 
   if (mysql_bin_log.reset_logs(thd))
     return 1;
+  binlog_tail_cache_clear();
   RUN_HOOK(binlog_transmit, after_reset_master, (thd, 0 /* flags */));
   return 0;
 }
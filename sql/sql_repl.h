@@ -64,6 +64,8 @@ typedef struct st_load_file_info
 int log_loaded_block(IO_CACHE* file);
 int init_replication_sys_vars();
 void mysql_binlog_send(THD* thd, char* log_ident, my_off_t pos, ushort flags);
+void binlog_tail_cache_init();
+void binlog_tail_cache_free();
 
 #endif /* HAVE_REPLICATION */
 
@@ -4084,7 +4084,17 @@ add_key_field(JOIN *join,
           break;
       }
       if (is_const)
+      {
         stat[0].const_keys.merge(possible_keys);
+        if (optimizer_flag(join->thd, OPTIMIZER_SWITCH_SKIP_SCAN))
+        {
+          /* Skip scan can use indexes where field is not the first part */
+          key_map skip_scan_keys= field->part_of_key;
+          skip_scan_keys.intersect(field->table->keys_in_use_for_query);
+          stat[0].keys.merge(skip_scan_keys);
+          stat[0].const_keys.merge(skip_scan_keys);
+        }
+      }
       else if (!eq_func)
       {
         /* 
@@ -18936,7 +18946,8 @@ check_reverse_order:
           quick_type == QUICK_SELECT_I::QS_TYPE_INDEX_INTERSECT ||
           quick_type == QUICK_SELECT_I::QS_TYPE_ROR_INTERSECT ||
           quick_type == QUICK_SELECT_I::QS_TYPE_ROR_UNION ||
-          quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX)
+          quick_type == QUICK_SELECT_I::QS_TYPE_GROUP_MIN_MAX ||
+          quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN)
       {
         tab->limit= 0;
         goto use_filesort;               // Use filesort
@@ -19500,10 +19511,19 @@ remove_duplicates(JOIN *join, TABLE *table, List<Item> &fields, Item *having)
 
   free_io_cache(table);				// Safety
   table->file->info(HA_STATUS_VARIABLE);
-  if (table->s->db_type() == heap_hton ||
-      (!table->s->blob_fields &&
-       ((ALIGN_SIZE(keylength) + HASH_OVERHEAD) * table->file->stats.records <
-	thd->variables.sortbuff_size)))
+  if (optimizer_flag(thd, OPTIMIZER_SWITCH_HASH_DISTINCT) &&
+      Hash_dedup::can_dedup(first_field))
+  {
+    Hash_dedup dedup(table, first_field,
+                     min(thd->variables.tmp_table_size,
+                         thd->variables.max_heap_table_size));
+    dedup.defer_all();
+    error= dedup.delete_duplicates(thd, having);
+  }
+  else if (table->s->db_type() == heap_hton ||
+           (!table->s->blob_fields &&
+            ((ALIGN_SIZE(keylength) + HASH_OVERHEAD) *
+             table->file->stats.records < thd->variables.sortbuff_size)))
     error=remove_dup_with_hash_index(join->thd, table, field_count, first_field,
 				     keylength, having);
   else
@@ -22126,6 +22146,8 @@ static void select_describe(JOIN *join, bool need_tmp_table, bool need_order,
           extra.append(STRING_WITH_LEN("; Using "));
           tab->select->quick->add_info_string(&extra);
         }
+        else if (quick_type == QUICK_SELECT_I::QS_TYPE_SKIP_SCAN)
+          extra.append(STRING_WITH_LEN("; Using skip scan"));
 	if (tab->select)
 	{
 	  if (tab->use_quick == 2)
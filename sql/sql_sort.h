@@ -37,7 +37,7 @@ struct TABLE;
    The structure SORT_ADDON_FIELD describes a fixed layout
    for field values appended to sorted values in records to be sorted
    in the sort buffer.
-   Only fixed layout is supported now.
+   By default all records have this fixed layout.
    Null bit maps for the appended values is placed before the values 
    themselves. Offsets are from the last sorted field, that is from the
    record referefence, which is still last component of sorted records.
@@ -49,6 +49,26 @@ struct TABLE;
    the callback function 'unpack_addon_fields'.
 */
 
+/*
+   If SORTPARAM::using_packed_records is set, records have variable length
+   and the following layout instead:
+
+     <key length> <sort key> <ref or addon part>
+
+   <key length> takes PACKED_LENGTH_BYTES bytes and includes itself.
+   Packed sort fields (SORT_FIELD::packed) are stored in the sort key as
+   an optional NULL marker, a 2 byte length and the column value, and
+   are compared with the collation of the column.
+   The addon part is then stored as
+
+     <addon length> <null bits> <packed values of not NULL fields>
+
+   where <addon length> takes PACKED_LENGTH_BYTES bytes and includes
+   itself. The addon part is written to the sorted result in this form.
+*/
+
+#define PACKED_LENGTH_BYTES 4
+
 typedef struct st_sort_addon_field
 {
   /* Sort addon packed field */
@@ -80,6 +100,7 @@ typedef struct st_sort_param {
   SORT_ADDON_FIELD *addon_field; /* Descriptors for companion fields */
   uchar *unique_buff;
   bool not_killable;
+  bool using_packed_records;    /* Variable length records, see above */
   char* tmp_buffer;
   /* The fields below are used only by Unique class */
   qsort2_cmp compare;
@@ -55,6 +55,8 @@
 #include "transaction.h"
 #include "datadict.h"  // dd_frm_type()
 #include "sql_audit.h"
+#include "sql_alter.h"                 // Online_alter_log
+#include "key.h"                       // key_copy, key_restore
 
 #ifdef __WIN__
 #include <io.h>
@@ -68,6 +70,16 @@ static int copy_data_between_tables(THD *thd, TABLE *,TABLE *,
                                     List<Create_field> &, bool,
 				    uint, ORDER *, ha_rows *,ha_rows *,
                                     enum enum_enable_or_disable, bool);
+static int alter_table_add_deferred_keys(THD *, TABLE *,
+                                         Alter_table_deferred_keys *);
+static bool alter_table_write_deferred_frm(THD *, const char *, const char *,
+                                           HA_CREATE_INFO *, Alter_info *,
+                                           Alter_table_deferred_keys *);
+static bool online_alter_possible(THD *, TABLE *, TABLE *, Alter_info *,
+                                  bool, ORDER *);
+static int online_alter_copy_changes(THD *, TABLE *, TABLE *,
+                                     List<Create_field> &,
+                                     Online_alter_log *, MDL_ticket *);
 
 static bool prepare_blob_field(THD *thd, Create_field *sql_field);
 static bool check_engine(THD *, const char *, const char *, HA_CREATE_INFO *);
@@ -4070,6 +4082,47 @@ bool check_table_file_presence(char *old_path,
 }
 
 
+/**
+  Find the keys of a new table that ALTER TABLE can add after the rows
+  are copied.
+
+  These are the non unique keys at the end of the sorted key list, if
+  the engine can add such keys by sorting the rows of the table (like
+  InnoDB does in add_index()), which is much faster than inserting every
+  row into every index. A key on the auto_increment column is kept, as
+  the table can't be opened without it.
+
+  @return Number of the first key to add later, key_count if none.
+*/
+
+static uint first_deferrable_key(handler *file, Alter_info *alter_info,
+                                 KEY *key_info, uint key_count)
+{
+  List_iterator<Create_field> it(alter_info->create_list);
+  Create_field *sql_field;
+  uint first= key_count, auto_increment_fieldnr= ~0U;
+
+  if (!(file->alter_table_flags(0) & HA_INPLACE_ADD_INDEX_NO_READ_WRITE))
+    return key_count;
+  for (uint fieldnr= 0; (sql_field= it++); fieldnr++)
+  {
+    if (sql_field->flags & AUTO_INCREMENT_FLAG)
+      auto_increment_fieldnr= fieldnr;
+  }
+  while (first > 0)
+  {
+    KEY *key= key_info + first - 1;
+    if ((key->flags & (HA_NOSAME | HA_FULLTEXT | HA_SPATIAL |
+                       HA_GENERATED_KEY)) ||
+        !my_strcasecmp(system_charset_info, key->name, primary_key_name) ||
+        key->key_part->fieldnr == auto_increment_fieldnr)
+      break;
+    first--;
+  }
+  return first;
+}
+
+
 /*
   Create a table
 
@@ -4086,6 +4139,10 @@ bool check_table_file_presence(char *old_path,
     select_field_count
     is_trans            identifies the type of engine where the table
                         was created: either trans or non-trans.
+    deferred_keys       If not 0 (ALTER TABLE), the trailing non unique
+                        keys that the engine can add by sorting are left
+                        out of the table and returned here, see
+                        alter_table_add_deferred_keys().
 
   DESCRIPTION
     If one creates a temporary table, this is automatically opened
@@ -4111,12 +4168,13 @@ bool mysql_create_table_no_lock(THD *thd,
                                 Alter_info *alter_info,
                                 bool internal_tmp_table,
                                 uint select_field_count,
-                                bool *is_trans)
+                                bool *is_trans,
+                                Alter_table_deferred_keys *deferred_keys)
 {
   char		path[FN_REFLEN + 1];
   uint          path_length;
   const char	*alias;
-  uint		db_options, key_count;
+  uint		db_options, key_count, engine_key_count;
   KEY		*key_info_buffer;
   handler	*file;
   bool		error= TRUE;
@@ -4479,10 +4537,20 @@ bool mysql_create_table_no_lock(THD *thd,
   }
   create_info->table_options=db_options;
 
+  engine_key_count= key_count;
+  if (deferred_keys)
+  {
+    deferred_keys->key_info= key_info_buffer;
+    deferred_keys->key_count= key_count;
+    deferred_keys->null_bits= create_info->null_bits;
+    deferred_keys->first= engine_key_count=
+      first_deferrable_key(file, alter_info, key_info_buffer, key_count);
+  }
+
   path[path_length - reg_ext_length]= '\0'; // Remove .frm extension
   if (rea_create_table(thd, path, db, table_name,
                        create_info, alter_info->create_list,
-                       key_count, key_info_buffer, file))
+                       engine_key_count, key_info_buffer, file))
     goto err;
 
   if (create_info->options & HA_LEX_CREATE_TMP_TABLE)
@@ -5982,6 +6050,9 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
   uint index_add_count= 0;
   handler_add_index *add= NULL;
   bool pending_inplace_add_index= false;
+  bool online_copy= false;
+  Online_alter_log *online_log;
+  Alter_table_deferred_keys deferred_keys, *defer_keys= NULL;
   uint *index_add_buffer= NULL;
   uint candidate_key_count= 0;
   bool no_pk;
@@ -6442,8 +6513,13 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
     If there are index changes only, try to do them in-place. "Index
     changes only" means also that the handler for the table does not
     change. The table is open and locked. The handler can be accessed.
+    ALTER ONLINE copies the table instead if the engine allows other
+    connections to change it meanwhile, as in-place index changes block
+    writes.
   */
-  if (need_copy_table == ALTER_TABLE_INDEX_CHANGED)
+  if (need_copy_table == ALTER_TABLE_INDEX_CHANGED &&
+      !(require_online &&
+        (table->file->ha_table_flags() & HA_CAN_ONLINE_ALTER)))
   {
     int   pk_changed= 0;
     ulong alter_flags= 0;
@@ -6718,15 +6794,33 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
                                  (table->s->db_create_options &
                                   HA_OPTION_PACK_RECORD));
   }
+  /*
+    When the rows are copied, the engine may build the non unique keys of
+    the new table afterwards by sorting. Foreign keys need their keys
+    when the table is created.
+  */
+  if (need_copy_table != ALTER_TABLE_METADATA_ONLY &&
+      !table->s->tmp_table && !require_online &&
+      !(alter_info->flags & ALTER_FOREIGN_KEY) &&
+      table->file->can_switch_engines())
+  {
+    defer_keys= &deferred_keys;
+#ifdef WITH_PARTITION_STORAGE_ENGINE
+    if (thd->work_part_info || table->part_info)
+      defer_keys= NULL;
+#endif
+  }
   tmp_disable_binlog(thd);
   create_info->options|=HA_CREATE_TMP_ALTER;
   error= mysql_create_table_no_lock(thd, new_db, tmp_name,
                                     create_info,
                                     alter_info,
-                                    1, 0, NULL);
+                                    1, 0, NULL, defer_keys);
   reenable_binlog(thd);
   if (error)
     goto err;
+  if (defer_keys && defer_keys->first == defer_keys->key_count)
+    defer_keys= NULL;
 
   /* Open the table if we need to copy the data. */
   DBUG_PRINT("info", ("need_copy_table: %u", need_copy_table));
@@ -6765,9 +6859,14 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
   /* Check if we can do the ALTER TABLE as online */
   if (require_online)
   {
-    if (index_add_count || index_drop_count ||
-        (new_table &&
-         !(new_table->file->ha_table_flags() & HA_NO_COPY_ON_ALTER)))
+    if (new_table &&
+        !(new_table->file->ha_table_flags() & HA_NO_COPY_ON_ALTER) &&
+        online_alter_possible(thd, table, new_table, alter_info, ignore,
+                              order))
+      online_copy= TRUE;
+    else if (index_add_count || index_drop_count ||
+             (new_table &&
+              !(new_table->file->ha_table_flags() & HA_NO_COPY_ON_ALTER)))
     {
       my_error(ER_CANT_DO_ONLINE, MYF(0), "ALTER");
       goto err_new_table_cleanup;
@@ -6792,11 +6891,35 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
         my_error(ER_LOCK_WAIT_TIMEOUT, MYF(0));
         goto err_new_table_cleanup;
       });
+    if (online_copy)
+    {
+      /*
+        Other connections may change the table while it is copied: the
+        primary keys of the rows they change are logged and these rows
+        are copied again afterwards (online_alter_copy_changes()).
+      */
+      if (!(online_log= Online_alter_log::attach(table->s)))
+        goto err_new_table_cleanup;
+      mdl_ticket->downgrade_lock(MDL_SHARED_UPGRADABLE);
+      table->file->extra(HA_EXTRA_ONLINE_ALTER_READ);
+      DEBUG_SYNC(thd, "alter_table_online_copy");
+    }
     error= copy_data_between_tables(thd, table, new_table,
                                     alter_info->create_list, ignore,
                                     order_num, order, &copied, &deleted,
                                     alter_info->keys_onoff,
                                     alter_info->error_if_not_empty);
+    if (online_copy)
+    {
+      DEBUG_SYNC(thd, "alter_table_online_copied");
+      if (!error)
+        error= online_alter_copy_changes(thd, table, new_table,
+                                         alter_info->create_list,
+                                         online_log, mdl_ticket);
+      Online_alter_log::detach(table->s);
+    }
+    if (!error && defer_keys)
+      error= alter_table_add_deferred_keys(thd, new_table, defer_keys);
   }
   else
   {
@@ -7009,6 +7132,10 @@ bool mysql_alter_table(THD *thd,char *new_db, char *new_name,
     close_temporary_table(thd, new_table, 1, 0);
     new_table= 0;
   }
+  if (defer_keys &&
+      alter_table_write_deferred_frm(thd, new_db, tmp_name, create_info,
+                                     alter_info, defer_keys))
+    goto err_new_table_cleanup;
   DEBUG_SYNC(thd, "alter_table_before_rename_result_table");
 
   /*
@@ -7344,6 +7471,50 @@ bool mysql_trans_commit_alter_copy_data(THD *thd)
 }
 
 
+/**
+  Prepare copying of the fields of the old table to the new table.
+
+  @param[in]  copy                         Array of to->s->fields elements
+  @param[out] auto_increment_field_copied  The auto_increment field of the
+                                           new table gets the old values
+
+  @return End of the used part of the copy array.
+*/
+
+static Copy_field *
+setup_copy_fields(THD *thd, TABLE *from, TABLE *to,
+                  List<Create_field> &create, Copy_field *copy,
+                  bool *auto_increment_field_copied)
+{
+  List_iterator<Create_field> it(create);
+  Create_field *def;
+  Copy_field *copy_end= copy;
+
+  for (Field **ptr=to->field ; *ptr ; ptr++)
+  {
+    def=it++;
+    if (def->field)
+    {
+      if (*ptr == to->next_number_field)
+      {
+        *auto_increment_field_copied= TRUE;
+        /*
+          If we are going to copy contents of one auto_increment column to
+          another auto_increment column it is sensible to preserve zeroes.
+          This condition also covers case when we are don't actually alter
+          auto_increment column.
+        */
+        if (def->field == from->found_next_number_field)
+          thd->variables.sql_mode|= MODE_NO_AUTO_VALUE_ON_ZERO;
+      }
+      (copy_end++)->set(*ptr,def->field,0);
+    }
+
+  }
+  return copy_end;
+}
+
+
 static int
 copy_data_between_tables(THD *thd, TABLE *from,TABLE *to,
 			 List<Create_field> &create,
@@ -7367,8 +7538,6 @@ copy_data_between_tables(THD *thd, TABLE *from,TABLE *to,
   bool auto_increment_field_copied= 0;
   ulonglong save_sql_mode= thd->variables.sql_mode;
   ulonglong prev_insert_id, time_to_report_progress;
-  List_iterator<Create_field> it(create);
-  Create_field *def;
   DBUG_ENTER("copy_data_between_tables");
 
   /* Two or 3 stages; Sorting, copying data and update indexes */
@@ -7397,28 +7566,8 @@ copy_data_between_tables(THD *thd, TABLE *from,TABLE *to,
   to->file->ha_start_bulk_insert(from->file->stats.records);
   errpos= 3;
 
-  copy_end=copy;
-  for (Field **ptr=to->field ; *ptr ; ptr++)
-  {
-    def=it++;
-    if (def->field)
-    {
-      if (*ptr == to->next_number_field)
-      {
-        auto_increment_field_copied= TRUE;
-        /*
-          If we are going to copy contents of one auto_increment column to
-          another auto_increment column it is sensible to preserve zeroes.
-          This condition also covers case when we are don't actually alter
-          auto_increment column.
-        */
-        if (def->field == from->found_next_number_field)
-          thd->variables.sql_mode|= MODE_NO_AUTO_VALUE_ON_ZERO;
-      }
-      (copy_end++)->set(*ptr,def->field,0);
-    }
-
-  }
+  copy_end= setup_copy_fields(thd, from, to, create, copy,
+                              &auto_increment_field_copied);
 
   if (order)
   {
@@ -7584,6 +7733,512 @@ err:
 }
 
 
+/**
+  Add the keys that were left out of the intermediate table of ALTER
+  TABLE (see first_deferrable_key()) after the rows are copied.
+
+  The engine builds each key by sorting the rows of the table, instead
+  of inserting every copied row into it.
+*/
+
+static int alter_table_add_deferred_keys(THD *thd, TABLE *table,
+                                         Alter_table_deferred_keys *keys)
+{
+  KEY *key_info= keys->key_info + keys->first;
+  uint count= keys->key_count - keys->first;
+  handler_add_index *add= NULL;
+  int error;
+  DBUG_ENTER("alter_table_add_deferred_keys");
+
+  for (KEY *key= key_info; key < key_info + count; key++)
+  {
+    KEY_PART_INFO *key_part, *part_end= key->key_part + key->key_parts;
+    for (key_part= key->key_part; key_part < part_end; key_part++)
+      key_part->field= table->field[key_part->fieldnr];
+  }
+
+  thd_proc_info(thd, "Adding keys");
+  if (mysql_trans_prepare_alter_copy_data(thd))
+    DBUG_RETURN(1);
+  if ((error= table->file->ha_external_lock(thd, F_WRLCK)))
+  {
+    table->file->print_error(error, MYF(0));
+    (void) mysql_trans_commit_alter_copy_data(thd);
+    DBUG_RETURN(error);
+  }
+  if ((error= table->file->add_index(table, key_info, count, &add)))
+  {
+    /* Only report error if handler has not already reported an error */
+    if (!thd->is_error())
+    {
+      /* Exchange the key_info for the key names in the message */
+      KEY *save_key_info= table->key_info;
+      table->key_info= key_info;
+      table->file->print_error(error, MYF(0));
+      table->key_info= save_key_info;
+    }
+  }
+  else if ((error= table->file->final_add_index(add, true)))
+    table->file->print_error(error, MYF(0));
+  if (mysql_trans_commit_alter_copy_data(thd))
+    error= 1;
+  if (table->file->ha_external_lock(thd, F_UNLCK))
+    error= 1;
+  DBUG_RETURN(error);
+}
+
+
+/**
+  Write the .frm file of the intermediate table of ALTER TABLE with all
+  keys, after alter_table_add_deferred_keys() has added the deferred
+  keys to the engine.
+*/
+
+static bool alter_table_write_deferred_frm(THD *thd, const char *db,
+                                           const char *table_name,
+                                           HA_CREATE_INFO *create_info,
+                                           Alter_info *alter_info,
+                                           Alter_table_deferred_keys *keys)
+{
+  char path[FN_REFLEN + 1];
+  handler *file;
+  bool error;
+  DBUG_ENTER("alter_table_write_deferred_frm");
+
+  if (!(file= get_new_handler((TABLE_SHARE*) 0, thd->mem_root,
+                              create_info->db_type)))
+  {
+    mem_alloc_error(sizeof(handler));
+    DBUG_RETURN(TRUE);
+  }
+  build_table_filename(path, sizeof(path) - 1, db, table_name, reg_ext,
+                       FN_IS_TMP);
+  /* mysql_create_frm() counts the deleted row bit in null_bits */
+  create_info->null_bits= keys->null_bits;
+  error= mysql_create_frm(thd, path, db, table_name, create_info,
+                          alter_info->create_list, keys->key_count,
+                          keys->key_info, file);
+  delete file;
+  DBUG_RETURN(error);
+}
+
+
+/**
+  Check if ALTER ONLINE TABLE can copy the table while other connections
+  change it.
+
+  The changed rows are found in the new table by the primary key of the
+  old table, so both tables need a primary key of the same, unchanged
+  columns. Statements that must see all rows at once (IGNORE, ORDER BY,
+  a new NOT NULL date column on a non empty table) can't be done online.
+*/
+
+static bool online_alter_possible(THD *thd, TABLE *from, TABLE *to,
+                                  Alter_info *alter_info, bool ignore,
+                                  ORDER *order)
+{
+  KEY *from_key, *to_key;
+  KEY_PART_INFO *part, *part_end, *from_part, *from_part_end;
+
+  if (!(from->file->ha_table_flags() & HA_CAN_ONLINE_ALTER) ||
+      from->s->tmp_table != NO_TMP_TABLE || thd->locked_tables_mode ||
+      ignore || order || alter_info->error_if_not_empty ||
+      alter_info->keys_onoff != LEAVE_AS_IS ||
+      from->s->primary_key == MAX_KEY || to->s->primary_key == MAX_KEY ||
+      !from->file->can_switch_engines())        // Foreign keys
+    return FALSE;
+#ifdef WITH_PARTITION_STORAGE_ENGINE
+  if (from->part_info || to->part_info)
+    return FALSE;
+#endif
+
+  from_key= from->key_info + from->s->primary_key;
+  to_key= to->key_info + to->s->primary_key;
+  if (from_key->key_parts != to_key->key_parts)
+    return FALSE;
+  from_part_end= from_key->key_part + from_key->key_parts;
+  part_end= to_key->key_part + to_key->key_parts;
+  for (part= to_key->key_part; part < part_end; part++)
+  {
+    List_iterator<Create_field> it(alter_info->create_list);
+    Create_field *def;
+    uint field_index= part->field->field_index;
+
+    while ((def= it++) && field_index--)
+    {}
+    if (!def || !def->field || !part->field->eq_def(def->field) ||
+        (part->key_part_flag & HA_PART_KEY_SEG))
+      return FALSE;
+    for (from_part= from_key->key_part; from_part < from_part_end;
+         from_part++)
+    {
+      if (from_part->field == def->field)
+        break;
+    }
+    if (from_part == from_part_end ||
+        (from_part->key_part_flag & HA_PART_KEY_SEG))
+      return FALSE;
+  }
+
+  /* New auto_increment values would depend on the order of the copy. */
+  if (to->found_next_number_field)
+  {
+    List_iterator<Create_field> it(alter_info->create_list);
+    Create_field *def;
+    uint field_index= to->found_next_number_field->field_index;
+
+    while ((def= it++) && field_index--)
+    {}
+    if (!def || !def->field)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+  Writes, updates or deletes the rows of the new table of ALTER ONLINE
+  TABLE to make them equal to the current rows of the old table.
+*/
+
+class Online_alter_apply
+{
+public:
+  Online_alter_apply(THD *thd_arg, TABLE *from_arg, TABLE *to_arg)
+    :thd(thd_arg), from(from_arg), to(to_arg), copy(0), key_fields(0)
+  {}
+  ~Online_alter_apply()
+  {
+    delete [] copy;
+    delete [] key_fields;
+  }
+  bool init(List<Create_field> &create);
+  int apply_row(const uchar *key);
+  int remove_row(const uchar *key);
+
+private:
+  int find_new_row(const uchar *key, bool *found);
+
+  THD *thd;
+  TABLE *from, *to;
+  Copy_field *copy, *copy_end;
+  /* Copying of the fields of the primary key of the new table */
+  Copy_field *key_fields, *key_fields_end;
+  uchar new_key[MAX_KEY_LENGTH];
+};
+
+
+bool Online_alter_apply::init(List<Create_field> &create)
+{
+  KEY *key_info= to->key_info + to->s->primary_key;
+  KEY_PART_INFO *part, *part_end= key_info->key_part + key_info->key_parts;
+  bool auto_increment_field_copied= FALSE;
+
+  if (!(copy= new Copy_field[to->s->fields]) ||
+      !(key_fields= new Copy_field[key_info->key_parts]))
+    return TRUE;
+  copy_end= setup_copy_fields(thd, from, to, create, copy,
+                              &auto_increment_field_copied);
+  key_fields_end= key_fields;
+  for (part= key_info->key_part; part < part_end; part++)
+  {
+    for (Copy_field *ptr= copy; ptr < copy_end; ptr++)
+    {
+      if (ptr->to_field == part->field)
+      {
+        (key_fields_end++)->set(part->field, ptr->from_field, 0);
+        break;
+      }
+    }
+  }
+  return FALSE;
+}
+
+
+/**
+  Read the row of the new table that has the primary key of the row of
+  the old table with the given key into to->record[1].
+*/
+
+int Online_alter_apply::find_new_row(const uchar *key, bool *found)
+{
+  int error;
+
+  key_restore(from->record[0], (uchar*) key,
+              from->key_info + from->s->primary_key, 0);
+  for (Copy_field *ptr= key_fields; ptr < key_fields_end; ptr++)
+    ptr->do_copy(ptr);
+  key_copy(new_key, to->record[0], to->key_info + to->s->primary_key, 0);
+  error= to->file->ha_index_read_map(to->record[1], new_key, HA_WHOLE_KEY,
+                                     HA_READ_KEY_EXACT);
+  *found= !error;
+  if (error == HA_ERR_KEY_NOT_FOUND || error == HA_ERR_END_OF_FILE)
+    error= 0;
+  return error;
+}
+
+
+/**
+  Copy the row of the old table with the given primary key to the new
+  table, or delete it from the new table if it doesn't exist any more.
+
+  @return 0, a handler error code, or -1 if an error was reported
+*/
+
+int Online_alter_apply::apply_row(const uchar *key)
+{
+  bool old_found, new_found;
+  int error;
+
+  error= from->file->ha_index_read_map(from->record[0], key, HA_WHOLE_KEY,
+                                       HA_READ_KEY_EXACT);
+  if (error && error != HA_ERR_KEY_NOT_FOUND && error != HA_ERR_END_OF_FILE)
+    return error;
+  old_found= !error;
+
+  restore_record(to, s->default_values);
+  if (old_found)
+  {
+    if (from->vfield)
+      update_virtual_fields(thd, from);
+    for (Copy_field *ptr= copy; ptr < copy_end; ptr++)
+      ptr->do_copy(ptr);
+    if (to->vfield)
+      update_virtual_fields(thd, to, VCOL_UPDATE_FOR_WRITE);
+    if (thd->is_error())
+      return -1;
+  }
+  if ((error= find_new_row(key, &new_found)))
+    return error;
+
+  if (!old_found)
+    return new_found ? to->file->ha_delete_row(to->record[1]) : 0;
+
+  if (to->next_number_field)
+    to->auto_increment_field_not_null= TRUE;
+  if (new_found)
+  {
+    error= to->file->ha_update_row(to->record[1], to->record[0]);
+    if (error == HA_ERR_RECORD_IS_THE_SAME)
+      error= 0;
+  }
+  else
+    error= to->file->ha_write_row(to->record[0]);
+  to->auto_increment_field_not_null= FALSE;
+  return error;
+}
+
+
+/**
+  Delete the row with the given primary key of the old table from the
+  new table.
+*/
+
+int Online_alter_apply::remove_row(const uchar *key)
+{
+  bool found;
+  int error;
+
+  restore_record(to, s->default_values);
+  if ((error= find_new_row(key, &found)) || !found)
+    return error;
+  return to->file->ha_delete_row(to->record[1]);
+}
+
+
+/**
+  Copy the rows of the keys in the change log of ALTER ONLINE TABLE again.
+
+  Until the final pass a changed row may not fit into the new table
+  because another changed row still has its old values there: such keys
+  go back to the log. In the final pass nobody else changes the table,
+  so we retry as long as rows can be applied, then delete the rows of the
+  remaining keys from the new table and apply them once more. A duplicate
+  key error after that is real.
+
+  Every pass ends with a commit, so that the next one reads the rows in a
+  new transaction, which sees all changes of the keys taken from the log.
+
+  @param final    TRUE if the table is locked exclusively
+  @param applied  OUT number of keys that were taken from the log
+
+  @retval 0   ok
+  @retval -1  error
+*/
+
+static int
+online_alter_apply_log(THD *thd, TABLE *from, TABLE *to,
+                       List<Create_field> &create, Online_alter_log *log,
+                       bool final, ha_rows *applied)
+{
+  int error= 1, errpos= 0, dup_error= 0;
+  bool removed= FALSE;
+  DYNAMIC_ARRAY keys, retry;
+  ulonglong save_sql_mode= thd->variables.sql_mode;
+  Online_alter_apply apply(thd, from, to);
+  DBUG_ENTER("online_alter_apply_log");
+
+  my_init_dynamic_array(&keys, log->key_length, 1024, 1024);
+  my_init_dynamic_array(&retry, log->key_length, 64, 64);
+  if (log->take_keys(&keys))
+  {
+    my_error(ER_OUT_OF_RESOURCES, MYF(0));
+    goto err;
+  }
+  if (!(*applied= keys.elements))
+  {
+    error= 0;
+    goto err;
+  }
+
+  if (mysql_trans_prepare_alter_copy_data(thd))
+    goto err;
+  errpos= 1;
+  if (to->file->ha_external_lock(thd, F_WRLCK))
+    goto err;
+  errpos= 2;
+  thd->abort_on_warning= test(thd->variables.sql_mode &
+                              (MODE_STRICT_TRANS_TABLES |
+                               MODE_STRICT_ALL_TABLES));
+  from->file->extra(HA_EXTRA_ONLINE_ALTER_READ);
+  from->use_all_columns();
+  to->use_all_columns();
+  to->mark_virtual_columns_for_write(TRUE);
+  if (apply.init(create) ||
+      from->file->ha_index_init(from->s->primary_key, 0))
+    goto err;
+  errpos= 3;
+  if (to->file->ha_index_init(to->s->primary_key, 0))
+    goto err;
+  errpos= 4;
+
+  for (;;)
+  {
+    bool progress= FALSE;
+    for (uint i= 0; i < keys.elements; i++)
+    {
+      uchar *key= keys.buffer + i * keys.size_of_element;
+      int res;
+      if (thd->killed)
+      {
+        thd->send_kill_message();
+        goto err;
+      }
+      if (!(res= apply.apply_row(key)))
+        progress= TRUE;
+      else if (res < 0)
+        goto err;
+      else if (!to->file->is_fatal_error(res, HA_CHECK_DUP))
+      {
+        if (insert_dynamic(&retry, key))
+          goto err;
+        dup_error= res;
+      }
+      else
+      {
+        to->file->print_error(res, MYF(0));
+        goto err;
+      }
+    }
+    if (!retry.elements)
+      break;
+    if (!final)
+    {
+      log->add_keys((uchar*) retry.buffer, retry.elements);
+      break;
+    }
+    if (!progress)
+    {
+      if (removed)
+      {
+        uint key_nr= to->file->get_dup_key(dup_error);
+        if ((int) key_nr >= 0)
+          to->file->print_keydup_error(key_nr, ER(ER_DUP_ENTRY_WITH_KEY_NAME),
+                                       MYF(0));
+        else
+          to->file->print_error(dup_error, MYF(0));
+        goto err;
+      }
+      for (uint i= 0; i < retry.elements; i++)
+      {
+        int res= apply.remove_row(retry.buffer +
+                                  i * retry.size_of_element);
+        if (res)
+        {
+          to->file->print_error(res, MYF(0));
+          goto err;
+        }
+      }
+      removed= TRUE;
+    }
+    swap_variables(DYNAMIC_ARRAY, keys, retry);
+    reset_dynamic(&retry);
+  }
+  error= 0;
+
+err:
+  if (errpos >= 4)
+    to->file->ha_index_end();
+  if (errpos >= 3)
+    from->file->ha_index_end();
+  if (errpos >= 2 && to->file->ha_external_lock(thd, F_UNLCK))
+    error= 1;
+  if (errpos >= 1 && mysql_trans_commit_alter_copy_data(thd))
+    error= 1;
+  thd->variables.sql_mode= save_sql_mode;
+  thd->abort_on_warning= 0;
+  delete_dynamic(&keys);
+  delete_dynamic(&retry);
+  DBUG_RETURN(error ? -1 : 0);
+}
+
+
+/* Passes of ALTER ONLINE TABLE before the table is locked */
+#define ONLINE_ALTER_MAX_PASSES 10
+/* Don't make another pass if at most this many rows were changed */
+#define ONLINE_ALTER_FINAL_ROWS 1000
+
+/**
+  Copy the rows that other connections changed while ALTER ONLINE TABLE
+  copied the table.
+
+  The change log is applied in passes while the table is still changed,
+  until few rows were changed during the last pass. Then the metadata lock
+  is upgraded to exclusive, which waits for the running transactions, and
+  the rest of the log is applied.
+
+  @retval 0   ok, the table is locked exclusively
+  @retval -1  error
+*/
+
+static int
+online_alter_copy_changes(THD *thd, TABLE *from, TABLE *to,
+                          List<Create_field> &create, Online_alter_log *log,
+                          MDL_ticket *mdl_ticket)
+{
+  ha_rows applied;
+  DBUG_ENTER("online_alter_copy_changes");
+
+  thd_proc_info(thd, "copy changed rows to tmp table");
+  for (uint pass= 0; pass < ONLINE_ALTER_MAX_PASSES; pass++)
+  {
+    if (online_alter_apply_log(thd, from, to, create, log, FALSE, &applied))
+      DBUG_RETURN(-1);
+    if (applied <= ONLINE_ALTER_FINAL_ROWS)
+      break;
+  }
+
+  DEBUG_SYNC(thd, "alter_table_online_before_lock");
+  thd_proc_info(thd, "Waiting for table metadata lock");
+  if (thd->mdl_context.upgrade_shared_lock_to_exclusive(mdl_ticket,
+                                             thd->variables.lock_wait_timeout))
+    DBUG_RETURN(-1);
+  thd_proc_info(thd, "copy changed rows to tmp table");
+  DBUG_RETURN(online_alter_apply_log(thd, from, to, create, log, TRUE,
+                                     &applied));
+}
+
+
 /*
   Recreates tables by calling mysql_alter_table().
 
@@ -137,12 +137,27 @@ bool check_table_file_presence(char *old_path, char *path, const char *db,
 bool mysql_create_table(THD *thd, TABLE_LIST *create_table,
                         HA_CREATE_INFO *create_info,
                         Alter_info *alter_info);
+
+/*
+  Keys of the intermediate table of ALTER TABLE that the storage engine
+  builds by sorting after the rows are copied. The keys from 'first' on
+  are not in the .frm file and not in the engine until then.
+*/
+struct Alter_table_deferred_keys
+{
+  KEY *key_info;                        /* All keys of the new table */
+  uint key_count;
+  uint first;                           /* First deferred key */
+  uint null_bits;                       /* HA_CREATE_INFO::null_bits */
+};
+
 bool mysql_create_table_no_lock(THD *thd, const char *db,
                                 const char *table_name,
                                 HA_CREATE_INFO *create_info,
                                 Alter_info *alter_info,
                                 bool tmp_table, uint select_field_count,
-                                bool *is_trans);
+                                bool *is_trans,
+                                Alter_table_deferred_keys *deferred_keys= 0);
 bool mysql_prepare_alter_table(THD *thd, TABLE *table,
                                HA_CREATE_INFO *create_info,
                                Alter_info *alter_info);
@@ -45,6 +45,12 @@ bool mysql_union(THD *thd, LEX *lex, select_result *result,
 ** store records in temporary table for UNION
 ***************************************************************************/
 
+select_union::~select_union()
+{
+  delete hash_dedup;
+}
+
+
 int select_union::prepare(List<Item> &list, SELECT_LEX_UNIT *u)
 {
   unit= u;
@@ -73,6 +79,15 @@ int select_union::send_data(List<Item> &values)
       return 0;
   }
 
+  if (hash_dedup && !hash_dedup_done)
+  {
+    int res= hash_dedup->check_record();
+    if (res == Hash_dedup::ROW_DUPLICATE)
+      return -1;
+    if (res < 0)
+      return 1;
+  }
+
   if ((write_err= table->file->ha_write_tmp_row(table->record[0])))
   {
     if (write_err == HA_ERR_FOUND_DUPP_KEY)
@@ -169,6 +184,77 @@ select_union::create_result_table(THD *thd_arg, List<Item> *column_types,
 }
 
 
+int select_union_direct::send_data(List<Item> &values)
+{
+  if (unit->offset_limit_cnt)
+  {						// LIMIT of the select
+    unit->offset_limit_cnt--;
+    return 0;
+  }
+  if (offset)
+  {						// LIMIT of the UNION
+    offset--;
+    return 0;
+  }
+  if (!limit || thd->killed == ABORT_QUERY)
+    return 0;
+  fill_record(thd, table->field, values, TRUE, FALSE);
+  if (thd->is_error())
+    return 1;
+  if (limit != HA_POS_ERROR)
+    limit--;
+  sent_rows++;
+  return result->send_data(unit->item_list);
+}
+
+
+/**
+  Remove duplicates of UNION DISTINCT with a Hash_dedup instead of a unique
+  key on the result table: rows are checked in memory as they are written,
+  and the table is written without index maintenance.
+*/
+
+bool select_union::init_hash_dedup(THD *thd_arg)
+{
+  DBUG_ASSERT(!hash_dedup);
+  if (!(hash_dedup= new Hash_dedup(table, table->field,
+                                   min(thd_arg->variables.tmp_table_size,
+                                       thd_arg->variables.max_heap_table_size))))
+    return TRUE;
+  hash_dedup_done= FALSE;
+  return FALSE;
+}
+
+
+/**
+  Delete the duplicates that could not be checked in memory. Called when
+  the last DISTINCT select of the unit has been executed; the rows of the
+  following UNION ALL selects are not checked.
+*/
+
+bool select_union::end_hash_dedup()
+{
+  bool res;
+  if (!hash_dedup || hash_dedup_done)
+    return FALSE;
+  hash_dedup_done= TRUE;
+  res= (hash_dedup->has_unchecked_rows() &&
+        hash_dedup->delete_duplicates(thd, NULL));
+  hash_dedup->reset();                          // Free memory
+  return res;
+}
+
+
+void select_union::reset_hash_dedup()
+{
+  if (hash_dedup)
+  {
+    hash_dedup->reset();
+    hash_dedup_done= FALSE;
+  }
+}
+
+
 /**
   Reset and empty the temporary table that stores the materialized query result.
 
@@ -180,6 +266,7 @@ void select_union::cleanup()
 {
   table->file->extra(HA_EXTRA_RESET_STATE);
   table->file->ha_delete_all_rows();
+  reset_hash_dedup();
   free_io_cache(table);
   filesort_free_buffers(table,0);
 }
@@ -224,13 +311,62 @@ st_select_lex_unit::init_prepare_fake_select_lex(THD *thd_arg)
 }
 
 
+/**
+  Check if duplicates of UNION DISTINCT can be removed with a Hash_dedup.
+
+  Rows whose partition was spilled are only checked after the last
+  DISTINCT select, so no select up to it may count its rows for a LIMIT.
+  BIT columns are not supported by Hash_dedup.
+*/
+
+bool st_select_lex_unit::use_hash_distinct()
+{
+  if (!union_distinct || !optimizer_flag(thd, OPTIMIZER_SWITCH_HASH_DISTINCT))
+    return FALSE;
+  for (SELECT_LEX *sl= first_select(); sl; sl= sl->next_select())
+  {
+    if (sl->select_limit || sl->offset_limit)
+      return FALSE;
+    if (sl == union_distinct)
+      break;
+  }
+  List_iterator_fast<Item> it(types);
+  Item *type;
+  while ((type= it++))
+  {
+    if (type->field_type() == MYSQL_TYPE_BIT)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+  Check if the rows of the UNION can be sent to the result as they are
+  produced by the selects (see select_union_direct).
+
+  This requires a top level UNION ALL without ORDER BY and
+  SQL_CALC_FOUND_ROWS. EXPLAIN keeps the plan with the temporary table.
+*/
+
+bool st_select_lex_unit::can_send_union_all_directly()
+{
+  return (optimizer_flag(thd, OPTIMIZER_SWITCH_UNION_ALL_STREAMING) &&
+          is_union() && !union_distinct && !describe &&
+          this == &thd->lex->unit &&
+          thd->lex->sql_command == SQLCOM_SELECT &&
+          !global_parameters->order_list.elements &&
+          !(first_select()->options & OPTION_FOUND_ROWS));
+}
+
+
 bool st_select_lex_unit::prepare(THD *thd_arg, select_result *sel_result,
                                  ulong additional_options)
 {
   SELECT_LEX *lex_select_save= thd_arg->lex->current_select;
   SELECT_LEX *sl, *first_sl= first_select();
   select_result *tmp_result;
-  bool is_union_select;
+  bool is_union_select, hash_distinct;
   DBUG_ENTER("st_select_lex_unit::prepare");
 
   describe= test(additional_options & SELECT_DESCRIBE);
@@ -273,7 +409,13 @@ bool st_select_lex_unit::prepare(THD *thd_arg, select_result *sel_result,
 
   if (is_union_select)
   {
-    if (!(tmp_result= union_result= new select_union))
+    if (can_send_union_all_directly())
+    {
+      if (!(tmp_result= union_result= union_direct=
+            new select_union_direct(sel_result)))
+        goto err;
+    }
+    else if (!(tmp_result= union_result= new select_union))
       goto err;
     if (describe)
       tmp_result= sel_result;
@@ -439,9 +581,14 @@ bool st_select_lex_unit::prepare(THD *thd_arg, select_result *sel_result,
     if (global_parameters->ftfunc_list->elements)
       create_options= create_options | TMP_TABLE_FORCE_MYISAM;
 
-    if (union_result->create_result_table(thd, &types, test(union_distinct),
+    hash_distinct= use_hash_distinct();
+    if (union_result->create_result_table(thd, &types,
+                                          test(union_distinct) &&
+                                          !hash_distinct,
                                           create_options, "", FALSE, TRUE))
       goto err;
+    if (hash_distinct && union_result->init_hash_dedup(thd))
+      goto err;
     if (fake_select_lex && !fake_select_lex->first_cond_optimization)
     {
       save_tablenr= result_table_list.tablenr_exec;
@@ -629,8 +776,23 @@ bool st_select_lex_unit::exec()
   
   saved_error= optimize();
 
+  if (union_direct && !saved_error)
+  {
+    set_limit(global_parameters);
+    union_direct->set_limit(offset_limit_cnt,
+                            select_limit_cnt == HA_POS_ERROR ?
+                            HA_POS_ERROR :
+                            select_limit_cnt - offset_limit_cnt);
+    /* The result is otherwise prepared by the JOIN of fake_select_lex */
+    if (result->prepare(item_list, this) || result->prepare2() ||
+        result->send_result_set_metadata(item_list, Protocol::SEND_NUM_ROWS |
+                                         Protocol::SEND_EOF))
+      DBUG_RETURN(TRUE);
+  }
+
   if (uncacheable || !item || !item->assigned() || describe)
   {
+    union_result->reset_hash_dedup();
     for (SELECT_LEX *sl= select_cursor; sl; sl= sl->next_select())
     {
       ha_rows records_at_start= 0;
@@ -659,6 +821,12 @@ bool st_select_lex_unit::exec()
           sl->options & ~OPTION_FOUND_ROWS : sl->options | found_rows_for_union;
 	saved_error= sl->join->optimize();
       }
+      if (union_direct && union_direct->rows_wanted() != HA_POS_ERROR)
+      {
+        /* Stop the select when the UNION has all the rows it needs */
+        set_if_smaller(select_limit_cnt,
+                       offset_limit_cnt + union_direct->rows_wanted());
+      }
       if (!saved_error)
       {
 	records_at_start= table->file->stats.records;
@@ -677,7 +845,8 @@ bool st_select_lex_unit::exec()
 	{
 	  examined_rows+= thd->examined_row_count;
           thd->examined_row_count= 0;
-	  if (union_result->flush())
+	  if (union_result->flush() ||
+              (sl == union_distinct && union_result->end_hash_dedup()))
 	  {
 	    thd->lex->current_select= lex_select_save;
 	    DBUG_RETURN(1);
@@ -720,11 +889,26 @@ bool st_select_lex_unit::exec()
                             thd->accessed_rows_and_keys,
                             thd->lex->limit_rows_examined->val_uint());
         thd->reset_killed();
+        if (union_result->end_hash_dedup())
+        {
+          thd->lex->current_select= lex_select_save;
+          DBUG_RETURN(1);
+        }
         break;
       }
     }
   }
 
+  if (union_direct)
+  {
+    /* All rows have been sent by the selects */
+    thd->limit_found_rows= union_direct->sent_rows;
+    thd->examined_row_count+= examined_rows;
+    saved_error= result->send_eof();
+    thd->lex->current_select= lex_select_save;
+    goto err;
+  }
+
   /* Send result to 'result' */
   saved_error= TRUE;
   {
@@ -848,6 +1032,7 @@ bool st_select_lex_unit::cleanup()
   {
     delete union_result;
     union_result=0; // Safety
+    union_direct= 0;
     if (table)
       free_tmp_table(thd, table);
     table= 0; // Safety
@@ -2098,6 +2098,105 @@ void multi_update::abort_result_set()
 }
 
 
+/**
+  Rows of the temporary table of a multi-table UPDATE, read in batches
+  that fit in read_rnd_buffer_size and sorted by the position of the row
+  to update (handler::cmp_ref()), like rr_from_cache() does for filesort.
+  The rows to update are then read with rnd_pos() in the order they are
+  stored in the table instead of the order they were found in.
+*/
+
+class Multi_update_rows
+{
+  TABLE *tmp_table;
+  uchar *buffer, **rows, **pos, **end;
+  uint max_rows, rowid_offset;
+  bool eof;
+
+public:
+  handler *file;                                /* Of the updated table */
+
+  Multi_update_rows() :buffer(0) {}
+  ~Multi_update_rows() { my_free(buffer); }
+  bool init(THD *thd, TABLE *tmp_table_arg, TABLE *table);
+  int read_next();
+};
+
+
+extern "C" int multi_update_row_cmp(const void *arg, const void *a,
+                                    const void *b)
+{
+  const Multi_update_rows *rows= (const Multi_update_rows*) arg;
+  return rows->file->cmp_ref(*(uchar**) a, *(uchar**) b);
+}
+
+
+bool Multi_update_rows::init(THD *thd, TABLE *tmp_table_arg, TABLE *table)
+{
+  uint reclength= tmp_table_arg->s->reclength;
+  tmp_table= tmp_table_arg;
+  file= table->file;
+  rowid_offset= (uint) (tmp_table->field[0]->ptr - tmp_table->record[0]);
+  pos= end= 0;
+  eof= 0;
+  /* The values of blobs are only valid until the next row is read */
+  if (tmp_table->s->blob_fields)
+    max_rows= 1;
+  else
+    max_rows= max(thd->variables.read_rnd_buff_size /
+                  (reclength + sizeof(uchar*)), 1);
+  my_free(buffer);
+  if (!(buffer= (uchar*) my_malloc(max_rows * (reclength + sizeof(uchar*)),
+                                   MYF(MY_WME))))
+    return TRUE;
+  rows= (uchar**) buffer;
+  return FALSE;
+}
+
+
+/**
+  Read the next row into tmp_table->record[0].
+
+  @return 0, HA_ERR_END_OF_FILE or an error from the temporary table.
+*/
+
+int Multi_update_rows::read_next()
+{
+  uint reclength= tmp_table->s->reclength;
+  if (pos == end)
+  {
+    uchar *row= (uchar*) (rows + max_rows);
+    uint count= 0;
+    int error;
+    while (!eof && count < max_rows)
+    {
+      if ((error= tmp_table->file->ha_rnd_next(tmp_table->record[0])))
+      {
+        if (error == HA_ERR_END_OF_FILE)
+          eof= 1;
+        else if (error != HA_ERR_RECORD_DELETED) // May happen on dup key
+          return error;
+        continue;
+      }
+      memcpy(row, tmp_table->record[0], reclength);
+      rows[count++]= row;
+      row+= reclength;
+    }
+    if (!count)
+      return HA_ERR_END_OF_FILE;
+    /* Sort by the row positions, which are at the same offset in all rows */
+    for (uint i= 0; i < count; i++)
+      rows[i]+= rowid_offset;
+    my_qsort2((uchar*) rows, count, sizeof(uchar*), multi_update_row_cmp,
+              (void*) this);
+    pos= rows;
+    end= rows + count;
+  }
+  memcpy(tmp_table->record[0], *pos++ - rowid_offset, reclength);
+  return 0;
+}
+
+
 int multi_update::do_updates()
 {
   TABLE_LIST *cur_table;
@@ -2105,6 +2204,7 @@ int multi_update::do_updates()
   ha_rows org_updated;
   TABLE *table, *tmp_table, *err_table;
   List_iterator_fast<TABLE> check_opt_it(unupdated_check_opt_tables);
+  Multi_update_rows tmp_rows;
   DBUG_ENTER("multi_update::do_updates");
 
   do_update= 0;					// Don't retry this function
@@ -2160,6 +2260,12 @@ int multi_update::do_updates()
       err_table= tmp_table;
       goto err;
     }
+    if (tmp_rows.init(thd, tmp_table, table))
+    {
+      local_error= HA_ERR_OUT_OF_MEM;
+      err_table= tmp_table;
+      goto err;
+    }
 
     can_compare_record= records_are_comparable(table);
 
@@ -2170,12 +2276,10 @@ int multi_update::do_updates()
         thd->fatal_error();
 	goto err2;
       }
-      if ((local_error= tmp_table->file->ha_rnd_next(tmp_table->record[0])))
+      if ((local_error= tmp_rows.read_next()))
       {
 	if (local_error == HA_ERR_END_OF_FILE)
 	  break;
-	if (local_error == HA_ERR_RECORD_DELETED)
-	  continue;				// May happen on dup key
         err_table= tmp_table;
 	goto err;
       }
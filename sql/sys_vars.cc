@@ -234,6 +234,17 @@ static Sys_var_ulonglong Sys_binlog_stmt_cache_size(
        CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(IO_SIZE, SIZE_T_MAX), DEFAULT(32768), BLOCK_SIZE(IO_SIZE));
 
+#ifdef HAVE_REPLICATION
+static Sys_var_ulong Sys_binlog_tail_cache_size(
+       "binlog_tail_cache_size", "The size of the buffer holding the end "
+       "of the active binary log, from which all binlog dump threads that "
+       "have caught up with it read the events they send. 0 disables the "
+       "buffer, and each dump thread reads the binary log itself",
+       READ_ONLY GLOBAL_VAR(binlog_tail_cache_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024*1024*1024), DEFAULT(1024*1024),
+       BLOCK_SIZE(IO_SIZE));
+#endif
+
 /*
   Some variables like @sql_log_bin and @binlog_format change how/if binlogging
   is done. We must not change them inside a running transaction or statement,
@@ -627,6 +638,14 @@ static Sys_var_ulong Sys_delayed_insert_limit(
        GLOBAL_VAR(delayed_insert_limit), CMD_LINE(REQUIRED_ARG),
        VALID_RANGE(1, UINT_MAX), DEFAULT(DELAYED_LIMIT), BLOCK_SIZE(1));
 
+static Sys_var_ulong Sys_delayed_insert_max_latency(
+       "delayed_insert_max_latency",
+       "How many milliseconds the INSERT DELAYED handler waits for more "
+       "rows before it writes the queued rows in one batch. 0 writes the "
+       "rows as soon as they are queued",
+       GLOBAL_VAR(delayed_insert_max_latency), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 60000), DEFAULT(0), BLOCK_SIZE(1));
+
 static Sys_var_ulong Sys_delayed_insert_timeout(
        "delayed_insert_timeout",
        "How long a INSERT DELAYED thread should wait for INSERT statements "
@@ -913,6 +932,20 @@ static Sys_var_mybool Sys_log_bin(
        "log_bin", "Whether the binary log is enabled",
        READ_ONLY GLOBAL_VAR(opt_bin_log), NO_CMD_LINE, DEFAULT(FALSE));
 
+static Sys_var_mybool Sys_log_bin_compress(
+       "log_bin_compress",
+       "Compress the rows of row events and the text of long statements "
+       "written to the binary log, with zlib. Slaves and mysqlbinlog "
+       "must be of a version that can read compressed events",
+       GLOBAL_VAR(opt_bin_log_compress), CMD_LINE(OPT_ARG), DEFAULT(FALSE));
+
+static Sys_var_ulong Sys_log_bin_compress_min_len(
+       "log_bin_compress_min_len",
+       "Minimum length of the rows of a row event, or of a statement, that "
+       "is compressed with --log-bin-compress",
+       GLOBAL_VAR(opt_bin_log_compress_min_len), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(10, 1024), DEFAULT(256), BLOCK_SIZE(1));
+
 static Sys_var_mybool Sys_trust_function_creators(
        "log_bin_trust_function_creators",
        "If set to FALSE (the default), then when --log-bin is used, creation "
@@ -1471,6 +1504,9 @@ export const char *optimizer_switch_names[]=
   "optimize_join_buffer_size",
   "table_elimination",
   "extended_keys",
+  "skip_scan",
+  "hash_distinct",
+  "union_all_streaming",
   "default", NullS
 };
 /** propagates changes to @@engine_condition_pushdown */
@@ -1512,7 +1548,10 @@ static Sys_var_flagset Sys_optimizer_switch(
         "semijoin_with_cache, "
         "subquery_cache, "
         "table_elimination, "
-        "extended_keys "
+        "extended_keys, "
+        "skip_scan, "
+        "hash_distinct, "
+        "union_all_streaming "
        "} and val is one of {on, off, default}",
        SESSION_VAR(optimizer_switch), CMD_LINE(REQUIRED_ARG),
        optimizer_switch_names, DEFAULT(OPTIMIZER_SWITCH_DEFAULT),
@@ -2012,6 +2051,15 @@ static Sys_var_mybool Sys_slave_sql_verify_checksum(
        GLOBAL_VAR(opt_slave_sql_verify_checksum), CMD_LINE(OPT_ARG),
        DEFAULT(TRUE));
 
+static Sys_var_ulong Sys_slave_event_queue_size(
+       "slave_event_queue_size", "The size of the buffer holding the "
+       "events the slave I/O thread wrote last to the relay log, from which "
+       "the slave SQL thread takes them instead of reading the relay log. "
+       "0 disables the buffer",
+       READ_ONLY GLOBAL_VAR(slave_event_queue_size), CMD_LINE(REQUIRED_ARG),
+       VALID_RANGE(0, 1024*1024*1024), DEFAULT(1024*1024),
+       BLOCK_SIZE(IO_SIZE));
+
 static Sys_var_mybool Sys_master_verify_checksum(
        "master_verify_checksum",
        "Force checksum verification of logged events in the binary log before "
@@ -319,6 +319,7 @@ typedef struct st_filesort_info
   void    (*unpack)(struct st_sort_addon_field *, uchar *, uchar *); /* To unpack back */
   uchar     *record_pointers;    /* If sorted in memory */
   ha_rows   found_records;      /* How many records in sort */
+  bool      using_packed_addons; /* Addon fields have variable length */
 } FILESORT_INFO;
 
 
@@ -343,6 +344,7 @@ enum timestamp_auto_set_type
 class Field_timestamp;
 class Field_blob;
 class Table_triggers_list;
+class Online_alter_log;
 
 /**
   Category of table found in the table share.
@@ -710,6 +712,12 @@ struct TABLE_SHARE
   void *ha_data;
   void (*ha_data_destroy)(void *); /* An optional destructor for ha_data */
 
+  /**
+    Change log of a running ALTER ONLINE TABLE, set and cleared with
+    LOCK_ha_data held.
+  */
+  Online_alter_log *online_alter_log;
+
 #ifdef WITH_PARTITION_STORAGE_ENGINE
   /** place to store partition specific data, LOCK_ha_data hold while init. */
   HA_DATA_PARTITION *ha_part_data;
@@ -750,3 +750,452 @@ err:
   my_free(sort_buffer);  
   return rc;
 }
+
+
+/*****************************************************************************
+  Hash_dedup: duplicate removal with a partitioned in-memory hash of rows
+
+  A packed row consists of a 4 byte length, a bitmap with one NULL bit
+  per field and the Field::pack() images of the non-NULL fields.
+*****************************************************************************/
+
+#define HASH_DEDUP_INITIAL_SLOTS 16
+
+Hash_dedup::Hash_dedup(TABLE *table_arg, Field **first_field_arg,
+                       ulonglong max_in_memory_size_arg)
+  :table(table_arg), first_field(first_field_arg),
+   max_in_memory_size(max_in_memory_size_arg), memory_used(0),
+   row_buff(0), row_buff_length(0)
+{
+  uint fields= 0;
+  for (Field **ptr= first_field; *ptr; ptr++)
+    fields++;
+  null_bytes= (fields + 7) / 8;
+  for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+  {
+    init_alloc_root(&part->mem_root, 8192, 0);
+    part->slots= 0;
+    part->size= part->count= 0;
+    part->memory= 0;
+    part->state= PART_ACTIVE;
+  }
+}
+
+
+Hash_dedup::~Hash_dedup()
+{
+  for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+    free_partition(part, PART_DONE);
+  my_free(row_buff);
+}
+
+
+/**
+  Check if the rows of a table can be compared by Hash_dedup.
+
+  @note BIT fields may store some of their bits among the NULL bits of the
+  record, which Field::pack() of the field does not preserve here.
+*/
+
+bool Hash_dedup::can_dedup(Field **first_field)
+{
+  for (Field **ptr= first_field; *ptr; ptr++)
+  {
+    if ((*ptr)->type() == MYSQL_TYPE_BIT)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+
+/**
+  Calculate the hash value of the row in record[0].
+
+  The value is computed with the collation of each field, so rows that
+  compare as equal have equal hash values.
+*/
+
+ulonglong Hash_dedup::hash_record()
+{
+  ulong nr1= 1, nr2= 4;
+  for (Field **ptr= first_field; *ptr; ptr++)
+  {
+    Field *field= *ptr;
+    if ((field->flags & BLOB_FLAG) && !field->is_null())
+    {
+      /* Field::hash() would use the blob pointer, not the value */
+      Field_blob *blob= (Field_blob*) field;
+      CHARSET_INFO *cs= blob->sort_charset();
+      uchar *data;
+      blob->get_ptr(&data);
+      cs->coll->hash_sort(cs, data, blob->get_length(), &nr1, &nr2);
+    }
+    else if (field->result_type() == REAL_RESULT && !field->is_null())
+    {
+      /* -0.0 and 0.0 are equal for Field::cmp() but not byte by byte */
+      uchar buff[sizeof(double)];
+      double value= field->val_real();
+      if (value == 0.0)
+        value= 0.0;
+      float8store(buff, value);
+      my_charset_bin.coll->hash_sort(&my_charset_bin, buff, sizeof(buff),
+                                     &nr1, &nr2);
+    }
+    else
+      field->hash(&nr1, &nr2);
+  }
+  /* Spread the bits: partition and fingerprint come from opposite ends */
+  ulonglong hash_value= nr1;
+  hash_value^= hash_value >> 33;
+  hash_value*= ULL(0xff51afd7ed558ccd);
+  hash_value^= hash_value >> 33;
+  hash_value*= ULL(0xc4ceb9fe1a85ec53);
+  hash_value^= hash_value >> 33;
+  return hash_value;
+}
+
+
+/**
+  Pack the row in record[0] into row_buff.
+
+  @return the packed row, 0 if out of memory
+*/
+
+uchar *Hash_dedup::pack_record(size_t *length)
+{
+  size_t max_length= 4 + null_bytes;
+  Field **ptr;
+  for (ptr= first_field; *ptr; ptr++)
+  {
+    Field *field= *ptr;
+    if (field->flags & BLOB_FLAG)
+    {
+      Field_blob *blob= (Field_blob*) field;
+      max_length+= blob->pack_length_no_ptr() + blob->get_length();
+    }
+    else
+      max_length+= field->max_packed_col_length(field->pack_length());
+  }
+  if (max_length > row_buff_length)
+  {
+    my_free(row_buff);
+    if (!(row_buff= (uchar*) my_malloc(max_length, MYF(MY_WME))))
+    {
+      row_buff_length= 0;
+      return 0;
+    }
+    row_buff_length= max_length;
+  }
+
+  uchar *nulls= row_buff + 4;
+  uchar *to= nulls + null_bytes;
+  uint i;
+  bzero(nulls, null_bytes);
+  for (ptr= first_field, i= 0; *ptr; ptr++, i++)
+  {
+    Field *field= *ptr;
+    if (field->is_null())
+      nulls[i / 8]|= (uchar) (1 << (i & 7));
+    else
+      to= field->pack(to, field->ptr);
+  }
+  *length= (size_t) (to - row_buff);
+  int4store(row_buff, (uint32) *length);
+  return row_buff;
+}
+
+
+/**
+  Compare the row in record[0] with a packed row.
+
+  The packed row is unpacked into record[1] and compared field by field
+  with the collation of the field.
+
+  @retval 0  The rows are equal
+  @retval 1  The rows differ
+*/
+
+bool Hash_dedup::compare_packed(const uchar *row)
+{
+  my_ptrdiff_t diff= table->s->rec_buff_length;
+  const uchar *row_end= row + uint4korr(row);
+  const uchar *nulls= row + 4;
+  const uchar *from= nulls + null_bytes;
+  uint i;
+  Field **ptr;
+  for (ptr= first_field, i= 0; *ptr; ptr++, i++)
+  {
+    Field *field= *ptr;
+    bool is_null= test(nulls[i / 8] & (1 << (i & 7)));
+    if (field->is_null() != is_null)
+      return 1;
+    if (is_null)
+      continue;
+    if (field->flags & BLOB_FLAG)
+    {
+      /* Field_blob::unpack() stores into the field itself; compare in place */
+      Field_blob *blob= (Field_blob*) field;
+      CHARSET_INFO *cs= blob->charset();
+      uint packlength= blob->pack_length_no_ptr();
+      uint32 length= blob->get_length(from, packlength);
+      uchar *data;
+      blob->get_ptr(&data);
+      if (cs->coll->strnncollsp(cs, data, blob->get_length(),
+                                from + packlength, length, 0))
+        return 1;
+      from+= packlength + length;
+      continue;
+    }
+    if (!(from= field->unpack(field->ptr + diff, from, row_end)) ||
+        field->cmp(field->ptr, field->ptr + diff))
+      return 1;
+  }
+  return 0;
+}
+
+
+/**
+  Double the number of slots of a partition.
+
+  @return TRUE if out of memory
+*/
+
+bool Hash_dedup::grow(Partition *part)
+{
+  uint new_size= part->size ? part->size * 2 : HASH_DEDUP_INITIAL_SLOTS;
+  uint mask= new_size - 1;
+  Slot *new_slots;
+  if (!(new_slots= (Slot*) my_malloc(new_size * sizeof(Slot),
+                                     MYF(MY_WME | MY_ZEROFILL))))
+    return TRUE;
+  for (Slot *slot= part->slots; slot < part->slots + part->size; slot++)
+  {
+    if (!slot->row)
+      continue;
+    uint idx= slot->fingerprint & mask;
+    while (new_slots[idx].row)
+      idx= (idx + 1) & mask;
+    new_slots[idx]= *slot;
+  }
+  my_free(part->slots);
+  part->slots= new_slots;
+  part->memory+= (new_size - part->size) * sizeof(Slot);
+  memory_used+= (new_size - part->size) * sizeof(Slot);
+  part->size= new_size;
+  return FALSE;
+}
+
+
+void Hash_dedup::free_partition(Partition *part,
+                                enum_partition_state new_state)
+{
+  free_root(&part->mem_root, MYF(0));
+  my_free(part->slots);
+  part->slots= 0;
+  part->size= part->count= 0;
+  memory_used-= part->memory;
+  part->memory= 0;
+  part->state= new_state;
+}
+
+
+uint Hash_dedup::partitions_in_state(enum_partition_state state)
+{
+  uint count= 0;
+  for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+  {
+    if (part->state == state)
+      count++;
+  }
+  return count;
+}
+
+
+/**
+  Free the memory of the largest partition in memory.
+
+  The rows of the partition are left in the table unchecked. If it is
+  the only partition in memory, it is kept: its rows have the same
+  partition bits and can't be split further.
+*/
+
+void Hash_dedup::spill_largest()
+{
+  Partition *largest= 0;
+  uint active= 0;
+  for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+  {
+    if (part->state != PART_ACTIVE)
+      continue;
+    active++;
+    if (!largest || part->memory > largest->memory)
+      largest= part;
+  }
+  if (active > 1)
+    free_partition(largest, PART_SPILLED);
+}
+
+
+/**
+  Look up the row in record[0] in a partition and add it if not found.
+
+  @retval ROW_UNIQUE     The row was not seen before
+  @retval ROW_DUPLICATE  An equal row was seen before
+  @retval -1             Out of memory
+*/
+
+int Hash_dedup::check_in_partition(Partition *part, ulonglong hash_value)
+{
+  uint32 fingerprint= (uint32) hash_value;
+  uint mask, idx;
+  uchar *row, *copy;
+  size_t length;
+
+  if (!part->slots && grow(part))
+    return -1;
+  mask= part->size - 1;
+  for (idx= fingerprint & mask; part->slots[idx].row; idx= (idx + 1) & mask)
+  {
+    if (part->slots[idx].fingerprint == fingerprint &&
+        !compare_packed(part->slots[idx].row))
+      return ROW_DUPLICATE;
+  }
+
+  if (!(row= pack_record(&length)) ||
+      !(copy= (uchar*) alloc_root(&part->mem_root, length)))
+    return -1;
+  memcpy(copy, row, length);
+  part->slots[idx].fingerprint= fingerprint;
+  part->slots[idx].row= copy;
+  part->count++;
+  part->memory+= length;
+  memory_used+= length;
+
+  if (part->count * 4 > part->size * 3 && grow(part))
+    return -1;
+  if (memory_used > max_in_memory_size)
+    spill_largest();
+  return ROW_UNIQUE;
+}
+
+
+/**
+  Check whether the row in record[0] is a duplicate of a row seen before.
+
+  @retval ROW_UNIQUE       The row was not seen before
+  @retval ROW_DUPLICATE    An equal row was seen before
+  @retval ROW_NOT_CHECKED  The partition of the row was spilled; the row
+                           is checked by delete_duplicates()
+  @retval -1               Out of memory
+*/
+
+int Hash_dedup::check_record()
+{
+  ulonglong hash_value= hash_record();
+  Partition *part= partitions + (hash_value >> (64 - PARTITION_BITS));
+  if (part->state != PART_ACTIVE)
+    return ROW_NOT_CHECKED;
+  return check_in_partition(part, hash_value);
+}
+
+
+void Hash_dedup::defer_all()
+{
+  for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+    free_partition(part, PART_SPILLED);
+}
+
+
+void Hash_dedup::reset()
+{
+  for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+    free_partition(part, PART_ACTIVE);
+}
+
+
+/**
+  Delete the duplicates among the rows that were not checked.
+
+  The table is scanned once for every group of spilled partitions that
+  fits in memory. The first occurrence of a row is kept.
+
+  @param thd     Thread handle
+  @param having  If not 0, rows for which it is false are deleted in the
+                 first scan
+
+  @retval 0  ok
+  @retval 1  error, reported
+*/
+
+int Hash_dedup::delete_duplicates(THD *thd, Item *having)
+{
+  handler *file= table->file;
+  uchar *record= table->record[0];
+  int error= 0;
+  DBUG_ENTER("Hash_dedup::delete_duplicates");
+
+  while (has_unchecked_rows())
+  {
+    for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+    {
+      if (part->state == PART_SPILLED)
+        part->state= PART_ACTIVE;
+      else
+        free_partition(part, PART_DONE);
+    }
+
+    if ((error= file->ha_rnd_init(1)))
+      goto err;
+    for (;;)
+    {
+      if (thd->killed_errno())
+      {
+        thd->send_kill_message();
+        error= 0;
+        goto err;
+      }
+      if ((error= file->ha_rnd_next(record)))
+      {
+        if (error == HA_ERR_RECORD_DELETED)
+          continue;
+        if (error == HA_ERR_END_OF_FILE)
+          break;
+        goto err;
+      }
+      if (having && !having->val_int())
+      {
+        if ((error= file->ha_delete_row(record)))
+          goto err;
+        continue;
+      }
+      ulonglong hash_value= hash_record();
+      Partition *part= partitions + (hash_value >> (64 - PARTITION_BITS));
+      if (part->state != PART_ACTIVE)
+        continue;
+      int res= check_in_partition(part, hash_value);
+      if (res < 0)
+        goto err;
+      if (res == ROW_DUPLICATE && (error= file->ha_delete_row(record)))
+        goto err;
+    }
+    (void) file->ha_rnd_end();
+    having= 0;
+
+    /* Partitions that stayed in memory during the scan are complete */
+    for (Partition *part= partitions; part < partitions + PARTITIONS; part++)
+    {
+      if (part->state == PART_ACTIVE)
+        free_partition(part, PART_DONE);
+    }
+  }
+  file->extra(HA_EXTRA_NO_CACHE);
+  DBUG_RETURN(0);
+
+err:
+  file->extra(HA_EXTRA_NO_CACHE);
+  if (file->inited)
+    (void) file->ha_rnd_end();
+  if (error)
+    file->print_error(error, MYF(0));
+  DBUG_RETURN(1);
+}
@@ -1932,7 +1932,7 @@ ha_innobase::ha_innobase(handlerton *hton, TABLE_SHARE *table_arg)
 		  HA_PRIMARY_KEY_IN_READ_INDEX |
 		  HA_BINLOG_ROW_CAPABLE |
 		  HA_CAN_GEOMETRY | HA_PARTIAL_COLUMN_READ |
-		  HA_TABLE_SCAN_ON_INDEX),
+		  HA_TABLE_SCAN_ON_INDEX | HA_CAN_ONLINE_ALTER),
   start_of_scan(0),
   num_write_row(0)
 {}
@@ -10315,6 +10315,19 @@ ha_innobase::extra(
 		case HA_EXTRA_WRITE_CANNOT_REPLACE:
 			thd_to_trx(ha_thd())->duplicates &= ~TRX_DUP_REPLACE;
 			break;
+		case HA_EXTRA_ONLINE_ALTER_READ:
+			/* ALTER ONLINE TABLE reads the committed rows without
+			locking them, the rows that other transactions change
+			meanwhile are copied again by the server. Register the
+			transaction, so that the commit of each copy pass ends
+			it and the next pass reads with a new read view. This
+			is only called after external_lock(). */
+			update_thd(ha_thd());
+			prebuilt->select_lock_type = LOCK_NONE;
+			prebuilt->stored_select_lock_type = LOCK_NONE;
+			prebuilt->sql_stat_start = TRUE;
+			innobase_register_trx(ht, user_thd, prebuilt->trx);
+			break;
 		default:/* Do nothing */
 			;
 	}